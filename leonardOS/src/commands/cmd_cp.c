@@ -7,6 +7,8 @@
 //   cp /etc/hostname /tmp/          → copia para diretório (mantém nome)
 //
 // Apenas copia arquivos (não diretórios).
+// Copia em pedaços de CP_CHUNK_SIZE (buffer de uma arena): no LeonFS cada
+// vfs_write vira sequências multi-setor num só pedido ao dispositivo.
 
 #include "cmd_cp.h"
 #include "../drivers/vga/vga.h"
@@ -16,6 +18,9 @@
 #include "../fs/ramfs.h"
 #include "../fs/leonfs.h"
 #include "../shell/shell.h"
+#include "../memory/arena.h"
+
+#define CP_CHUNK_SIZE (32 * 1024)
 
 void cmd_cp(const char *args) {
     if (!args || args[0] == '\0') {
@@ -134,15 +139,20 @@ void cmd_cp(const char *args) {
     // Reseta destino para overwrite
     dst->size = 0;
 
-    // Copia conteúdo em chunks
+    // Copia conteúdo em chunks grandes (sem arena: 1 setor por vez)
     if (src->size > 0) {
-        uint8_t buf[512];
+        uint8_t small[512];
+        arena_t *scratch = arena_create(0);
+        uint8_t *buf = scratch ? (uint8_t *)arena_alloc(scratch, CP_CHUNK_SIZE) : NULL;
+        uint32_t buf_size = buf ? CP_CHUNK_SIZE : sizeof(small);
+        if (!buf) buf = small;
+
         uint32_t offset = 0;
         uint32_t total = 0;
 
         while (offset < src->size) {
             uint32_t chunk = src->size - offset;
-            if (chunk > sizeof(buf)) chunk = sizeof(buf);
+            if (chunk > buf_size) chunk = buf_size;
 
             uint32_t rd = vfs_read(src, offset, chunk, buf);
             if (rd == 0) break;
@@ -153,6 +163,7 @@ void cmd_cp(const char *args) {
             total += wr;
             offset += rd;
         }
+        if (scratch) arena_destroy(scratch);
 
         vga_puts_color("Copiado ", THEME_DIM);
         vga_putint(total);
@@ -5,7 +5,9 @@
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
 #include "../fs/leonfs.h"
+#include "../fs/bcache.h"
 #include "../fs/vfs.h"
+#include "../drivers/disk/ide.h"
 
 // Helper: Desenha barra de uso
 static void draw_bar(int used, int total, int width) {
@@ -67,11 +69,105 @@ void cmd_df(const char *args) {
         vga_putint(LEONFS_MAX_INODES - sb->free_inodes);
         vga_puts_color(" / ", THEME_DIM);
         vga_putint(LEONFS_MAX_INODES);
+        blkdev_t *dev = leonfs_get_device();
+        if (dev) {
+            vga_puts_color("  Dispositivo: ", THEME_LABEL);
+            vga_puts_color(dev->name, THEME_VALUE);
+        }
         vga_putchar('\n');
     } else {
         vga_puts_color("  /mnt    (LeonFS)   ", THEME_INFO);
         vga_puts_color(" - sem disco\n", THEME_WARNING);
     }
 
+    // Driver IDE (modo de transferência e comandos)
+    const ide_disk_info_t *disk = ide_get_info();
+    if (disk->present) {
+        ide_stats_t is = ide_get_stats();
+        vga_puts_color("  Disco:  ", THEME_LABEL);
+        vga_puts_color(disk->dma ? "DMA (bus-master)" : "PIO", THEME_VALUE);
+        if (disk->lba48) vga_puts_color(", LBA48", THEME_VALUE);
+        vga_puts_color("  Flushes: ", THEME_LABEL);
+        vga_putint(is.flushes);
+        vga_putchar('\n');
+
+        vga_puts_color("  Cmds DMA: ", THEME_LABEL);
+        vga_putint(is.dma_cmds);
+        vga_puts_color("  PIO: ", THEME_LABEL);
+        vga_putint(is.pio_cmds);
+        vga_puts_color("  LBA48: ", THEME_LABEL);
+        vga_putint(is.lba48_cmds);
+        vga_puts_color("  IRQs: ", THEME_LABEL);
+        vga_putint(is.irqs);
+        if (is.dma_errors > 0) {
+            vga_puts_color("  Erros DMA: ", THEME_LABEL);
+            vga_putint(is.dma_errors);
+        }
+        vga_putchar('\n');
+    }
+
+    // Fila de I/O de cada dispositivo de bloco (elevador + merge)
+    for (int i = 0; i < blkdev_count(); i++) {
+        blkdev_t *bd = blkdev_get(i);
+        const blkdev_stats_t *st = &bd->stats;
+        uint32_t reqs = st->reads + st->writes;
+        if (st->commands == 0) continue;
+
+        vga_puts_color("  Fila ", THEME_LABEL);
+        vga_puts_color(bd->name, THEME_VALUE);
+        vga_puts_color(":  Pedidos: ", THEME_LABEL);
+        vga_putint(reqs);
+        vga_puts_color("  Cmds: ", THEME_LABEL);
+        vga_putint(st->commands);
+        vga_puts_color("  Merge: ", THEME_LABEL);
+        uint32_t ratio10 = reqs * 10 / st->commands;
+        vga_putint(ratio10 / 10);
+        vga_putchar('.');
+        vga_putint(ratio10 % 10);
+        vga_puts_color(":1\n", THEME_DIM);
+
+        vga_puts_color("    Prof. media: ", THEME_LABEL);
+        vga_putint(st->dispatches ? st->depth_sum / st->dispatches : 0);
+        vga_puts_color("  max: ", THEME_LABEL);
+        vga_putint(st->max_depth);
+        vga_puts_color("  Latencia media: ", THEME_LABEL);
+        vga_putint(st->completed ? st->lat_total_kc / st->completed : 0);
+        vga_puts_color("  max: ", THEME_LABEL);
+        vga_putint(st->lat_max_kc);
+        vga_puts_color(" kciclos\n", THEME_DIM);
+    }
+
+    // Buffer cache (setores do disco em RAM)
+    bcache_stats_t bs = bcache_get_stats();
+    if (bs.buffers > 0) {
+        vga_puts_color("  Cache:  ", THEME_LABEL);
+        vga_putint(bs.buffers);
+        vga_puts_color(" setores (", THEME_DIM);
+        vga_putint(bs.frames * 4);
+        vga_puts_color(" KB), ", THEME_DIM);
+        vga_putint(bs.dirty);
+        vga_puts_color(" sujos\n", THEME_DIM);
+
+        vga_puts_color("  Hits: ", THEME_LABEL);
+        vga_putint(bs.hits);
+        vga_puts_color("  Misses: ", THEME_LABEL);
+        vga_putint(bs.misses);
+        vga_puts_color("  Writebacks: ", THEME_LABEL);
+        vga_putint(bs.writebacks);
+        vga_puts_color("  Evictions: ", THEME_LABEL);
+        vga_putint(bs.evictions);
+        vga_putchar('\n');
+
+        vga_puts_color("  Direto (multi-setor): ", THEME_LABEL);
+        vga_putint(bs.direct);
+        vga_puts_color(" setores\n", THEME_DIM);
+
+        uint32_t lookups = bs.hits + bs.misses;
+        if (lookups > 0) {
+            vga_puts_color("  Hit rate: ", THEME_LABEL);
+            draw_bar(bs.hits, lookups, 20);
+        }
+    }
+
     vga_puts_color("\n", THEME_DEFAULT);
 }
@@ -4,10 +4,14 @@
 #include "cmd_halt.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
+#include "../fs/leonfs.h"
 
 void cmd_halt(const char *args) {
     (void)args;
     vga_puts_color("Desligando...\n", THEME_WARNING);
+
+    // Grava setores pendentes do buffer cache antes de parar
+    leonfs_sync();
     vga_puts_color("(Sistema parado. Feche o QEMU ou pressione Ctrl+C)\n", THEME_DIM);
     
     // Desabilita interrupções
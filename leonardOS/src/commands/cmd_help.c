@@ -31,10 +31,11 @@ void cmd_help(const char *args) {
     help_cmd("help",    "lista de comandos");
     help_cmd("clear",   "limpa a tela");
     help_cmd("sysinfo", "informacoes do sistema");
-    help_cmd("mem",     "uso de memoria");
+    help_cmd("mem",     "uso de memoria (--heap [on|off]: por site)");
     help_cmd("df",      "uso de disco");
+    help_cmd("sync",    "grava pendentes no disco");
     help_cmd("env",     "variaveis de ambiente");
-    help_cmd("test",    "teste automatizado");
+    help_cmd("test",    "teste automatizado (test ram0: LeonFS em RAM disk)");
     help_cmd("reboot",  "reinicia o sistema");
     help_cmd("halt",    "desliga o kernel");
 
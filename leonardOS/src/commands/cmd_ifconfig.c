@@ -6,7 +6,7 @@
 #include "../common/colors.h"
 #include "../common/string.h"
 #include "../net/net_config.h"
-#include "../drivers/net/rtl8139.h"
+#include "../drivers/net/netdev.h"
 
 void cmd_ifconfig(const char *args) {
     net_config_t *cfg = net_get_config();
@@ -67,8 +67,12 @@ void cmd_ifconfig(const char *args) {
         return;
     }
 
-    vga_puts_color("  eth0", THEME_TITLE);
-    vga_puts_color("  RTL8139\n", THEME_DIM);
+    netdev_t *dev = netdev_get();
+    vga_puts_color("  ", THEME_TITLE);
+    vga_puts_color(dev->name, THEME_TITLE);
+    vga_puts_color("  ", THEME_DIM);
+    vga_puts_color(dev->driver, THEME_DIM);
+    vga_putchar('\n');
 
     char buf[18];
 
@@ -4,8 +4,11 @@
 #include "cmd_mem.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
+#include "../common/string.h"
 #include "../memory/pmm.h"
 #include "../memory/heap.h"
+#include "../memory/slab.h"
+#include "../drivers/timer/pit.h"
 
 // ============================================================
 // Helper: Desenha barra de progresso visual
@@ -41,11 +44,90 @@ static void section_header(const char *title) {
     vga_puts_color("╚══════════════════════════════════════╝\n", THEME_BORDER);
 }
 
+// ============================================================
+// mem --heap [on|off] — Profiler do heap por site de alocação
+// ============================================================
+static void mem_heap_profile(const char *opt) {
+    while (*opt == ' ') opt++;
+    if (kstrcmp(opt, "on") == 0 || kstrcmp(opt, "off") == 0) {
+        heap_set_tracking(opt[1] == 'n');
+        vga_puts_color("Rastreamento do heap ", THEME_INFO);
+        vga_puts_color(heap_tracking() ? "ligado\n" : "desligado\n", THEME_DIM);
+        return;
+    }
+
+    static heap_profile_t prof;
+    heap_profile(&prof);
+    uint32_t now = pit_get_ms();
+
+    section_header("Heap: sites de alocacao");
+    if (!heap_tracking() && prof.tracked_blocks == 0) {
+        vga_puts_color("  Rastreamento desligado (mem --heap on)\n", THEME_DIM);
+    }
+    for (uint32_t i = 0; i < prof.site_count; i++) {
+        heap_site_t *s = &prof.sites[i];
+        vga_puts_color("  0x", THEME_LABEL);
+        vga_puthex(s->caller);
+        vga_puts_color("  ", THEME_DIM);
+        vga_set_color(THEME_INFO);
+        vga_putint(s->live_bytes);
+        vga_puts_color(" bytes, ", THEME_DIM);
+        vga_putint(s->live_blocks);
+        vga_puts_color(" blocos, mais antigo ha ", THEME_DIM);
+        vga_putint((now - s->oldest_ms) / 1000);
+        vga_puts_color("s\n", THEME_DIM);
+    }
+    if (prof.total_sites > prof.site_count || prof.other_bytes > 0) {
+        vga_puts_color("  ... ", THEME_DIM);
+        vga_putint(prof.total_sites - prof.site_count);
+        vga_puts_color(" sites a mais", THEME_DIM);
+        if (prof.other_bytes > 0) {
+            vga_puts_color(", ", THEME_DIM);
+            vga_putint(prof.other_bytes);
+            vga_puts_color(" bytes fora da tabela", THEME_DIM);
+        }
+        vga_putchar('\n');
+    }
+    vga_puts_color("  Blocos sem site: ", THEME_LABEL);
+    vga_putint(prof.untracked_blocks);
+    vga_puts_color(" (alocados com rastreamento desligado)\n", THEME_DIM);
+
+    section_header("Heap: tamanhos em uso");
+    for (uint32_t i = 0; i < HEAP_PROF_BUCKETS; i++) {
+        if (prof.histogram[i] == 0) continue;
+        uint32_t lo = 8u << i;
+        uint32_t shown = lo >= 1024 ? lo / 1024 : lo;
+        vga_puts_color("  >= ", THEME_LABEL);
+        vga_putint(shown);
+        vga_puts_color(lo >= 1024 ? "KB" : "B ", THEME_LABEL);
+        for (uint32_t w = shown; w < 1000; w *= 10) vga_putchar(' ');
+        vga_puts_color("  ", THEME_DIM);
+        vga_set_color(THEME_INFO);
+        vga_putint(prof.histogram[i]);
+        vga_puts_color(" blocos\n", THEME_DIM);
+    }
+
+    vga_puts_color("  Fragmentacao:  ", THEME_LABEL);
+    vga_set_color(prof.frag_pct > 50 ? THEME_WARNING : THEME_INFO);
+    vga_putint(prof.frag_pct);
+    vga_puts_color("% (maior livre ", THEME_DIM);
+    vga_putint(prof.largest_free);
+    vga_puts_color(" de ", THEME_DIM);
+    vga_putint(prof.free_bytes);
+    vga_puts_color(" bytes em ", THEME_DIM);
+    vga_putint(prof.free_blocks);
+    vga_puts_color(" blocos)\n", THEME_DIM);
+}
+
 // ============================================================
 // Comando mem
 // ============================================================
 void cmd_mem(const char *args) {
-    (void)args;
+    while (args && *args == ' ') args++;
+    if (args && kstrncmp(args, "--heap", 6) == 0) {
+        mem_heap_profile(args + 6);
+        return;
+    }
 
     struct pmm_stats stats = pmm_get_stats();
 
@@ -59,6 +141,12 @@ void cmd_mem(const char *args) {
     vga_putint(stats.total_frames);
     vga_puts_color(" total (4KB cada)\n", THEME_DIM);
 
+    vga_puts_color("  Bitmap:        ", THEME_LABEL);
+    vga_putint(stats.bitmap_frames * 4);
+    vga_puts_color(" KB (cobre ", THEME_DIM);
+    vga_putint(stats.tracked_frames / 256);
+    vga_puts_color(" MB)\n", THEME_DIM);
+
     vga_puts_color("  Livres:        ", THEME_LABEL);
     vga_set_color(THEME_BOOT_OK);
     vga_putint(stats.free_frames);
@@ -66,6 +154,13 @@ void cmd_mem(const char *args) {
     vga_putint(stats.free_memory_kb / 1024);
     vga_puts_color(" MB)\n", THEME_DIM);
 
+    // Acima do identity map: só o heap sob demanda usa (bcache, pbuf,
+    // arena, slab e RAM disk ficam abaixo de 16MB)
+    vga_puts_color("  Acima de 16MB: ", THEME_LABEL);
+    vga_set_color(THEME_INFO);
+    vga_putint(stats.high_free_frames / 256);
+    vga_puts_color(" MB livres, so para o heap\n", THEME_DIM);
+
     vga_puts_color("  Usados:        ", THEME_LABEL);
     vga_set_color(THEME_BOOT_FAIL);
     vga_putint(stats.used_frames);
@@ -78,6 +173,27 @@ void cmd_mem(const char *args) {
     vga_putint(stats.kernel_frames);
     vga_puts_color(" frames\n", THEME_DIM);
 
+    vga_puts_color("  DMA contiguo:  ", THEME_LABEL);
+    vga_set_color(THEME_INFO);
+    vga_putint(stats.contig_allocs);
+    vga_puts_color(" alocacoes", THEME_DIM);
+    if (stats.contig_failures > 0) {
+        vga_puts_color(", ", THEME_DIM);
+        vga_set_color(THEME_WARNING);
+        vga_putint(stats.contig_failures);
+        vga_puts_color(" falhas", THEME_DIM);
+    }
+    vga_putchar('\n');
+
+    vga_puts_color("  Pool zerado:   ", THEME_LABEL);
+    vga_set_color(THEME_INFO);
+    vga_putint(stats.zero_pool);
+    vga_puts_color(" frames (", THEME_DIM);
+    vga_putint(stats.zero_hits);
+    vga_puts_color(" hits, ", THEME_DIM);
+    vga_putint(stats.zero_misses);
+    vga_puts_color(" misses)\n", THEME_DIM);
+
     vga_puts_color("  Uso:           ", THEME_LABEL);
     draw_progress_bar(stats.used_frames, stats.total_frames, 24);
 
@@ -90,8 +206,12 @@ void cmd_mem(const char *args) {
     vga_puts_color("  Total:         ", THEME_LABEL);
     vga_putint(hs.total_bytes);
     vga_puts_color(" bytes (", THEME_DIM);
+    vga_putint(hs.pages_reserved);
+    vga_puts_color(" paginas, ", THEME_DIM);
     vga_putint(hs.pages_allocated);
-    vga_puts_color(" paginas)\n", THEME_DIM);
+    vga_puts_color(" residentes, ", THEME_DIM);
+    vga_putint(hs.pages_committed);
+    vga_puts_color(" comprometidas)\n", THEME_DIM);
 
     vga_puts_color("  Usado:         ", THEME_LABEL);
     vga_set_color(THEME_BOOT_FAIL);
@@ -117,5 +237,40 @@ void cmd_mem(const char *args) {
     int total_heap = hs.used_bytes + hs.free_bytes;
     draw_progress_bar(hs.used_bytes, total_heap, 24);
 
+    // ── Slab caches ──
+    if (kmem_cache_count() > 0) {
+        section_header("Slab Caches");
+
+        vga_puts_color("  Cache           Obj  Ativos/Total  Slabs  Allocs/Frees\n", THEME_LABEL);
+        for (int i = 0; i < kmem_cache_count(); i++) {
+            kmem_cache_stats_t cs;
+            if (!kmem_cache_get_stats(i, &cs)) continue;
+
+            vga_puts_color("  ", THEME_DEFAULT);
+            vga_puts_color(cs.name, THEME_INFO);
+            for (int pad = kstrlen(cs.name); pad < 16; pad++) vga_putchar(' ');
+            vga_set_color(THEME_VALUE);
+            vga_putint(cs.obj_size);
+            vga_puts_color("  ", THEME_DEFAULT);
+            vga_set_color(THEME_BOOT_FAIL);
+            vga_putint(cs.active_objs);
+            vga_puts_color("/", THEME_DIM);
+            vga_putint(cs.total_objs);
+            vga_puts_color("  ", THEME_DEFAULT);
+            vga_set_color(THEME_VALUE);
+            vga_putint(cs.slabs);
+            vga_puts_color("  ", THEME_DEFAULT);
+            vga_set_color(THEME_DIM);
+            vga_putint(cs.allocs);
+            vga_puts_color("/", THEME_DIM);
+            vga_putint(cs.frees);
+            if (cs.failures > 0) {
+                vga_puts_color("  falhas: ", THEME_WARNING);
+                vga_putint(cs.failures);
+            }
+            vga_putchar('\n');
+        }
+    }
+
     vga_puts_color("\n", THEME_DEFAULT);
 }
@@ -5,7 +5,8 @@
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
 #include "../net/net_config.h"
-#include "../drivers/net/rtl8139.h"
+#include "../drivers/net/netdev.h"
+#include "../net/pbuf.h"
 
 void cmd_netstat(const char *args) {
     (void)args;
@@ -18,10 +19,14 @@ void cmd_netstat(const char *args) {
         return;
     }
 
-    nic_stats_t st = rtl8139_get_stats();
+    netdev_t *dev = netdev_get();
+    nic_stats_t st = dev->stats;
 
-    vga_puts_color("  eth0 ", THEME_TITLE);
-    vga_puts_color("RTL8139\n\n", THEME_DIM);
+    vga_puts_color("  ", THEME_TITLE);
+    vga_puts_color(dev->name, THEME_TITLE);
+    vga_putchar(' ');
+    vga_puts_color(dev->driver, THEME_DIM);
+    vga_puts("\n\n");
 
     vga_puts_color("    TX pacotes  ", THEME_LABEL);
     vga_set_color(THEME_VALUE);
@@ -42,6 +47,22 @@ void cmd_netstat(const char *args) {
     vga_putint((long)st.tx_errors);
     vga_putchar('\n');
 
+    vga_puts_color("    TX fila     ", THEME_LABEL);
+    vga_set_color(THEME_VALUE);
+    vga_putint((long)st.tx_queue_depth);
+    vga_puts_color(" (max ", THEME_DIM);
+    vga_putint((long)st.tx_queue_max);
+    vga_puts_color(", esperas ", THEME_DIM);
+    vga_putint((long)st.tx_stalls);
+    vga_puts_color(", kicks ", THEME_DIM);
+    vga_putint((long)st.tx_kicks);
+    vga_puts_color(")", THEME_DIM);
+    if (st.tx_drops > 0) {
+        vga_puts_color("  descartes: ", THEME_WARNING);
+        vga_putint((long)st.tx_drops);
+    }
+    vga_putchar('\n');
+
     vga_putchar('\n');
 
     vga_puts_color("    RX pacotes  ", THEME_LABEL);
@@ -61,6 +82,40 @@ void cmd_netstat(const char *args) {
         vga_set_color(THEME_VALUE);
     }
     vga_putint((long)st.rx_errors);
+    vga_putchar('\n');
+
+    vga_puts_color("    RX polls    ", THEME_LABEL);
+    vga_set_color(THEME_VALUE);
+    vga_putint((long)st.rx_polls);
+    vga_puts_color(" (budget esgotado ", THEME_DIM);
+    vga_putint((long)st.rx_budget_hits);
+    vga_puts_color(")\n", THEME_DIM);
+
+    if (dev->features & (NETDEV_F_TX_CSUM | NETDEV_F_RX_CSUM)) {
+        vga_puts_color("    Checksum    ", THEME_LABEL);
+        vga_puts_color("TX NIC ", THEME_DIM);
+        vga_set_color(THEME_VALUE);
+        vga_putint((long)st.tx_csum_offload);
+        vga_puts_color(", RX NIC ", THEME_DIM);
+        vga_set_color(THEME_VALUE);
+        vga_putint((long)st.rx_csum_ok);
+        vga_putchar('\n');
+    }
+    vga_putchar('\n');
+
+    pbuf_stats_t pb = pbuf_get_stats();
+    vga_puts_color("    pbufs       ", THEME_LABEL);
+    vga_set_color(THEME_VALUE);
+    vga_putint((long)pb.free);
+    vga_puts_color("/", THEME_DIM);
+    vga_putint((long)pb.total);
+    vga_puts_color(" livres (min ", THEME_DIM);
+    vga_putint((long)pb.min_free);
+    vga_puts_color(")", THEME_DIM);
+    if (pb.failures > 0) {
+        vga_puts_color("  falhas: ", THEME_WARNING);
+        vga_putint((long)pb.failures);
+    }
     vga_puts("\n\n");
 
     vga_set_color(THEME_DEFAULT);
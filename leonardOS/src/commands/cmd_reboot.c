@@ -4,12 +4,16 @@
 #include "cmd_reboot.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
+#include "../fs/leonfs.h"
 #include "../common/io.h"
 
 void cmd_reboot(const char *args) {
     (void)args;
     vga_puts_color("Reiniciando...\n", THEME_WARNING);
 
+    // Grava setores pendentes do buffer cache antes de parar
+    leonfs_sync();
+
     // Desabilita interrupções
     asm volatile("cli");
 
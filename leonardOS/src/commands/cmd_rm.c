@@ -8,7 +8,7 @@
 //   rm -r /tmp/subdir      → remove diretório (mesmo com filhos)
 //
 // Diretórios sem -r só são removidos se estiverem vazios.
-// Não permite remover "/" nem o diretório atual.
+// Não permite remover "/" nem o diretório atual (ou um ancestral dele).
 
 #include "cmd_rm.h"
 #include "../drivers/vga/vga.h"
@@ -88,9 +88,13 @@ void cmd_rm(const char *args) {
         return;
     }
 
-    // Não permite remover o diretório atual
-    if (kstrcmp(full_path, current_path) == 0) {
-        vga_puts_color("rm: nao pode remover diretorio atual\n", THEME_ERROR);
+    // Não permite remover o diretório atual nem um ancestral dele
+    // (nós removidos voltam ao slab: current_dir ficaria apontando
+    // para memória reaproveitada pelo próximo arquivo criado)
+    int full_len = kstrlen(full_path);
+    if (kstrncmp(current_path, full_path, full_len) == 0 &&
+        (current_path[full_len] == '\0' || current_path[full_len] == '/')) {
+        vga_puts_color("rm: nao pode remover o diretorio atual ou um ancestral\n", THEME_ERROR);
         return;
     }
 
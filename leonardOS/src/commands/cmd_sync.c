@@ -0,0 +1,48 @@
+// LeonardOS - Comando: sync
+// Grava metadados do LeonFS + buffer cache e envia flush a cada dispositivo
+
+#include "cmd_sync.h"
+#include "../drivers/vga/vga.h"
+#include "../drivers/disk/blkdev.h"
+#include "../common/colors.h"
+#include "../fs/leonfs.h"
+#include "../fs/bcache.h"
+
+void cmd_sync(const char *args) {
+    (void)args;
+
+    if (blkdev_count() == 0) {
+        vga_puts_color("sync: nenhum dispositivo de bloco\n", THEME_WARNING);
+        return;
+    }
+
+    bcache_stats_t before = bcache_get_stats();
+
+    // LeonFS montado: leonfs_sync grava metadados + bcache + flush do dispositivo
+    bool ok = true;
+    if (leonfs_get_superblock()) ok = leonfs_sync();
+
+    // Demais dispositivos (ou todos, sem LeonFS)
+    ok = bcache_sync(NULL) && ok;
+    uint32_t flushes = 0;
+    for (int i = 0; i < blkdev_count(); i++) {
+        blkdev_t *dev = blkdev_get(i);
+        if (dev != leonfs_get_device()) {           // Já feito pelo leonfs_sync
+            ok = blkdev_flush(dev) && ok;
+        }
+        flushes += dev->stats.flushes;              // Total de todos os dispositivos
+    }
+
+    bcache_stats_t after = bcache_get_stats();
+
+    if (!ok) {
+        vga_puts_color("sync: erro de I/O\n", THEME_ERROR);
+        return;
+    }
+
+    vga_puts_color("sync: ", THEME_LABEL);
+    vga_putint(after.writebacks - before.writebacks);
+    vga_puts_color(" setores gravados, cache do disco descarregado (flushes: ", THEME_DEFAULT);
+    vga_putint(flushes);
+    vga_puts_color(")\n", THEME_DEFAULT);
+}
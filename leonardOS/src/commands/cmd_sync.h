@@ -0,0 +1,9 @@
+// LeonardOS - Comando: sync
+// Grava no disco os dados pendentes e esvazia o cache de escrita
+
+#ifndef __CMD_SYNC_H__
+#define __CMD_SYNC_H__
+
+void cmd_sync(const char *args);
+
+#endif
@@ -12,19 +12,28 @@
 #include "../cpu/gdt.h"
 #include "../cpu/idt.h"
 #include "../cpu/isr.h"
+#include "../cpu/softirq.h"
 #include "../drivers/pic/pic.h"
 #include "../drivers/keyboard/keyboard.h"
+#include "../drivers/timer/pit.h"
 #include "../memory/pmm.h"
 #include "../memory/vmm.h"
 #include "../memory/heap.h"
+#include "../memory/slab.h"
+#include "../memory/arena.h"
 #include "../fs/vfs.h"
 #include "../fs/ramfs.h"
 #include "../drivers/disk/ide.h"
+#include "../drivers/disk/ramdisk.h"
 #include "../fs/leonfs.h"
+#include "../fs/bcache.h"
 #include "../shell/shell.h"
 #include "../drivers/net/rtl8139.h"
+#include "../drivers/net/virtio_net.h"
+#include "../drivers/net/e1000.h"
 #include "../net/net_config.h"
 #include "../net/ethernet.h"
+#include "../net/pbuf.h"
 #include "../net/arp.h"
 #include "../net/ipv4.h"
 #include "../net/icmp.h"
@@ -203,6 +212,14 @@ static void test_gdt(void) {
 // ============================================================
 // 3. Teste da IDT
 // ============================================================
+static volatile int softirq_test_runs;
+static bool softirq_test_rearm;
+
+static void softirq_test_action(void) {
+    softirq_test_runs++;
+    if (softirq_test_rearm) softirq_raise(SOFTIRQ_COUNT - 1);
+}
+
 static void test_idt(void) {
     test_header("IDT (Interrupt Descriptor Table)");
 
@@ -266,6 +283,32 @@ static void test_idt(void) {
     test_info_hex("Handler INT 33 (KBD)", handler33);
     test_result("Handler ISR 0 != 0", handler0 != 0, NULL);
     test_result("Handler INT 33 != 0", handler33 != 0, NULL);
+
+    // Softirq: vetor livre, sob cli para a saída das IRQs não roubar a execução
+    uint32_t vec = SOFTIRQ_COUNT - 1;
+    softirq_register(vec, softirq_test_action);
+    asm volatile("cli");
+    softirq_test_runs = 0;
+    softirq_test_rearm = false;
+    softirq_raise(vec);
+    softirq_run();
+    int single = softirq_test_runs;
+
+    // Ação que sempre se re-agenda para no limite de rodadas
+    softirq_stats_t before = softirq_get_stats();
+    softirq_test_runs = 0;
+    softirq_test_rearm = true;
+    softirq_raise(vec);
+    softirq_run();
+    int rearmed = softirq_test_runs;
+    softirq_stats_t after = softirq_get_stats();
+    softirq_register(vec, NULL);
+    asm volatile("sti");
+
+    test_result("Softirq: raise + run executa 1x", single == 1, NULL);
+    test_result("Softirq: re-agendamento limitado",
+                rearmed == SOFTIRQ_MAX_RESTART && after.deferred == before.deferred + 1, NULL);
+    test_info_int("Softirq NET_RX execucoes", (int)after.runs[SOFTIRQ_NET_RX]);
 }
 
 // ============================================================
@@ -481,6 +524,9 @@ static void test_pmm(void) {
     test_result("Kernel usa frames", stats.kernel_frames > 0, NULL);
     test_result("Consistencia: total = used + free",
                 stats.total_frames == stats.used_frames + stats.free_frames, NULL);
+    test_info_int("Frames no bitmap", stats.tracked_frames);
+    test_result("Bitmap cobre toda a RAM", stats.tracked_frames >= stats.total_frames, NULL);
+    test_result("Bitmap reservado", stats.bitmap_frames > 0, NULL);
 
     // Teste de alloc/free
     uint32_t frame1 = pmm_alloc_frame();
@@ -523,11 +569,130 @@ static void test_pmm(void) {
 
     // Kernel region deve estar protegida
     test_result("Kernel (0x100000) protegido", pmm_is_frame_used(0x100000), NULL);
+
+    // First-fit: frame liberado é o próximo a sair
+    uint32_t frame3 = pmm_alloc_frame();
+    pmm_free_frame(frame3);
+    test_result("Realoca o menor frame livre", pmm_alloc_frame() == frame3, NULL);
+    pmm_free_frame(frame3);
+
+    // Intervalo contíguo alinhado: 5 frames começando em múltiplo de 16KB
+    uint32_t run = pmm_alloc_frames(5, 4);
+    test_result("pmm_alloc_frames(5, 4) != 0", run != 0, NULL);
+    test_info_hex("Intervalo alocado", run);
+    test_result("Intervalo alinhado (16KB)", run % (4 * PMM_FRAME_SIZE) == 0, NULL);
+    bool all_used = run != 0;
+    for (uint32_t i = 0; all_used && i < 5; i++) {
+        all_used = pmm_is_frame_used(run + i * PMM_FRAME_SIZE);
+    }
+    test_result("5 frames marcados como usados", all_used, NULL);
+    test_result("used_frames +5", pmm_get_stats().used_frames == stats.used_frames + 5, NULL);
+
+    pmm_free_frames(run, 5);
+    test_result("pmm_free_frames restaura stats",
+                pmm_get_stats().used_frames == stats.used_frames, NULL);
+    test_result("Alinhamento invalido rejeitado", pmm_alloc_frames(2, 3) == 0, NULL);
+
+    // DMA: 3 frames contíguos, alinhados a 64KB, abaixo de 16MB
+    uint32_t dma = pmm_alloc_contiguous(3, 0x10000, PMM_DMA_MAX_PHYS);
+    test_result("pmm_alloc_contiguous(3, 64KB, 16MB) != 0", dma != 0, NULL);
+    test_info_hex("Intervalo DMA", dma);
+    test_result("DMA alinhado a 64KB", dma % 0x10000 == 0, NULL);
+    test_result("DMA abaixo de 16MB", dma + 3 * PMM_FRAME_SIZE <= PMM_DMA_MAX_PHYS, NULL);
+    test_result("DMA frames usados",
+                dma != 0 && pmm_is_frame_used(dma) &&
+                pmm_is_frame_used(dma + 2 * PMM_FRAME_SIZE), NULL);
+    pmm_free_contiguous(dma, 3);
+    test_result("pmm_free_contiguous restaura stats",
+                pmm_get_stats().used_frames == stats.used_frames, NULL);
+    test_result("Limite menor que o pedido falha",
+                pmm_alloc_contiguous(4, 0, 2 * PMM_FRAME_SIZE) == 0, NULL);
+
+    // Pool pré-zerado: refill (como no tempo ocioso) e alocação sem memset
+    pmm_zero_pool_refill();
+    struct pmm_stats zs = pmm_get_stats();
+    test_info_int("Pool de frames zerados", zs.zero_pool);
+    test_result("Refill encheu o pool", zs.zero_pool > 0, NULL);
+
+    // Suja um frame e devolve: o próximo zerado não pode ter lixo
+    uint32_t dirty = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (dirty) {
+        kmemset((void *)(uintptr_t)dirty, 0xA5, PMM_FRAME_SIZE);
+        pmm_free_contiguous(dirty, 1);
+    }
+    uint32_t zf = pmm_alloc_zeroed_frame();
+    test_result("pmm_alloc_zeroed_frame != 0", zf != 0, NULL);
+    if (zf) {
+        bool all_zero = true;
+        const uint32_t *w = (const uint32_t *)(uintptr_t)zf;
+        for (uint32_t i = 0; i < PMM_FRAME_SIZE / 4; i++) {
+            if (w[i]) { all_zero = false; break; }
+        }
+        test_result("Frame do pool todo zerado", all_zero, NULL);
+        test_result("Servido pelo pool (hit)",
+                    pmm_get_stats().zero_hits == zs.zero_hits + 1, NULL);
+        pmm_free_frame(zf);
+    }
 }
 
 // ============================================================
 // 10. Teste do Paging (VMM)
 // ============================================================
+
+// Microbenchmark de page walk / TLB
+// A mesma região física (8-12MB) é lida por dois caminhos: o identity map
+// (PDE de 4MB se PSE) e um alias em 0x2000000 com 1024 PTEs de 4KB.
+// Antes de cada passada o TLB é esvaziado (reload do CR3): com 4MB a
+// passada faz um walk; com 4KB, um walk por página
+#define TLB_BENCH_PHYS    0x800000
+#define TLB_BENCH_ALIAS   0x2000000
+#define TLB_BENCH_PAGES   PAGE_ENTRIES
+#define TLB_BENCH_PASSES  16
+
+static uint32_t tlb_bench_pass(uint32_t base, uint32_t *sum) {
+    uint32_t cr3;
+    asm volatile("mov %%cr3, %0; mov %0, %%cr3" : "=r"(cr3) :: "memory");
+
+    uint64_t t0 = rdtsc();
+    for (uint32_t i = 0; i < TLB_BENCH_PAGES; i++) {
+        // Linha de cache diferente em cada página (evita conflito de set)
+        *sum += *(volatile uint32_t *)(base + i * PAGE_SIZE + (i % 64) * 64);
+    }
+    return (uint32_t)(rdtsc() - t0);
+}
+
+static void test_tlb_bench(void) {
+    for (uint32_t i = 0; i < TLB_BENCH_PAGES; i++) {
+        map_page(TLB_BENCH_ALIAS + i * PAGE_SIZE, TLB_BENCH_PHYS + i * PAGE_SIZE, PAGE_KERNEL);
+    }
+
+    // Sem IRQs: nem ruído na medida nem escritas na região entre passadas
+    uint32_t eflags;
+    asm volatile("pushfl; pop %0; cli" : "=r"(eflags) :: "memory");
+
+    uint32_t sum_large = 0, sum_small = 0;
+    uint32_t cyc_large = 0, cyc_small = 0;
+    for (int pass = 0; pass < TLB_BENCH_PASSES; pass++) {
+        cyc_large += tlb_bench_pass(TLB_BENCH_PHYS, &sum_large);
+        cyc_small += tlb_bench_pass(TLB_BENCH_ALIAS, &sum_small);
+    }
+
+    if (eflags & 0x200) asm volatile("sti");
+
+    for (uint32_t i = 0; i < TLB_BENCH_PAGES; i++) {
+        unmap_page(TLB_BENCH_ALIAS + i * PAGE_SIZE);
+    }
+    test_result("TLB bench: Page Table do alias devolvida",
+                vmm_free_page_table(TLB_BENCH_ALIAS), NULL);
+
+    uint32_t accesses = TLB_BENCH_PAGES * TLB_BENCH_PASSES;
+    test_result("TLB bench: alias 4KB le os mesmos dados", sum_large == sum_small, NULL);
+    test_info("TLB bench identity",
+              paging_get_stats().pse_enabled ? "PDE de 4MB" : "PTEs de 4KB");
+    test_info_int("Ciclos/acesso identity", cyc_large / accesses);
+    test_info_int("Ciclos/acesso alias 4KB", cyc_small / accesses);
+}
+
 static void test_paging(void) {
     test_header("Paging / VMM");
 
@@ -547,10 +712,23 @@ static void test_paging(void) {
     struct vmm_stats stats = paging_get_stats();
     test_info_int("Paginas mapeadas", stats.pages_mapped);
     test_info_int("Page Tables usadas", stats.page_tables_used);
+    test_info_int("Paginas de 4MB", stats.large_pages);
+    test_info_int("Paginas de 4MB divididas", stats.large_splits);
     test_info_int("Identity map (MB)", stats.identity_map_mb);
     test_info_int("Page faults", stats.page_faults);
 
-    test_result("Page Tables >= 4 (16MB/4MB)", stats.page_tables_used >= 4, NULL);
+    // Cada 4MB do identity map é uma PDE grande ou uma Page Table
+    test_result("PDEs do identity >= 4 (16MB/4MB)",
+                stats.large_pages + stats.page_tables_used >= 4, NULL);
+    if (stats.pse_enabled) {
+        uint32_t cr4;
+        asm volatile("mov %%cr4, %0" : "=r"(cr4));
+        test_result("CR4.PSE habilitado", (cr4 & CR4_PSE) != 0, NULL);
+        test_result("PDE 0 e pagina de 4MB",
+                    (((uint32_t *)cr3)[0] & PAGE_SIZE_4MB) != 0, NULL);
+    } else {
+        test_info("PSE", "nao suportado (Page Tables de 4KB)");
+    }
     // 16MB / 4KB = 4096 páginas
     test_result("Paginas mapeadas == 4096", stats.pages_mapped >= 4096, NULL);
 
@@ -567,6 +745,29 @@ static void test_paging(void) {
     uint32_t zero_phys = get_physical_addr(0x0);
     test_result("Identity: 0x0 -> 0x0", zero_phys == 0x0, NULL);
 
+    // Offset dentro de uma página (grande ou não) é preservado
+    test_result("Identity: 0x9ABCDE -> 0x9ABCDE",
+                get_physical_addr(0x9ABCDE) == 0x9ABCDE, NULL);
+
+    // map_page dentro de uma página de 4MB divide a PDE: remapear uma página
+    // do identity sobre ela mesma não muda nada, e o resto continua identity.
+    // Depois a PDE de 4MB é restaurada (o teste não deixa o split para trás)
+    if (((uint32_t *)cr3)[PAGE_DIR_INDEX(0xC00000)] & PAGE_SIZE_4MB) {
+        map_page(0xC00000, 0xC00000, PAGE_KERNEL);
+        test_result("Split de 4MB: pagina remapeada",
+                    get_physical_addr(0xC00000) == 0xC00000, NULL);
+        test_result("Identity apos split: 0xC01234",
+                    get_physical_addr(0xC01234) == 0xC01234, NULL);
+        test_result("Split contabilizado",
+                    paging_get_stats().large_splits > stats.large_splits, NULL);
+        test_result("PDE de 4MB restaurada",
+                    vmm_merge_large_page(0xC00000) &&
+                    (((uint32_t *)cr3)[PAGE_DIR_INDEX(0xC00000)] & PAGE_SIZE_4MB) &&
+                    paging_get_stats().large_pages == stats.large_pages &&
+                    paging_get_stats().page_tables_used == stats.page_tables_used &&
+                    get_physical_addr(0xC01234) == 0xC01234, NULL);
+    }
+
     // Verifica is_page_mapped em região identity-mapped
     test_result("is_page_mapped(0x100000)", is_page_mapped(0x100000), NULL);
     test_result("is_page_mapped(0xB8000)", is_page_mapped(0xB8000), NULL);
@@ -606,6 +807,8 @@ static void test_paging(void) {
 
     test_result("Page faults == 0 (nenhum inesperado)",
                 paging_get_stats().page_faults == 0, NULL);
+
+    test_tlb_bench();
 }
 
 // ============================================================
@@ -618,8 +821,10 @@ static void test_heap(void) {
     struct heap_stats s0 = heap_get_stats();
     test_info_int("Heap total (bytes)", s0.total_bytes);
     test_info_int("Heap livre (bytes)", s0.free_bytes);
-    test_info_int("Paginas alocadas", s0.pages_allocated);
+    test_info_int("Paginas reservadas", s0.pages_reserved);
+    test_info_int("Paginas residentes", s0.pages_allocated);
     test_result("Heap inicializado (pages > 0)", s0.pages_allocated > 0, NULL);
+    test_result("Residentes <= reservadas", s0.pages_allocated <= s0.pages_reserved, NULL);
     test_result("1 bloco livre inicial", s0.free_blocks >= 1, NULL);
     test_info_int("Blocos usados (pre-existentes)", s0.used_blocks);
 
@@ -682,6 +887,156 @@ static void test_heap(void) {
     // kmalloc(0) deve retornar NULL
     void *e = kmalloc(0);
     test_result("kmalloc(0) == NULL", e == NULL, NULL);
+
+    // Boundary tags: liberar x, z e depois y (meio) junta os três na hora
+    struct heap_stats s5 = heap_get_stats();
+    void *x = kmalloc(200);
+    void *y = kmalloc(200);
+    void *z = kmalloc(200);
+    kfree(x);
+    kfree(z);
+    kfree(y);
+    struct heap_stats s6 = heap_get_stats();
+    test_result("Merge imediato (x, z, y)",
+                x && y && z && s6.free_blocks == s5.free_blocks &&
+                s6.free_bytes == s5.free_bytes, NULL);
+
+    // Ponteiro do meio de um bloco (sem header válido) é ignorado
+    uint8_t *p = (uint8_t *)kmalloc(64);
+    if (p) {
+        kmemset(p, 0, 64);
+        uint32_t fc = heap_get_stats().free_count;
+        kfree(p + 32);
+        test_result("kfree de ponteiro invalido ignorado",
+                    heap_get_stats().free_count == fc, NULL);
+        kfree(p);
+    }
+
+    // Profiler: 3 blocos do mesmo site aparecem agregados
+    bool was_tracking = heap_tracking();
+    heap_set_tracking(true);
+    void *tb[3];
+    for (int i = 0; i < 3; i++) tb[i] = kmalloc(100);   // Mesmo endereço de retorno
+    static heap_profile_t prof;
+    heap_profile(&prof);
+    bool site_found = false;
+    for (uint32_t i = 0; i < prof.site_count; i++) {
+        if (prof.sites[i].live_blocks >= 3 && prof.sites[i].live_bytes >= 300) site_found = true;
+    }
+    test_result("Profiler: site com 3 blocos / 300 bytes",
+                tb[0] && tb[1] && tb[2] && site_found, NULL);
+    test_result("Profiler: blocos rastreados", prof.tracked_blocks >= 3, NULL);
+    test_result("Profiler: fragmentacao 0..100%", prof.frag_pct <= 100, NULL);
+    test_info_int("Fragmentacao (%)", prof.frag_pct);
+    for (int i = 0; i < 3; i++) kfree(tb[i]);
+    heap_set_tracking(was_tracking);
+
+    // Janela sob demanda: 1MB reservado só custa as páginas tocadas
+    struct heap_stats d0 = heap_get_stats();
+    uint32_t df0 = paging_get_stats().demand_faults;
+    uint8_t *big = (uint8_t *)kmalloc(1024 * 1024);
+    test_result("kmalloc(1MB) != NULL", big != NULL, NULL);
+    if (big) {
+        struct heap_stats d1 = heap_get_stats();
+        test_result("kmalloc(1MB): sem frames para o buffer",
+                    d1.pages_allocated <= d0.pages_allocated + 2, NULL);
+        test_result("kmalloc(1MB): 256 paginas comprometidas",
+                    d1.pages_committed >= d0.pages_committed + 256, NULL);
+        test_result("Residentes <= comprometidas", d1.pages_allocated <= d1.pages_committed, NULL);
+
+        big[0] = 1;
+        big[512 * 1024] = 2;
+        big[1024 * 1024 - 1] = 3;
+        struct heap_stats d2 = heap_get_stats();
+        test_result("3 paginas tocadas: <= 3 frames novos",
+                    d2.pages_allocated <= d1.pages_allocated + 3, NULL);
+        test_result("Page faults sob demanda resolvidos",
+                    paging_get_stats().demand_faults > df0, NULL);
+        test_result("Dados nas paginas sob demanda",
+                    big[0] == 1 && big[512 * 1024] == 2 && big[1024 * 1024 - 1] == 3, NULL);
+        test_info_int("Residentes com 1MB reservado", d2.pages_allocated);
+
+        kfree(big);
+        struct heap_stats d3 = heap_get_stats();
+        test_result("kfree(1MB): paginas devolvidas ao PMM",
+                    d3.pages_allocated <= d0.pages_allocated + 1, NULL);
+        test_result("kfree(1MB): compromisso devolvido",
+                    d3.pages_committed + 250 <= d1.pages_committed, NULL);
+    }
+
+    // Slab: enche um slab e passa para o próximo, depois devolve tudo
+    kmem_cache_t *cache = kmem_cache_create("test_obj", 36);
+    test_result("kmem_cache_create != NULL", cache != NULL, NULL);
+    if (cache) {
+        static void *objs[128];
+        uint32_t per_slab = cache->objs_per_slab;
+        uint32_t n = per_slab + 1;
+        if (n > 128) n = 128;
+        test_info_int("Objetos por slab", (int)per_slab);
+
+        bool aligned = true;
+        uint32_t got = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            objs[i] = kmem_cache_alloc(cache);
+            if (!objs[i]) break;
+            if ((uint32_t)(uintptr_t)objs[i] % SLAB_ALIGNMENT) aligned = false;
+            got++;
+        }
+        test_result("kmem_cache_alloc x (slab+1)", got == n, NULL);
+        test_result("Objetos alinhados a 8", aligned, NULL);
+        test_result("Tamanho alinhado (36 -> 40)", cache->obj_size == 40, NULL);
+        test_result("Segundo slab alocado", cache->slabs >= 2, NULL);
+        test_result("Objetos distintos", got < 2 || objs[0] != objs[1], NULL);
+
+        for (uint32_t i = 0; i < got; i++) kmem_cache_free(cache, objs[i]);
+        test_result("Todos liberados: active == 0", cache->active == 0, NULL);
+        test_result("Slabs vazios voltam ao PMM", cache->slabs <= SLAB_KEEP_EMPTY, NULL);
+
+        // Mesmo nome com outro tamanho não devolve o cache existente
+        test_result("kmem_cache_create: tamanho divergente -> NULL",
+                    kmem_cache_create("test_obj", 72) == NULL, NULL);
+
+        // Ponteiros que não são objetos deste cache são rejeitados
+        uint32_t frees = cache->frees;
+        void *heap_ptr = kmalloc(64);
+        kmem_cache_free(cache, heap_ptr);
+        kfree(heap_ptr);
+        test_result("free de ponteiro do heap rejeitado", cache->frees == frees, NULL);
+
+        kmem_cache_t *other = kmem_cache_create("test_obj2", 36);
+        void *foreign = other ? kmem_cache_alloc(other) : NULL;
+        if (foreign) {
+            kmem_cache_free(cache, foreign);
+            test_result("free de objeto de outro cache rejeitado",
+                        cache->frees == frees && other->active == 1, NULL);
+            kmem_cache_free(other, foreign);
+        }
+    }
+
+    // Arena: bump pointer sem overhead, chunk extra, reset e destroy
+    uint32_t used_before = pmm_get_stats().used_frames;
+    arena_t *ar = arena_create(1);
+    test_result("arena_create != NULL", ar != NULL, NULL);
+    if (ar) {
+        uint8_t *a1 = (uint8_t *)arena_alloc(ar, 100);
+        uint8_t *a2 = (uint8_t *)arena_alloc(ar, 100);
+        test_result("Arena: alocacoes adjacentes (sem header)",
+                    a1 && a2 == a1 + 104, NULL);
+        test_result("Arena: alinhado a 8", ((uint32_t)(uintptr_t)a2 % ARENA_ALIGNMENT) == 0, NULL);
+
+        uint8_t *a3 = (uint8_t *)arena_alloc(ar, 3 * PMM_FRAME_SIZE);
+        test_result("Arena: pedido maior que o chunk", a3 != NULL, NULL);
+        if (a3) kmemset(a3, 0x5A, 3 * PMM_FRAME_SIZE);
+        test_result("Arena: used contabiliza", arena_used(ar) == 208 + 3 * PMM_FRAME_SIZE, NULL);
+
+        arena_reset(ar);
+        test_result("arena_reset: used == 0", arena_used(ar) == 0, NULL);
+        test_result("arena_reset: reusa o inicio", arena_alloc(ar, 8) == a1, NULL);
+
+        arena_destroy(ar);
+        test_result("arena_destroy devolve os frames",
+                    pmm_get_stats().used_frames == used_before, NULL);
+    }
 }
 
 // ============================================================
@@ -947,6 +1302,11 @@ static void test_rm_cp(void) {
 
         vfs_node_t *gone = vfs_finddir(tmp, "rm_test.txt");
         test_result("Arquivo removido = NULL", gone == NULL, NULL);
+
+        // Nó devolvido ao slab fica envenenado: ponteiro velho não lê nada
+        uint8_t stale[16];
+        test_result("No removido envenenado",
+                    rf->type == 0 && !rf->fs_data && vfs_read(rf, 0, 9, stale) == 0, NULL);
     }
 
     // --- Teste rm de diretório vazio ---
@@ -1057,6 +1417,52 @@ static void test_ide(void) {
         kmemset(buf, 0, 512);
         ide_write_sectors(test_sector, 1, buf);
     }
+
+    // Multi-setor cruzando frames dos bounce buffers (2 entradas PRD no DMA)
+    test_info("Modo", disk->dma ? "DMA (bus-master)" : "PIO");
+    if (test_sector + 9 < disk->total_sectors) {
+        static uint8_t mbuf[9 * 512];
+        static uint8_t mverify[9 * 512];
+        for (uint32_t i = 0; i < sizeof(mbuf); i++) mbuf[i] = (uint8_t)(i * 13 + 5);
+
+        ide_stats_t is0 = ide_get_stats();
+        ok = ide_write_sectors(test_sector, 9, mbuf) &&
+             ide_read_sectors(test_sector, 9, mverify);
+        ide_stats_t is1 = ide_get_stats();
+        test_result("Escrita+leitura 9 setores", ok &&
+                    kmemcmp(mbuf, mverify, sizeof(mbuf)) == 0, NULL);
+        if (disk->dma) {
+            test_result("Comandos via DMA", is1.dma_cmds == is0.dma_cmds + 2, NULL);
+        }
+
+        kmemset(mbuf, 0, sizeof(mbuf));
+        ide_write_sectors(test_sector, 9, mbuf);
+    }
+
+    // Barreira de escrita explícita (escritas não fazem mais flush)
+    if (test_sector < disk->total_sectors) {
+        kmemset(buf, 0, 512);
+        ide_stats_t fs0 = ide_get_stats();
+        ide_write_sectors(test_sector, 1, buf);
+        ide_stats_t fs1 = ide_get_stats();
+        test_result("Escrita sem flush implicito", fs1.flushes == fs0.flushes, NULL);
+        test_result("ide_flush", ide_flush() && ide_get_stats().flushes == fs0.flushes + 1, NULL);
+    }
+
+    // Leitura com mais de 256 setores (LBA48: um só comando EXT)
+    test_info("LBA48", disk->lba48 ? "sim" : "nao");
+    uint32_t big = 300;
+    uint8_t *bigbuf = (uint8_t *)kmalloc(big * 512);
+    if (bigbuf && big < disk->total_sectors) {
+        ok = ide_read_sectors(0, (uint16_t)big, bigbuf);
+        test_result("Leitura 300 setores", ok, NULL);
+
+        // Confere o último setor com uma leitura avulsa
+        ok = ok && ide_read_sectors(big - 1, 1, buf);
+        test_result("Ultimo setor confere",
+                    ok && kmemcmp(buf, bigbuf + (big - 1) * 512, 512) == 0, NULL);
+    }
+    if (bigbuf) kfree(bigbuf);
 }
 
 // ============================================================
@@ -1065,11 +1471,51 @@ static void test_ide(void) {
 static void test_leonfs(void) {
     test_header("LeonFS");
 
-    const ide_disk_info_t *disk = ide_get_info();
-    if (!disk || !disk->present) {
-        test_info("SKIP", "Nenhum disco detectado");
+    blkdev_t *dev = leonfs_get_device();
+    if (!dev) {
+        test_info("SKIP", "LeonFS nao montado");
         return;
     }
+    test_info("Dispositivo", dev->name);
+
+    // Camada blkdev: pedido fora do dispositivo é rejeitado
+    {
+        uint8_t tmp[512];
+        uint32_t errors = dev->stats.errors;
+        test_result("blkdev: rejeita LBA fora do disco",
+                    !blkdev_read(dev, blkdev_size(dev), 1, tmp) &&
+                    dev->stats.errors == errors + 1, NULL);
+    }
+
+    // Fila do blkdev: 4 leituras adjacentes enfileiradas fora de ordem
+    // viram um único comando (3 merges) com o mesmo conteúdo
+    {
+        static uint8_t q_bufs[4][512];
+        static uint8_t q_ref[4 * 512];
+        blk_request_t reqs[4];
+        uint32_t base = LEONFS_INODE_START;
+
+        uint32_t cmds = dev->stats.commands;
+        uint32_t merged = dev->stats.merged;
+        for (int i = 3; i >= 0; i--) {
+            kmemset(&reqs[i], 0, sizeof(blk_request_t));
+            reqs[i].type = BLK_REQ_READ;
+            reqs[i].lba = base + (uint32_t)i;
+            reqs[i].count = 1;
+            reqs[i].buffer = q_bufs[i];
+            blkdev_queue(dev, &reqs[i]);
+        }
+        bool ok = blkdev_wait(dev);
+        test_result("blkdev: fila junta 4 leituras adjacentes",
+                    ok && dev->stats.commands == cmds + 1 &&
+                    dev->stats.merged == merged + 3, NULL);
+
+        bool same = blkdev_read(dev, base, 4, q_ref);
+        for (int i = 0; same && i < 4; i++) {
+            same = kmemcmp(q_bufs[i], q_ref + i * 512, 512) == 0;
+        }
+        test_result("blkdev: leitura via fila == leitura direta", same, NULL);
+    }
 
     // Verifica se /mnt está montado
     vfs_node_t *mnt = vfs_open("/mnt");
@@ -1081,7 +1527,7 @@ static void test_leonfs(void) {
     // Lê superbloco diretamente para verificar formato
     {
         uint8_t sb_buf[512];
-        ide_read_sectors(0, 1, sb_buf);
+        blkdev_read(dev, LEONFS_SUPERBLOCK_SECTOR, 1, sb_buf);
         leonfs_superblock_t *sb = (leonfs_superblock_t *)sb_buf;
         test_result("Superbloco magic", sb->magic == LEONFS_MAGIC, NULL);
         test_result("Superbloco version == 1", sb->version == 1, NULL);
@@ -1097,27 +1543,219 @@ static void test_leonfs(void) {
     // Teste de finddir: busca algo que não existe
     vfs_node_t *nope = vfs_finddir(mnt, "nao_existe_xyz");
     test_result("finddir inexistente == NULL", nope == NULL, NULL);
+
+    // Alocação de blocos (bitmap em RAM): escreve, remove e confere contadores
+    leonfs_superblock_t *sb = leonfs_get_superblock();
+    if (sb) {
+        uint32_t inodes_before = sb->free_inodes;
+        vfs_node_t *f = leonfs_create_file(mnt, "_test_bitmap.bin");
+        test_result("LeonFS: cria arquivo de teste", f != NULL, NULL);
+        test_result("LeonFS: 1 inode alocado", sb->free_inodes == inodes_before - 1, NULL);
+        if (f) {
+            // Medido após criar: dir_add_entry pode alocar bloco para o diretório
+            uint32_t free_before = sb->free_blocks;
+            static uint8_t data[2048];
+            for (uint32_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 7);
+            uint32_t w = vfs_write(f, 0, sizeof(data), data);
+            test_result("LeonFS: escrita 2KB", w == sizeof(data), NULL);
+            test_result("LeonFS: 4 blocos alocados",
+                        sb->free_blocks == free_before - 4, NULL);
+
+            static uint8_t back[2048];
+            uint32_t r = vfs_read(f, 0, sizeof(back), back);
+            test_result("LeonFS: releitura confere",
+                        r == sizeof(back) && kmemcmp(data, back, sizeof(data)) == 0, NULL);
+
+            // Segunda leitura deve vir inteira do buffer cache
+            bcache_stats_t bc0 = bcache_get_stats();
+            vfs_read(f, 0, sizeof(back), back);
+            bcache_stats_t bc1 = bcache_get_stats();
+            if (bc0.buffers > 0) {
+                test_result("bcache: releitura sem miss", bc1.misses == bc0.misses, NULL);
+                test_result("bcache: releitura com hits", bc1.hits > bc0.hits, NULL);
+            }
+
+            // Escrita parcial em bloco novo: montado em RAM (zeros + dados)
+            uint32_t w2 = vfs_write(f, sizeof(data) + 100, 16, data);
+            uint32_t r2 = vfs_read(f, sizeof(data), 116, back);
+            bool zeros = true;
+            for (uint32_t i = 0; i < 100; i++) if (back[i] != 0) { zeros = false; break; }
+            test_result("LeonFS: escrita parcial em bloco novo",
+                        w2 == 16 && r2 == 116 && zeros &&
+                        kmemcmp(back + 100, data, 16) == 0, NULL);
+            test_result("LeonFS: remove arquivo de teste",
+                        leonfs_remove(mnt, "_test_bitmap.bin"), NULL);
+            test_result("LeonFS: blocos devolvidos ao bitmap",
+                        sb->free_blocks == free_before, NULL);
+            test_result("LeonFS: inode devolvido", sb->free_inodes == inodes_before, NULL);
+        }
+    }
+
+    // cp para /mnt em pedaços grandes: os blocos inteiros vão em sequências
+    // multi-setor direto ao dispositivo, não setor a setor
+    vfs_node_t *tmp = vfs_open("/tmp");
+    vfs_node_t *big = tmp ? ramfs_create_file(tmp, "_cp_big.bin") : NULL;
+    if (big && !(dev->flags & BLKDEV_F_NOCACHE) && bcache_get_stats().buffers > 0) {
+        static uint8_t pattern[RAMFS_MAX_FILE_SIZE];
+        for (uint32_t i = 0; i < sizeof(pattern); i++) pattern[i] = (uint8_t)(i * 11 + 3);
+        vfs_write(big, 0, sizeof(pattern), pattern);
+
+        extern void cmd_cp(const char*);
+        bcache_stats_t cp0 = bcache_get_stats();
+        cmd_cp("/tmp/_cp_big.bin /mnt/_cp_big.bin");
+        bcache_stats_t cp1 = bcache_get_stats();
+
+        vfs_node_t *copy = vfs_finddir(mnt, "_cp_big.bin");
+        static uint8_t back[RAMFS_MAX_FILE_SIZE];
+        test_result("cp: /tmp -> /mnt 4KB confere",
+                    copy && vfs_read(copy, 0, sizeof(back), back) == sizeof(back) &&
+                    kmemcmp(pattern, back, sizeof(back)) == 0, NULL);
+        // Com pedaços de 512 bytes nenhum setor iria direto
+        test_result("cp: blocos gravados em sequencias multi-setor",
+                    cp1.direct > cp0.direct, NULL);
+        leonfs_remove(mnt, "_cp_big.bin");
+    }
+    if (big) ramfs_remove(tmp, "_cp_big.bin");
+
+    // Append em pedaços de 512 bytes: cada vfs_write é uma operação com
+    // barreira própria, que grava só os setores que sujou (dado + inode +
+    // bitmap + superbloco) com um só FLUSH. Uma escrita de 4KB também
+    // termina com um único FLUSH
+    if (sb && !(dev->flags & BLKDEV_F_NOCACHE) && bcache_get_stats().buffers > 0) {
+        vfs_node_t *f = leonfs_create_file(mnt, "_test_append.bin");
+        test_result("LeonFS: cria arquivo de append", f != NULL, NULL);
+        if (f) {
+            static uint8_t chunk[512];
+            const uint32_t chunks = 8;
+
+            uint32_t w = 0;
+            bool one_flush = true;
+            bool few_sectors = true;
+            uint32_t max_sectors = 0;
+            for (uint32_t i = 0; i < chunks; i++) {
+                uint32_t flushes0 = dev->stats.flushes;
+                uint32_t sectors0 = dev->stats.sectors_written;
+                kmemset(chunk, (int)('a' + i), sizeof(chunk));
+                w += vfs_write(f, i * sizeof(chunk), sizeof(chunk), chunk);
+                uint32_t sectors = dev->stats.sectors_written - sectors0;
+                if (dev->stats.flushes != flushes0 + 1) one_flush = false;
+                if (sectors == 0 || sectors > 4) few_sectors = false;
+                if (sectors > max_sectors) max_sectors = sectors;
+            }
+            test_result("LeonFS: append 8 x 512 bytes", w == chunks * sizeof(chunk), NULL);
+            test_result("LeonFS: um FLUSH por append", one_flush, NULL);
+            test_info_int("Max setores gravados por append", (int)max_sectors);
+            // Dado + inode + bitmap + superbloco, cada um uma vez
+            test_result("LeonFS: append grava so os setores da operacao", few_sectors, NULL);
+
+            static uint8_t block4k[4096];
+            kmemset(block4k, 'z', sizeof(block4k));
+            uint32_t flushes0 = dev->stats.flushes;
+            uint32_t w4 = vfs_write(f, chunks * sizeof(chunk), sizeof(block4k), block4k);
+            test_result("LeonFS: escrita de 4KB com um FLUSH",
+                        w4 == sizeof(block4k) && dev->stats.flushes == flushes0 + 1, NULL);
+
+            uint8_t tail[512];
+            test_result("LeonFS: append confere",
+                        vfs_read(f, (chunks - 1) * sizeof(tail), sizeof(tail), tail) == sizeof(tail) &&
+                        tail[0] == (uint8_t)('a' + chunks - 1), NULL);
+            leonfs_remove(mnt, "_test_append.bin");
+        }
+    }
 }
 
 // ============================================================
-// 17. Teste de Rede (PCI + RTL8139 + Net Config)
+// 17. Teste de Rede (netdev + Net Config)
 // ============================================================
 static void test_network(void) {
-    test_header("Rede (RTL8139 + Net Config)");
+    test_header("Rede (netdev + Net Config)");
 
-    // Verifica se a NIC foi detectada
-    int nic_ok = rtl8139_is_present();
-    test_result("RTL8139 detectada", nic_ok, NULL);
+    // Verifica se a NIC foi detectada e registrada como eth0
+    netdev_t *dev = netdev_get();
+    int nic_ok = dev != NULL;
+    test_result("NIC registrada (eth0)", nic_ok, NULL);
 
     // Verifica MAC address (deve ser != 00:00:00:00:00:00)
     if (nic_ok) {
-        uint8_t mac[6];
-        rtl8139_get_mac(mac);
+        int is_virtio = kstrcmp(dev->driver, "virtio-net") == 0;
+        test_result(dev->driver, dev->ops->send && dev->ops->poll, NULL);
+
         int mac_valid = 0;
         for (int i = 0; i < 6; i++) {
-            if (mac[i] != 0) { mac_valid = 1; break; }
+            if (dev->mac[i] != 0) { mac_valid = 1; break; }
         }
         test_result("MAC != 00:00:00:00:00:00", mac_valid, NULL);
+
+        // RX drenado pelo softirq: todo pacote recebido passou por um poll
+        nic_stats_t nst = dev->stats;
+        test_info_int("RX polls (softirq)", (int)nst.rx_polls);
+        test_info_int("RX budget esgotado", (int)nst.rx_budget_hits);
+        test_result("RX: pacotes => polls", nst.rx_packets == 0 || nst.rx_polls > 0, NULL);
+
+        // TX: fila nunca passa do limite do driver
+        int is_e1000 = kstrcmp(dev->driver, "e1000") == 0;
+        uint32_t tx_limit = is_virtio ? VIRTIO_NET_TX_SLOTS
+                          : is_e1000  ? E1000_TX_MAX_FRAMES
+                          : RTL8139_TX_QUEUE_MAX;
+        test_info_int("TX fila max", (int)nst.tx_queue_max);
+        test_info_int("TX esperas/descartes", (int)(nst.tx_stalls + nst.tx_drops));
+        test_info_int("TX kicks", (int)nst.tx_kicks);
+        test_result("TX: fila <= limite do driver", nst.tx_queue_max <= tx_limit, NULL);
+
+        // Rajada maior que os 4 descriptors do RTL8139: todos saem e os
+        // pbufs voltam (virtio só devolve no poll: força um via softirq).
+        // Outros pacotes podem sair junto, então conta >= 8, com timeout
+        net_config_t *ncfg = net_get_config();
+        uint32_t pb_free = pbuf_get_stats().free;
+        uint32_t tx_before = dev->stats.tx_packets + dev->stats.tx_errors;
+        for (int i = 0; i < 8; i++) arp_send_request(ncfg->gateway);
+
+        uint32_t tx_done = 0;
+        bool pb_back = false;
+        for (int waited = 0; waited < 500; waited += 10) {
+            softirq_raise(SOFTIRQ_NET_RX);
+            pit_sleep_ms(10);
+            tx_done = dev->stats.tx_packets + dev->stats.tx_errors - tx_before;
+            pb_back = pbuf_get_stats().free >= pb_free;
+            if (tx_done >= 8 && pb_back) break;
+        }
+        nst = dev->stats;
+        test_result("TX: rajada de 8 concluida", tx_done >= 8, NULL);
+        test_result("TX: pbufs devolvidos", pb_back, NULL);
+
+        // Checksum offload: a pilha só deixa checksums para placas que anunciam
+        test_info_int("Checksum TX na NIC", (int)nst.tx_csum_offload);
+        test_info_int("Checksum RX na NIC", (int)nst.rx_csum_ok);
+
+        // Segmento TCP (RST ao gateway, porta discard) com PBUF_F_CSUM_L4: o
+        // campo leva só a soma do pseudo-header e o driver conta o offload.
+        // A NIC insere o checksum na cópia dela; o pbuf (ref extra) fica igual
+        if (dev->features & NETDEV_F_TX_CSUM) {
+            pbuf_t *p = pbuf_alloc(PBUF_TRANSPORT, 0);
+            if (p) {
+                tcp_header_t *th = (tcp_header_t *)pbuf_push(p, TCP_HLEN_MIN);
+                kmemset(th, 0, TCP_HLEN_MIN);
+                th->src_port = htons(40000);
+                th->dst_port = htons(9);
+                th->data_offset = (TCP_HLEN_MIN / 4) << 4;
+                th->flags = TCP_RST;
+                uint16_t seed = ip_pseudo_sum(ncfg->ip, ncfg->gateway,
+                                              IP_PROTO_TCP, TCP_HLEN_MIN);
+                th->checksum = seed;
+                p->flags |= PBUF_F_CSUM_L4;
+
+                uint32_t off0 = dev->stats.tx_csum_offload;
+                pbuf_ref(p);
+                bool sent = ipv4_send(ncfg->gateway, IP_PROTO_TCP, p);
+                test_result("TX offload: campo TCP = ip_pseudo_sum",
+                            sent && th->checksum == seed &&
+                            (p->flags & (PBUF_F_CSUM_IP | PBUF_F_CSUM_L4)) ==
+                            (PBUF_F_CSUM_IP | PBUF_F_CSUM_L4), NULL);
+                test_result("TX offload: tx_csum_offload +1",
+                            sent && dev->stats.tx_csum_offload == off0 + 1, NULL);
+                pbuf_free(p);
+            }
+        }
     }
 
     // Verifica config de rede
@@ -1158,6 +1796,51 @@ static void test_network(void) {
     test_result("Ethernet: stats acessiveis", 1, NULL);
     (void)eth_st;
 
+    // pbuf: headroom de transporte consumido por TCP + IP + Ethernet
+    if (nic_ok) {
+        pbuf_stats_t pb0 = pbuf_get_stats();
+        pbuf_t *p = pbuf_alloc(PBUF_TRANSPORT, 100);
+        test_result("pbuf: alloc com headroom", p != NULL && p->len == 100, NULL);
+        if (p) {
+            bool pushed = pbuf_push(p, TCP_HLEN_MIN) && pbuf_push(p, IPV4_HLEN) &&
+                          pbuf_push(p, ETH_HLEN);
+            test_result("pbuf: push TCP+IP+Eth no lugar",
+                        pushed && p->payload == p->buf && p->len == 154, NULL);
+            test_result("pbuf: frame alinhado para DMA", ((uint32_t)p->payload & 3) == 0, NULL);
+            test_result("pbuf: push sem headroom falha", pbuf_push(p, 1) == NULL, NULL);
+
+            pbuf_ref(p);
+            pbuf_free(p);
+            test_result("pbuf: ref mantem fora do pool", pbuf_get_stats().free == pb0.free - 1, NULL);
+            pbuf_free(p);
+        }
+        test_result("pbuf: free devolve ao pool", pbuf_get_stats().free == pb0.free, NULL);
+        test_result("pbuf: grande demais rejeitado", pbuf_alloc(PBUF_TRANSPORT, PBUF_BUF_SIZE) == NULL, NULL);
+        test_info_int("pbufs livres (min)", (int)pbuf_get_stats().min_free);
+    }
+
+    // Checksum com pseudo-header sem buffer contíguo == soma do buffer montado
+    {
+        ip_addr_t a = {{10, 0, 2, 15}}, b = {{10, 0, 2, 2}};
+        uint8_t seg[7] = {0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE};
+        uint8_t flat[12 + sizeof(seg)] = {10, 0, 2, 15, 10, 0, 2, 2, 0, IP_PROTO_UDP, 0, sizeof(seg)};
+        kmemcpy(flat + 12, seg, sizeof(seg));
+        test_result("ip_checksum_pseudo == checksum contiguo",
+                    ip_checksum_pseudo(a, b, IP_PROTO_UDP, seg, sizeof(seg)) ==
+                    ip_checksum(flat, sizeof(flat)), NULL);
+
+        // Offload: NIC soma o segmento sobre a semente do pseudo-header
+        uint8_t dgram[10] = {0x30, 0x39, 0x00, 0x35, 0x00, 0x0A, 0x00, 0x00, 0xAB, 0xCD};
+        uint16_t full = ip_checksum_pseudo(a, b, IP_PROTO_UDP, dgram, sizeof(dgram));
+        uint16_t seed = ip_pseudo_sum(a, b, IP_PROTO_UDP, sizeof(dgram));
+        kmemcpy(dgram + 6, &seed, 2);
+        test_result("ip_pseudo_sum: semente + NIC == software",
+                    ip_checksum(dgram, sizeof(dgram)) == full, NULL);
+        kmemcpy(dgram + 6, &full, 2);
+        test_result("RX: checksum TCP/UDP valido confere 0",
+                    ip_checksum_pseudo(a, b, IP_PROTO_UDP, dgram, sizeof(dgram)) == 0, NULL);
+    }
+
     // Verifica ARP inicializado
     int arp_count = 0;
     const arp_entry_t *arp_tbl = arp_get_table(&arp_count);
@@ -1244,8 +1927,37 @@ static void test_network(void) {
 // ============================================================
 // 18. Teste do sistema de Comandos
 // ============================================================
+// "test ram0": o LeonFS é remontado num RAM disk durante a suíte, mesmo
+// com disco IDE, para medir o custo de CPU do LeonFS sem latência de disco.
+// *home recebe o dispositivo a remontar no fim (NULL = nada a restaurar)
+static bool test_mount_ram0(blkdev_t **home) {
+    *home = leonfs_get_device();
+    if (!*home) {
+        vga_puts_color("test: LeonFS nao montado\n", THEME_ERROR);
+        return false;
+    }
+    // Nós abaixo de /mnt são descartados no remount
+    if (kstrncmp(current_path, "/mnt", 4) == 0 &&
+        (current_path[4] == '\0' || current_path[4] == '/')) {
+        vga_puts_color("test: saia de /mnt antes (cd /)\n", THEME_ERROR);
+        return false;
+    }
+
+    blkdev_t *ram = blkdev_find("ram0");
+    if (!ram) ram = ramdisk_create("ram0", RAMDISK_DEFAULT_SECTORS);
+    if (!ram || !leonfs_remount(ram)) {
+        vga_puts_color("test: falha ao montar LeonFS em ram0\n", THEME_ERROR);
+        return false;
+    }
+    if (*home == ram) *home = NULL;
+    return true;
+}
+
 void cmd_test(const char *args) {
-    (void)args;
+    while (args && *args == ' ') args++;
+
+    blkdev_t *home = NULL;
+    if (args && kstrcmp(args, "ram0") == 0 && !test_mount_ram0(&home)) return;
 
     tests_passed = 0;
     tests_failed = 0;
@@ -1278,6 +1990,9 @@ void cmd_test(const char *args) {
     test_network();
     test_commands();
 
+    // Devolve /mnt ao dispositivo de antes do "test ram0"
+    if (home) leonfs_remount(home);
+
     // Resumo final
     vga_puts_color("\n══════════════════════════════════════════════════\n", THEME_BORDER);
     vga_puts_color("  RESULTADO: ", THEME_TITLE);
@@ -34,6 +34,7 @@
 #include "cmd_nslookup.h"
 #include "cmd_wget.h"
 #include "cmd_artdog.h"
+#include "cmd_sync.h"
 
 // ============================================================
 // Tabela de comandos
@@ -49,6 +50,7 @@ static const command_t command_table[] = {
     { "test",     "teste automatizado",             cmd_test     },
     { "mem",      "uso de memoria fisica",          cmd_mem      },
     { "df",       "uso de disco",                   cmd_df       },
+    { "sync",     "grava dados pendentes no disco", cmd_sync     },
     { "ls",       "lista diretorio",                cmd_ls       },
     { "cat",      "exibe arquivo",                  cmd_cat      },
     { "echo",     "escreve texto",                  cmd_echo     },
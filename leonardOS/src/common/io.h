@@ -63,4 +63,23 @@ static inline void io_wait(void) {
     outb(0x80, 0);
 }
 
+// Lê o contador de ciclos da CPU (Time Stamp Counter)
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Desabilita interrupções e devolve o EFLAGS anterior (para irq_restore)
+static inline uint32_t irq_save(void) {
+    uint32_t eflags;
+    asm volatile("pushfl; pop %0; cli" : "=r"(eflags) :: "memory");
+    return eflags;
+}
+
+// Reabilita interrupções só se estavam habilitadas em irq_save (IF = bit 9)
+static inline void irq_restore(uint32_t eflags) {
+    if (eflags & 0x200) asm volatile("sti" ::: "memory");
+}
+
 #endif
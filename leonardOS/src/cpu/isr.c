@@ -4,6 +4,7 @@
 #include "isr.h"
 #include "idt.h"
 #include "gdt.h"
+#include "softirq.h"
 #include "../common/io.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
@@ -133,6 +134,12 @@ void isr_dispatcher(struct isr_frame *frame) {
             outb(0xA0, 0x20);  // EOI ao slave
         }
         outb(0x20, 0x20);  // EOI ao master
+
+        // Bottom halves: só se o código interrompido estava com IF=1
+        // (uma seção com cli não pode ver protocolo rodando no meio dela)
+        if (frame->eflags & 0x200) {
+            softirq_run();
+        }
     }
 }
 
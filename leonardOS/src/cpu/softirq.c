@@ -0,0 +1,67 @@
+// LeonardOS - Softirqs (bottom halves)
+// Mapa de pendentes + tabela de ações, executadas na saída das IRQs
+
+#include "softirq.h"
+#include "../common/io.h"
+
+static softirq_action_t actions[SOFTIRQ_COUNT];
+static volatile uint32_t pending = 0;
+static volatile bool running = false;
+static softirq_stats_t stats;
+
+// ============================================================
+// softirq_register — associa a ação ao vetor
+// ============================================================
+void softirq_register(uint32_t vec, softirq_action_t action) {
+    if (vec >= SOFTIRQ_COUNT) return;
+    actions[vec] = action;
+}
+
+// ============================================================
+// softirq_raise — marca o vetor como pendente
+// ============================================================
+void softirq_raise(uint32_t vec) {
+    if (vec >= SOFTIRQ_COUNT) return;
+    uint32_t flags = irq_save();
+    pending |= 1u << vec;
+    stats.raised[vec]++;
+    irq_restore(flags);
+}
+
+// ============================================================
+// softirq_run — roda as ações pendentes (IF=1 durante as ações)
+// ============================================================
+void softirq_run(void) {
+    uint32_t flags = irq_save();
+    if (running || !pending) {
+        irq_restore(flags);
+        return;
+    }
+    running = true;
+
+    // Cada rodada consome o mapa inteiro; ações que ainda têm
+    // trabalho chamam softirq_raise() e entram na rodada seguinte
+    for (int round = 0; pending && round < SOFTIRQ_MAX_RESTART; round++) {
+        uint32_t work = pending;
+        pending = 0;
+
+        asm volatile("sti" ::: "memory");
+        for (uint32_t vec = 0; vec < SOFTIRQ_COUNT; vec++) {
+            if (!(work & (1u << vec)) || !actions[vec]) continue;
+            actions[vec]();
+            stats.runs[vec]++;
+        }
+        asm volatile("cli" ::: "memory");
+    }
+    if (pending) stats.deferred++;
+
+    running = false;
+    irq_restore(flags);
+}
+
+// ============================================================
+// softirq_get_stats — retorna contadores
+// ============================================================
+softirq_stats_t softirq_get_stats(void) {
+    return stats;
+}
@@ -0,0 +1,47 @@
+// LeonardOS - Softirqs (bottom halves)
+// Trabalho adiado pelos IRQ handlers, executado com interrupções habilitadas
+//
+// O handler de IRQ só reconhece o hardware e chama softirq_raise();
+// softirq_run() roda as ações pendentes na saída da IRQ (depois do EOI),
+// desde que o código interrompido estivesse com IF=1.
+// API: softirq_register, softirq_raise, softirq_run, softirq_get_stats
+
+#ifndef __SOFTIRQ_H__
+#define __SOFTIRQ_H__
+
+#include "../common/types.h"
+
+// Vetores de softirq (bit no mapa de pendentes)
+#define SOFTIRQ_NET_RX       0
+#define SOFTIRQ_COUNT        4
+
+// Rodadas máximas por softirq_run(): ações que se re-agendam
+// (budget esgotado) ficam para a próxima IRQ (tick do PIT = 10ms)
+#define SOFTIRQ_MAX_RESTART  10
+
+typedef void (*softirq_action_t)(void);
+
+typedef struct {
+    uint32_t raised[SOFTIRQ_COUNT];     // softirq_raise() por vetor
+    uint32_t runs[SOFTIRQ_COUNT];       // Execuções da ação por vetor
+    uint32_t deferred;                  // Saídas com trabalho pendente (limite de rodadas)
+} softirq_stats_t;
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Registra a ação de um vetor (substitui a anterior)
+void softirq_register(uint32_t vec, softirq_action_t action);
+
+// Marca o vetor como pendente — seguro dentro de IRQ handlers
+void softirq_raise(uint32_t vec);
+
+// Executa as ações pendentes com interrupções habilitadas
+// Não reentra: chamada aninhada (IRQ durante uma ação) retorna direto
+void softirq_run(void);
+
+// Retorna contadores
+softirq_stats_t softirq_get_stats(void);
+
+#endif
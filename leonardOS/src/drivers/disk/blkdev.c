@@ -0,0 +1,266 @@
+// LeonardOS - Block Device Layer
+// Registro de dispositivos e despacho de pedidos para o backend
+//
+// blkdev_queue valida o intervalo e insere o pedido na fila do dispositivo
+// (ordenada por LBA); blkdev_wait percorre a fila como um elevador de uma
+// passada, junta pedidos adjacentes num comando só e contabiliza
+// estatísticas (profundidade, merges, latência) por dispositivo.
+
+#include "blkdev.h"
+#include "../../common/string.h"
+#include "../../common/io.h"
+
+// ============================================================
+// Estado global
+// ============================================================
+static blkdev_t *devices[BLKDEV_MAX_DEVICES];
+static int device_count = 0;
+
+// ============================================================
+// blkdev_register — Adiciona um dispositivo à tabela
+// ============================================================
+bool blkdev_register(blkdev_t *dev) {
+    if (!dev || !dev->ops || !dev->ops->read || !dev->ops->write || !dev->ops->size) {
+        return false;
+    }
+    if (device_count >= BLKDEV_MAX_DEVICES) return false;
+    if (blkdev_find(dev->name)) return false;
+
+    kmemset(&dev->stats, 0, sizeof(dev->stats));
+    dev->queued = 0;
+    devices[device_count++] = dev;
+    return true;
+}
+
+// ============================================================
+// blkdev_find — Busca pelo nome
+// ============================================================
+blkdev_t *blkdev_find(const char *name) {
+    if (!name) return NULL;
+    for (int i = 0; i < device_count; i++) {
+        if (kstrcmp(devices[i]->name, name) == 0) return devices[i];
+    }
+    return NULL;
+}
+
+blkdev_t *blkdev_get(int index) {
+    if (index < 0 || index >= device_count) return NULL;
+    return devices[index];
+}
+
+int blkdev_count(void) {
+    return device_count;
+}
+
+uint32_t blkdev_size(blkdev_t *dev) {
+    if (!dev) return 0;
+    return dev->ops->size(dev);
+}
+
+// ============================================================
+// Relógio de latência — TSC em kilociclos (1024 ciclos)
+// ============================================================
+static inline uint32_t now_kc(void) {
+    return (uint32_t)(rdtsc() >> 10);
+}
+
+// Conclui um pedido: resultado, erros e latência desde o enfileiramento
+static void complete(blkdev_t *dev, blk_request_t *req, bool ok) {
+    req->ok = ok;
+    req->done = true;
+    if (!ok) dev->stats.errors++;
+
+    uint32_t lat = now_kc() - req->start_kc;
+    dev->stats.completed++;
+    dev->stats.lat_total_kc += lat;
+    if (lat > dev->stats.lat_max_kc) dev->stats.lat_max_kc = lat;
+}
+
+// Intervalo precisa caber no dispositivo
+static bool range_valid(blkdev_t *dev, const blk_request_t *req) {
+    uint32_t total = dev->ops->size(dev);
+    return req->buffer && req->count > 0 &&
+           req->count <= total && req->lba <= total - req->count;
+}
+
+// Dois pedidos tocam algum setor em comum?
+static bool overlaps(const blk_request_t *a, const blk_request_t *b) {
+    return a->lba < b->lba + b->count && b->lba < a->lba + a->count;
+}
+
+// ============================================================
+// Despacho — um comando do backend para queue[first..last]
+// ============================================================
+// Staging para juntar pedidos adjacentes cujos buffers não são contíguos
+static uint8_t merge_buf[BLKDEV_MERGE_MAX * BLKDEV_SECTOR_SIZE];
+
+static void dispatch_run(blkdev_t *dev, uint32_t first, uint32_t last,
+                         uint32_t sectors, bool contig) {
+    blk_request_t *head = dev->queue[first];
+    bool is_read = head->type == BLK_REQ_READ;
+
+    for (uint32_t i = first; i <= last; i++) {
+        if (is_read) {
+            dev->stats.reads++;
+            dev->stats.sectors_read += dev->queue[i]->count;
+        } else {
+            dev->stats.writes++;
+            dev->stats.sectors_written += dev->queue[i]->count;
+        }
+    }
+    dev->stats.commands++;
+    dev->stats.merged += last - first;
+
+    bool ok;
+    if (contig) {
+        // Buffers já formam uma região única: comando direto
+        ok = is_read
+            ? dev->ops->read(dev, head->lba, (uint16_t)sectors, head->buffer)
+            : dev->ops->write(dev, head->lba, (uint16_t)sectors, head->buffer);
+    } else if (is_read) {
+        ok = dev->ops->read(dev, head->lba, (uint16_t)sectors, merge_buf);
+        if (ok) {
+            uint32_t off = 0;
+            for (uint32_t i = first; i <= last; i++) {
+                uint32_t bytes = (uint32_t)dev->queue[i]->count * BLKDEV_SECTOR_SIZE;
+                kmemcpy(dev->queue[i]->buffer, merge_buf + off, bytes);
+                off += bytes;
+            }
+        }
+    } else {
+        uint32_t off = 0;
+        for (uint32_t i = first; i <= last; i++) {
+            uint32_t bytes = (uint32_t)dev->queue[i]->count * BLKDEV_SECTOR_SIZE;
+            kmemcpy(merge_buf + off, dev->queue[i]->buffer, bytes);
+            off += bytes;
+        }
+        ok = dev->ops->write(dev, head->lba, (uint16_t)sectors, merge_buf);
+    }
+
+    for (uint32_t i = first; i <= last; i++) {
+        complete(dev, dev->queue[i], ok);
+    }
+}
+
+// ============================================================
+// blkdev_wait — Despacha a fila em ordem de LBA
+// ============================================================
+bool blkdev_wait(blkdev_t *dev) {
+    if (!dev) return false;
+    if (dev->queued == 0) return true;
+
+    dev->stats.dispatches++;
+    dev->stats.depth_sum += dev->queued;
+
+    bool all_ok = true;
+    uint32_t i = 0;
+    while (i < dev->queued) {
+        blk_request_t *prev = dev->queue[i];
+        uint32_t sectors = prev->count;
+        bool contig = true;
+        uint32_t j = i;
+
+        // Estende a sequência enquanto o próximo pedido começa exatamente
+        // onde o anterior termina e é do mesmo tipo
+        while (j + 1 < dev->queued) {
+            blk_request_t *next = dev->queue[j + 1];
+            if (next->type != prev->type || next->lba != prev->lba + prev->count) break;
+            if (sectors + next->count > BLKDEV_MAX_COUNT) break;
+
+            bool next_contig = contig &&
+                (uint8_t *)next->buffer ==
+                (uint8_t *)prev->buffer + (uint32_t)prev->count * BLKDEV_SECTOR_SIZE;
+            if (!next_contig && sectors + next->count > BLKDEV_MERGE_MAX) break;
+
+            contig = next_contig;
+            sectors += next->count;
+            prev = next;
+            j++;
+        }
+
+        dispatch_run(dev, i, j, sectors, contig);
+        for (uint32_t k = i; k <= j; k++) {
+            if (!dev->queue[k]->ok) all_ok = false;
+        }
+        i = j + 1;
+    }
+
+    dev->queued = 0;
+    return all_ok;
+}
+
+// ============================================================
+// blkdev_queue — Insere o pedido na fila, ordenado por LBA
+// ============================================================
+bool blkdev_queue(blkdev_t *dev, blk_request_t *req) {
+    if (!req) return false;
+    req->done = false;
+    req->ok = false;
+    if (!dev) return false;
+    req->start_kc = now_kc();
+
+    // FLUSH é barreira: tudo que está na fila vai antes
+    if (req->type == BLK_REQ_FLUSH) {
+        blkdev_wait(dev);
+        dev->stats.flushes++;
+        complete(dev, req, dev->ops->flush ? dev->ops->flush(dev) : true);
+        return req->ok;
+    }
+
+    if (!range_valid(dev, req)) {
+        dev->stats.errors++;
+        req->done = true;
+        return false;
+    }
+
+    // Leitura após escrita (ou escrita sobre escrita) no mesmo setor:
+    // a ordem importa, então esvazia a fila antes
+    for (uint32_t i = 0; i < dev->queued; i++) {
+        blk_request_t *q = dev->queue[i];
+        if ((q->type == BLK_REQ_WRITE || req->type == BLK_REQ_WRITE) && overlaps(q, req)) {
+            blkdev_wait(dev);
+            break;
+        }
+    }
+    if (dev->queued >= BLKDEV_QUEUE_DEPTH) {
+        blkdev_wait(dev);
+    }
+
+    // Inserção ordenada (estável: depois de LBAs iguais)
+    uint32_t pos = dev->queued;
+    while (pos > 0 && dev->queue[pos - 1]->lba > req->lba) {
+        dev->queue[pos] = dev->queue[pos - 1];
+        pos--;
+    }
+    dev->queue[pos] = req;
+    dev->queued++;
+    if (dev->queued > dev->stats.max_depth) dev->stats.max_depth = dev->queued;
+    return true;
+}
+
+// ============================================================
+// blkdev_submit — Executa um pedido (síncrono)
+// ============================================================
+bool blkdev_submit(blkdev_t *dev, blk_request_t *req) {
+    if (!blkdev_queue(dev, req)) return false;
+    if (!req->done) blkdev_wait(dev);
+    return req->ok;
+}
+
+// ============================================================
+// Atalhos síncronos
+// ============================================================
+bool blkdev_read(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer) {
+    blk_request_t req = { BLK_REQ_READ, false, false, 0, lba, count, 0, buffer, 0 };
+    return blkdev_submit(dev, &req);
+}
+
+bool blkdev_write(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer) {
+    blk_request_t req = { BLK_REQ_WRITE, false, false, 0, lba, count, 0, (void *)buffer, 0 };
+    return blkdev_submit(dev, &req);
+}
+
+bool blkdev_flush(blkdev_t *dev) {
+    blk_request_t req = { BLK_REQ_FLUSH, false, false, 0, 0, 0, 0, NULL, 0 };
+    return blkdev_submit(dev, &req);
+}
@@ -0,0 +1,132 @@
+// LeonardOS - Block Device Layer
+// Interface genérica de dispositivos de bloco (setores de 512 bytes)
+//
+// Cada backend (IDE, RAM disk) preenche um blkdev_ops_t e registra o
+// dispositivo com blkdev_register(). Sistemas de arquivos (LeonFS) e o
+// buffer cache falam só com blkdev_t, nunca com o driver diretamente.
+//
+// Fila de pedidos (elevador): blkdev_queue() insere o pedido ordenado por
+// LBA; blkdev_wait() despacha a fila em ordem crescente, juntando pedidos
+// adjacentes do mesmo tipo num único comando do backend.
+// API: blkdev_register, blkdev_find, blkdev_queue, blkdev_wait,
+//      blkdev_submit, blkdev_read/write/flush
+
+#ifndef __BLKDEV_H__
+#define __BLKDEV_H__
+
+#include "../../common/types.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+#define BLKDEV_SECTOR_SIZE   512
+#define BLKDEV_MAX_DEVICES   4
+#define BLKDEV_NAME_LEN      16
+
+// Fila de pedidos por dispositivo
+#define BLKDEV_QUEUE_DEPTH   32
+// Pedidos adjacentes com buffers separados são juntados via buffer de
+// staging (até este tamanho); buffers já contíguos não têm limite extra
+#define BLKDEV_MERGE_MAX     128     // Setores (64KB)
+#define BLKDEV_MAX_COUNT     65535   // Setores por comando do backend
+
+// Flags do dispositivo
+#define BLKDEV_F_NOCACHE     0x01    // Buffer cache não guarda cópias (ex: RAM disk)
+
+// Tipos de pedido
+#define BLK_REQ_READ         0
+#define BLK_REQ_WRITE        1
+#define BLK_REQ_FLUSH        2
+
+// ============================================================
+// Estruturas
+// ============================================================
+
+typedef struct blkdev blkdev_t;
+
+// Pedido de I/O (um intervalo contíguo de setores)
+typedef struct {
+    uint8_t  type;          // BLK_REQ_READ / WRITE / FLUSH
+    bool     done;          // Preenchido ao concluir
+    bool     ok;            // Resultado
+    uint8_t  _pad;
+    uint32_t lba;           // Primeiro setor
+    uint16_t count;         // Setores (ignorado em FLUSH)
+    uint16_t _pad2;
+    void    *buffer;        // count * 512 bytes
+    uint32_t start_kc;      // Instante do enfileiramento (TSC / 1024)
+} blk_request_t;
+
+// Operações implementadas pelo backend
+typedef struct {
+    bool     (*read)(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer);
+    bool     (*write)(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer);
+    bool     (*flush)(blkdev_t *dev);       // Pode ser NULL (nada a fazer)
+    uint32_t (*size)(blkdev_t *dev);        // Total de setores
+} blkdev_ops_t;
+
+typedef struct {
+    uint32_t reads;         // Pedidos de leitura
+    uint32_t writes;        // Pedidos de escrita
+    uint32_t flushes;       // Pedidos de flush
+    uint32_t sectors_read;
+    uint32_t sectors_written;
+    uint32_t errors;
+    // Fila / elevador
+    uint32_t commands;      // Comandos enviados ao backend (após merge)
+    uint32_t merged;        // Pedidos absorvidos por um comando vizinho
+    uint32_t dispatches;    // Execuções da fila (blkdev_wait com pedidos)
+    uint32_t depth_sum;     // Soma da profundidade em cada despacho
+    uint32_t max_depth;     // Maior profundidade observada
+    uint32_t completed;     // Pedidos concluídos (com latência medida)
+    uint32_t lat_total_kc;  // Latência acumulada (kilociclos de TSC)
+    uint32_t lat_max_kc;    // Maior latência (kilociclos)
+} blkdev_stats_t;
+
+struct blkdev {
+    char                name[BLKDEV_NAME_LEN];
+    const blkdev_ops_t *ops;
+    void               *priv;       // Estado do backend
+    uint32_t            flags;      // BLKDEV_F_*
+    blkdev_stats_t      stats;
+    blk_request_t      *queue[BLKDEV_QUEUE_DEPTH];  // Ordenada por LBA
+    uint32_t            queued;
+};
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Registra um dispositivo (nome único). Retorna true se sucesso
+bool blkdev_register(blkdev_t *dev);
+
+// Busca dispositivo pelo nome ("hda", "ram0"). NULL se não existe
+blkdev_t *blkdev_find(const char *name);
+
+// Dispositivo registrado número index (0..blkdev_count()-1)
+blkdev_t *blkdev_get(int index);
+int blkdev_count(void);
+
+// Total de setores do dispositivo
+uint32_t blkdev_size(blkdev_t *dev);
+
+// Enfileira um pedido (o chamador mantém req e o buffer vivos até o
+// blkdev_wait). Fila cheia, pedido sobreposto a outro com escrita, ou
+// FLUSH: a fila é despachada antes (FLUSH é barreira e executa na hora).
+// Retorna false se o pedido já concluiu com erro
+bool blkdev_queue(blkdev_t *dev, blk_request_t *req);
+
+// Despacha a fila em ordem de LBA, juntando pedidos adjacentes
+// Retorna true se todos os pedidos despachados tiveram sucesso
+bool blkdev_wait(blkdev_t *dev);
+
+// Executa um pedido síncrono (queue + wait). Retorna req->ok
+bool blkdev_submit(blkdev_t *dev, blk_request_t *req);
+
+// Atalhos que montam o blk_request_t e chamam blkdev_submit
+bool blkdev_read(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer);
+bool blkdev_write(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer);
+bool blkdev_flush(blkdev_t *dev);
+
+#endif
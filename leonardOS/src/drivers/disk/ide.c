@@ -1,17 +1,52 @@
-// LeonardOS - Driver IDE/ATA (PIO Mode)
-// Implementação de acesso a disco via polling
+// LeonardOS - Driver IDE/ATA (Bus-master DMA + PIO)
+// Implementação de acesso a disco via DMA (PRD table + IRQ14) ou polling
 //
-// Usa LBA28 (endereçamento de 28 bits → suporta até ~128GB)
+// Usa LBA28 (endereçamento de 28 bits → até ~128GB, até 256 setores por
+// comando) e LBA48 (comandos EXT, contagem de 16 bits) quando o disco
+// suporta e o pedido é grande ou passa do limite do LBA28.
 // Apenas barramento primário, drive master.
+//
+// DMA: os dados passam por bounce buffers (frames do PMM, identity-mapped),
+// um frame por entrada PRD. A conclusão é sinalizada pela IRQ14; com
+// interrupções desabilitadas (boot) o status do bus-master é consultado.
 
 #include "ide.h"
+#include "blkdev.h"
 #include "../../common/io.h"
 #include "../../common/string.h"
+#include "../pci/pci.h"
+#include "../pic/pic.h"
+#include "../timer/pit.h"
+#include "../../cpu/isr.h"
+#include "../../memory/pmm.h"
+
+// Timeout de um comando DMA (ticks do PIT, 10ms cada)
+#define IDE_DMA_TIMEOUT_TICKS  500
+
+// Entrada da PRD table (8 bytes, little-endian)
+typedef struct {
+    uint32_t phys;      // Endereço físico da região
+    uint16_t bytes;     // Tamanho em bytes (0 = 64KB)
+    uint16_t flags;     // PRD_EOT na última entrada
+} __attribute__((packed)) prd_entry_t;
 
 // ============================================================
 // Estado global
 // ============================================================
 static ide_disk_info_t disk_info;
+static ide_stats_t ide_stats;
+
+// Bus-master DMA
+static uint16_t     bm_base = 0;                    // I/O base (BAR4)
+static prd_entry_t *prd_table = NULL;               // Frame do PMM
+static uint8_t     *dma_buf = NULL;                 // Bounce buffer contíguo
+
+// Dispositivo de bloco "hda" (registrado em ide_init se há disco)
+static blkdev_t ide_blkdev;
+
+// Sinalização da IRQ14
+static volatile bool    ide_irq_done = false;
+static volatile uint8_t ide_irq_bm_status = 0;
 
 // ============================================================
 // Helpers internos
@@ -45,11 +80,248 @@ static void ide_400ns_delay(void) {
     inb(ATA_PRIMARY_STATUS);
 }
 
+// Pedido precisa de LBA48 (contagem > 256 ou além do limite do LBA28)?
+static bool ide_needs_lba48(uint32_t lba, uint32_t count) {
+    return count > ATA_LBA28_MAX_COUNT || lba + count > ATA_LBA28_MAX_SECTORS;
+}
+
+// Envia LBA + contagem de setores para o drive master
+// LBA28: contagem 256 vai como 0. LBA48: byte alto primeiro em cada registrador.
+static void ide_setup_lba(uint32_t lba, uint16_t count, bool lba48) {
+    if (lba48) {
+        outb(ATA_PRIMARY_DRIVE_HEAD, 0x40);
+
+        // Bytes altos: contagem[15:8], LBA[31:24], LBA[39:32], LBA[47:40]
+        outb(ATA_PRIMARY_SECTOR_COUNT, (uint8_t)(count >> 8));
+        outb(ATA_PRIMARY_LBA_LO,  (uint8_t)(lba >> 24));
+        outb(ATA_PRIMARY_LBA_MID, 0);
+        outb(ATA_PRIMARY_LBA_HI,  0);
+
+        // Bytes baixos
+        outb(ATA_PRIMARY_SECTOR_COUNT, (uint8_t)(count & 0xFF));
+        outb(ATA_PRIMARY_LBA_LO,  (uint8_t)(lba & 0xFF));
+        outb(ATA_PRIMARY_LBA_MID, (uint8_t)((lba >> 8) & 0xFF));
+        outb(ATA_PRIMARY_LBA_HI,  (uint8_t)((lba >> 16) & 0xFF));
+        return;
+    }
+
+    // Seleciona drive master + bits altos do LBA
+    outb(ATA_PRIMARY_DRIVE_HEAD, 0xE0 | ((lba >> 24) & 0x0F));
+
+    // Configura parâmetros
+    outb(ATA_PRIMARY_SECTOR_COUNT, (uint8_t)count);
+    outb(ATA_PRIMARY_LBA_LO,  (uint8_t)(lba & 0xFF));
+    outb(ATA_PRIMARY_LBA_MID, (uint8_t)((lba >> 8) & 0xFF));
+    outb(ATA_PRIMARY_LBA_HI,  (uint8_t)((lba >> 16) & 0xFF));
+}
+
+// Interrupções habilitadas (EFLAGS.IF)?
+static bool ide_irqs_enabled(void) {
+    uint32_t eflags;
+    asm volatile("pushf; pop %0" : "=r"(eflags));
+    return (eflags & 0x200) != 0;
+}
+
+// ============================================================
+// IRQ14 — conclusão de comando no canal primário
+// ============================================================
+static void ide_irq_handler(struct isr_frame *frame) {
+    (void)frame;
+    ide_stats.irqs++;
+
+    // Guarda e limpa o status do bus-master (bits IRQ/ERR são write-1-to-clear)
+    uint8_t bms = inb(bm_base + BM_REG_STATUS);
+    ide_irq_bm_status = bms;
+    outb(bm_base + BM_REG_STATUS, bms | BM_SR_IRQ | BM_SR_ERR);
+
+    // Ler o status ATA reconhece a interrupção no dispositivo
+    inb(ATA_PRIMARY_STATUS);
+    ide_irq_done = true;
+}
+
+// Espera o fim do comando DMA
+static bool ide_dma_wait(void) {
+    if (ide_irqs_enabled()) {
+        // hlt até a IRQ14 (o PIT acorda a CPU a cada 10ms para o timeout).
+        // cli antes do teste + "sti; hlt" evita perder a IRQ entre os dois.
+        uint32_t start = pit_get_ticks();
+        while (1) {
+            asm volatile("cli");
+            if (ide_irq_done) break;
+            if (pit_get_ticks() - start > IDE_DMA_TIMEOUT_TICKS) {
+                asm volatile("sti");
+                return false;
+            }
+            asm volatile("sti; hlt");
+        }
+        asm volatile("sti");
+        return true;
+    }
+
+    // Interrupções desabilitadas (boot): consulta o bit IRQ do bus-master
+    for (int i = 0; i < 1000000; i++) {
+        uint8_t bms = inb(bm_base + BM_REG_STATUS);
+        if (bms & BM_SR_IRQ) {
+            ide_irq_bm_status = bms;
+            outb(bm_base + BM_REG_STATUS, bms | BM_SR_IRQ | BM_SR_ERR);
+            inb(ATA_PRIMARY_STATUS);
+            return true;
+        }
+    }
+    return false;  // timeout
+}
+
+// ============================================================
+// ide_dma_init — Procura o controlador bus-master e prepara PRD/bounce
+// ============================================================
+static bool ide_dma_init(const uint16_t *identify) {
+    // Word 49 bit 8: dispositivo suporta DMA
+    if (!(identify[49] & (1 << 8))) return false;
+
+    pci_device_t dev;
+    if (!pci_find_class(IDE_PCI_CLASS, IDE_PCI_SUBCLASS, &dev)) return false;
+
+    // BAR4 precisa ser I/O space (bit 0 = 1)
+    uint32_t bar4 = pci_config_read32(dev.bus, dev.slot, dev.func, PCI_REG_BAR4);
+    if (!(bar4 & 1) || (bar4 & ~0x3u) == 0) return false;
+
+    // PRD table: um frame (alinhado a 4 bytes, não cruza 64KB)
+    uint32_t prd_phys = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (prd_phys == 0) return false;
+
+    // Bounce buffer: alinhado a 64KB para cada entrada PRD cobrir 64KB
+    uint32_t buf_phys = pmm_alloc_contiguous(IDE_DMA_FRAMES, IDE_PRD_MAX_BYTES,
+                                             PMM_DMA_MAX_PHYS);
+    if (buf_phys == 0) {
+        pmm_free_contiguous(prd_phys, 1);
+        return false;
+    }
+
+    bm_base = (uint16_t)(bar4 & ~0x3u);
+    prd_table = (prd_entry_t *)prd_phys;
+    dma_buf = (uint8_t *)buf_phys;
+    pci_enable_bus_mastering(&dev);
+
+    // Para qualquer transferência pendente e limpa IRQ/ERR
+    outb(bm_base + BM_REG_COMMAND, 0);
+    outb(bm_base + BM_REG_STATUS, BM_SR_IRQ | BM_SR_ERR);
+
+    // Registra IRQ14 e habilita interrupções do dispositivo (nIEN = 0)
+    isr_register_handler(IRQ_TO_INT(IRQ_IDE_PRIMARY), ide_irq_handler);
+    pic_unmask_irq(IRQ_IDE_PRIMARY);
+    outb(ATA_PRIMARY_CONTROL, 0x00);
+
+    return true;
+}
+
+// ============================================================
+// ide_dma_transfer — Um comando READ/WRITE DMA via bounce buffers
+// ============================================================
+static bool ide_dma_transfer(uint32_t lba, uint16_t count, void *buffer, bool write) {
+    uint32_t bytes = (uint32_t)count * ATA_SECTOR_SIZE;
+    uint32_t entries = (bytes + IDE_PRD_MAX_BYTES - 1) / IDE_PRD_MAX_BYTES;
+
+    // Dados de escrita vão para o bounce buffer numa cópia só
+    if (write) kmemcpy(dma_buf, buffer, bytes);
+
+    // Monta a PRD table: uma entrada por janela de 64KB do bounce buffer
+    for (uint32_t i = 0; i < entries; i++) {
+        uint32_t len = bytes - i * IDE_PRD_MAX_BYTES;
+        if (len > IDE_PRD_MAX_BYTES) len = IDE_PRD_MAX_BYTES;
+
+        prd_table[i].phys  = (uint32_t)dma_buf + i * IDE_PRD_MAX_BYTES;
+        prd_table[i].bytes = (uint16_t)len;     // 64KB vira 0 (= 64KB)
+        prd_table[i].flags = (i == entries - 1) ? PRD_EOT : 0;
+    }
+
+    uint8_t dir = write ? 0 : BM_CMD_READ;
+    outb(bm_base + BM_REG_COMMAND, 0);
+    outb(bm_base + BM_REG_STATUS, BM_SR_IRQ | BM_SR_ERR);
+    outl(bm_base + BM_REG_PRDT, (uint32_t)prd_table);
+    outb(bm_base + BM_REG_COMMAND, dir);
+
+    if (!ide_wait_ready()) return false;
+
+    ide_irq_done = false;
+    ide_irq_bm_status = 0;
+
+    bool lba48 = ide_needs_lba48(lba, count);
+    ide_setup_lba(lba, count, lba48);
+    if (lba48) {
+        ide_stats.lba48_cmds++;
+        outb(ATA_PRIMARY_COMMAND, write ? ATA_CMD_WRITE_DMA_EXT : ATA_CMD_READ_DMA_EXT);
+    } else {
+        outb(ATA_PRIMARY_COMMAND, write ? ATA_CMD_WRITE_DMA : ATA_CMD_READ_DMA);
+    }
+
+    // Inicia o bus-master
+    outb(bm_base + BM_REG_COMMAND, dir | BM_CMD_START);
+
+    bool ok = ide_dma_wait();
+
+    // Para o bus-master e verifica erros
+    outb(bm_base + BM_REG_COMMAND, 0);
+    if (!ok || !ide_wait_ready()) return false;
+
+    uint8_t bms = ide_irq_bm_status | inb(bm_base + BM_REG_STATUS);
+    uint8_t status = inb(ATA_PRIMARY_STATUS);
+    outb(bm_base + BM_REG_STATUS, BM_SR_IRQ | BM_SR_ERR);
+    if ((bms & BM_SR_ERR) || (status & ATA_SR_ERR)) return false;
+
+    if (!write) kmemcpy(buffer, dma_buf, bytes);
+    return true;
+}
+
+// Falha de DMA: desliga o DMA (controlador/disco não confiável) e segue em PIO
+static void ide_dma_failed(void) {
+    ide_stats.dma_errors++;
+    disk_info.dma = false;
+    outb(bm_base + BM_REG_COMMAND, 0);
+}
+
+// ============================================================
+// Backend blkdev ("hda")
+// ============================================================
+static bool ide_blk_read(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer) {
+    (void)dev;
+    return ide_read_sectors(lba, count, buffer);
+}
+
+static bool ide_blk_write(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer) {
+    (void)dev;
+    return ide_write_sectors(lba, count, buffer);
+}
+
+static bool ide_blk_flush(blkdev_t *dev) {
+    (void)dev;
+    return ide_flush();
+}
+
+static uint32_t ide_blk_size(blkdev_t *dev) {
+    (void)dev;
+    return disk_info.total_sectors;
+}
+
+static const blkdev_ops_t ide_blk_ops = {
+    ide_blk_read,
+    ide_blk_write,
+    ide_blk_flush,
+    ide_blk_size,
+};
+
+static void ide_blkdev_register(void) {
+    kmemset(&ide_blkdev, 0, sizeof(ide_blkdev));
+    kstrcpy(ide_blkdev.name, "hda", BLKDEV_NAME_LEN);
+    ide_blkdev.ops = &ide_blk_ops;
+    blkdev_register(&ide_blkdev);
+}
+
 // ============================================================
 // ide_init — Detecta disco ATA no barramento primário
 // ============================================================
 bool ide_init(void) {
     kmemset(&disk_info, 0, sizeof(disk_info));
+    kmemset(&ide_stats, 0, sizeof(ide_stats));
 
     // Seleciona drive master
     outb(ATA_PRIMARY_DRIVE_HEAD, 0xA0);
@@ -93,6 +365,14 @@ bool ide_init(void) {
     // Extrai total de setores LBA28 (words 60-61)
     disk_info.total_sectors = (uint32_t)identify[60] | ((uint32_t)identify[61] << 16);
 
+    // LBA48: word 83 bit 10; total em words 100-103 (limitado a 32 bits de LBA)
+    if (identify[83] & (1 << 10)) {
+        disk_info.lba48 = true;
+        uint32_t total48 = (uint32_t)identify[100] | ((uint32_t)identify[101] << 16);
+        if (identify[102] || identify[103]) total48 = 0xFFFFFFFF;
+        if (total48 > disk_info.total_sectors) disk_info.total_sectors = total48;
+    }
+
     // Extrai modelo (words 27-46, 20 words = 40 chars, byte-swapped)
     for (int i = 0; i < 20; i++) {
         disk_info.model[i * 2]     = (char)(identify[27 + i] >> 8);
@@ -110,6 +390,11 @@ bool ide_init(void) {
     }
 
     disk_info.present = true;
+
+    // DMA se houver controlador bus-master (senão fica em PIO)
+    disk_info.dma = ide_dma_init(identify);
+
+    ide_blkdev_register();
     return true;
 }
 
@@ -121,30 +406,29 @@ const ide_disk_info_t *ide_get_info(void) {
 }
 
 // ============================================================
-// ide_read_sectors — Lê setores do disco (PIO, LBA28)
+// ide_get_blkdev — Dispositivo de bloco do disco (NULL se ausente)
 // ============================================================
-bool ide_read_sectors(uint32_t lba, uint8_t count, void *buffer) {
-    if (!disk_info.present || !buffer || count == 0) return false;
-    if (lba + count > disk_info.total_sectors) return false;
+blkdev_t *ide_get_blkdev(void) {
+    return disk_info.present ? &ide_blkdev : NULL;
+}
 
+// ============================================================
+// ide_pio_read — Lê setores via PIO (polling de DRQ)
+// ============================================================
+static bool ide_pio_read(uint32_t lba, uint16_t count, void *buffer) {
     // Espera disco pronto
     if (!ide_wait_ready()) return false;
 
-    // Seleciona drive master + bits altos do LBA
-    outb(ATA_PRIMARY_DRIVE_HEAD, 0xE0 | ((lba >> 24) & 0x0F));
+    bool lba48 = ide_needs_lba48(lba, count);
+    ide_setup_lba(lba, count, lba48);
 
-    // Configura parâmetros
-    outb(ATA_PRIMARY_SECTOR_COUNT, count);
-    outb(ATA_PRIMARY_LBA_LO,  (uint8_t)(lba & 0xFF));
-    outb(ATA_PRIMARY_LBA_MID, (uint8_t)((lba >> 8) & 0xFF));
-    outb(ATA_PRIMARY_LBA_HI,  (uint8_t)((lba >> 16) & 0xFF));
-
-    // Envia comando READ SECTORS
-    outb(ATA_PRIMARY_COMMAND, ATA_CMD_READ_SECTORS);
+    // Envia comando READ SECTORS (EXT)
+    if (lba48) ide_stats.lba48_cmds++;
+    outb(ATA_PRIMARY_COMMAND, lba48 ? ATA_CMD_READ_SECTORS_EXT : ATA_CMD_READ_SECTORS);
 
     // Lê cada setor
     uint16_t *buf16 = (uint16_t *)buffer;
-    for (int s = 0; s < count; s++) {
+    for (uint32_t s = 0; s < count; s++) {
         // Espera DRQ
         if (!ide_wait_drq()) return false;
 
@@ -157,30 +441,22 @@ bool ide_read_sectors(uint32_t lba, uint8_t count, void *buffer) {
 }
 
 // ============================================================
-// ide_write_sectors — Escreve setores no disco (PIO, LBA28)
+// ide_pio_write — Escreve setores via PIO (polling de DRQ)
 // ============================================================
-bool ide_write_sectors(uint32_t lba, uint8_t count, const void *buffer) {
-    if (!disk_info.present || !buffer || count == 0) return false;
-    if (lba + count > disk_info.total_sectors) return false;
-
+static bool ide_pio_write(uint32_t lba, uint16_t count, const void *buffer) {
     // Espera disco pronto
     if (!ide_wait_ready()) return false;
 
-    // Seleciona drive master + bits altos do LBA
-    outb(ATA_PRIMARY_DRIVE_HEAD, 0xE0 | ((lba >> 24) & 0x0F));
-
-    // Configura parâmetros
-    outb(ATA_PRIMARY_SECTOR_COUNT, count);
-    outb(ATA_PRIMARY_LBA_LO,  (uint8_t)(lba & 0xFF));
-    outb(ATA_PRIMARY_LBA_MID, (uint8_t)((lba >> 8) & 0xFF));
-    outb(ATA_PRIMARY_LBA_HI,  (uint8_t)((lba >> 16) & 0xFF));
+    bool lba48 = ide_needs_lba48(lba, count);
+    ide_setup_lba(lba, count, lba48);
 
-    // Envia comando WRITE SECTORS
-    outb(ATA_PRIMARY_COMMAND, ATA_CMD_WRITE_SECTORS);
+    // Envia comando WRITE SECTORS (EXT)
+    if (lba48) ide_stats.lba48_cmds++;
+    outb(ATA_PRIMARY_COMMAND, lba48 ? ATA_CMD_WRITE_SECTORS_EXT : ATA_CMD_WRITE_SECTORS);
 
     // Escreve cada setor
     const uint16_t *buf16 = (const uint16_t *)buffer;
-    for (int s = 0; s < count; s++) {
+    for (uint32_t s = 0; s < count; s++) {
         // Espera DRQ
         if (!ide_wait_drq()) return false;
 
@@ -189,9 +465,83 @@ bool ide_write_sectors(uint32_t lba, uint8_t count, const void *buffer) {
         buf16 += 256;
     }
 
-    // Flush cache
-    outb(ATA_PRIMARY_COMMAND, ATA_CMD_FLUSH);
-    if (!ide_wait_ready()) return false;
+    return true;
+}
+
+// ============================================================
+// ide_transfer — Divide o pedido em comandos (DMA ou PIO)
+// ============================================================
+// Um comando cobre até 65535 setores em LBA48 (256 em LBA28); no DMA o
+// limite é o tamanho dos bounce buffers.
+static bool ide_transfer(uint32_t lba, uint16_t count, void *buffer, bool write) {
+    uint8_t *buf = (uint8_t *)buffer;
+    uint32_t done = 0;
+
+    while (done < count) {
+        uint32_t max = disk_info.lba48 ? ATA_LBA48_MAX_COUNT : ATA_LBA28_MAX_COUNT;
+        if (disk_info.dma && max > IDE_DMA_MAX_SECTORS) max = IDE_DMA_MAX_SECTORS;
+
+        uint16_t n = (uint16_t)((count - done > max) ? max : count - done);
+        uint32_t cur = lba + done;
+        uint8_t *ptr = buf + done * ATA_SECTOR_SIZE;
+
+        if (disk_info.dma) {
+            if (ide_dma_transfer(cur, n, ptr, write)) {
+                ide_stats.dma_cmds++;
+                done += n;
+            } else {
+                // Refaz o trecho em PIO (limites recalculados)
+                ide_dma_failed();
+            }
+            continue;
+        }
 
+        bool ok = write ? ide_pio_write(cur, n, ptr) : ide_pio_read(cur, n, ptr);
+        if (!ok) return false;
+        ide_stats.pio_cmds++;
+        done += n;
+    }
     return true;
 }
+
+// ============================================================
+// ide_read_sectors — Lê setores do disco (DMA ou PIO, LBA28/LBA48)
+// ============================================================
+bool ide_read_sectors(uint32_t lba, uint16_t count, void *buffer) {
+    if (!disk_info.present || !buffer || count == 0) return false;
+    if (count > disk_info.total_sectors || lba > disk_info.total_sectors - count) return false;
+
+    return ide_transfer(lba, count, buffer, false);
+}
+
+// ============================================================
+// ide_write_sectors — Escreve setores no disco (DMA ou PIO, LBA28/LBA48)
+// ============================================================
+bool ide_write_sectors(uint32_t lba, uint16_t count, const void *buffer) {
+    if (!disk_info.present || !buffer || count == 0) return false;
+    if (count > disk_info.total_sectors || lba > disk_info.total_sectors - count) return false;
+
+    return ide_transfer(lba, count, (void *)buffer, true);
+}
+
+// ============================================================
+// ide_flush — Barreira: esvazia o cache de escrita do disco
+// ============================================================
+bool ide_flush(void) {
+    if (!disk_info.present) return false;
+    if (!ide_wait_ready()) return false;
+
+    outb(ATA_PRIMARY_DRIVE_HEAD, 0xE0);
+    outb(ATA_PRIMARY_COMMAND, disk_info.lba48 ? ATA_CMD_FLUSH_EXT : ATA_CMD_FLUSH);
+    ide_stats.flushes++;
+
+    if (!ide_wait_ready()) return false;
+    return !(inb(ATA_PRIMARY_STATUS) & ATA_SR_ERR);
+}
+
+// ============================================================
+// ide_get_stats — Retorna contadores
+// ============================================================
+ide_stats_t ide_get_stats(void) {
+    return ide_stats;
+}
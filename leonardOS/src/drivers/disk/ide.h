@@ -1,14 +1,15 @@
-// LeonardOS - Driver IDE/ATA (PIO Mode)
-// Acesso a disco ATA via Programmed I/O (polling)
+// LeonardOS - Driver IDE/ATA (Bus-master DMA + PIO)
+// Acesso a disco ATA via DMA (PRD table, conclusão por IRQ14)
+// ou Programmed I/O (polling) quando não há controlador bus-master
 //
 // Suporta apenas discos ATA (PATA) no barramento primário.
-// Sem DMA, sem interrupções — polling simples.
-// API: ide_init, ide_read_sectors, ide_write_sectors
+// API: ide_init, ide_read_sectors, ide_write_sectors, ide_get_stats
 
 #ifndef __IDE_H__
 #define __IDE_H__
 
 #include "../../common/types.h"
+#include "blkdev.h"
 
 // ============================================================
 // Constantes ATA
@@ -24,6 +25,7 @@
 #define ATA_PRIMARY_DRIVE_HEAD   0x1F6
 #define ATA_PRIMARY_STATUS       0x1F7
 #define ATA_PRIMARY_COMMAND      0x1F7
+#define ATA_PRIMARY_CONTROL      0x3F6   // Device control (bit 1 = nIEN)
 
 // Status bits
 #define ATA_SR_BSY   0x80   // Busy
@@ -34,40 +36,113 @@
 // Comandos ATA
 #define ATA_CMD_READ_SECTORS  0x20
 #define ATA_CMD_WRITE_SECTORS 0x30
+#define ATA_CMD_READ_DMA      0xC8
+#define ATA_CMD_WRITE_DMA     0xCA
 #define ATA_CMD_IDENTIFY      0xEC
 #define ATA_CMD_FLUSH         0xE7
 
+// Comandos LBA48 (EXT)
+#define ATA_CMD_READ_SECTORS_EXT  0x24
+#define ATA_CMD_READ_DMA_EXT      0x25
+#define ATA_CMD_WRITE_SECTORS_EXT 0x34
+#define ATA_CMD_WRITE_DMA_EXT     0x35
+#define ATA_CMD_FLUSH_EXT         0xEA
+
 // Tamanho de setor ATA
 #define ATA_SECTOR_SIZE  512
 
+// Limites de endereçamento
+#define ATA_LBA28_MAX_SECTORS  0x10000000   // 2^28 setores (128GB)
+#define ATA_LBA28_MAX_COUNT    256          // Contagem 0 = 256
+#define ATA_LBA48_MAX_COUNT    65535        // Contagem de 16 bits
+
+// ============================================================
+// Bus-master IDE (PCI class 01h / subclass 01h, BAR4)
+// ============================================================
+
+#define IDE_PCI_CLASS        0x01    // Mass storage
+#define IDE_PCI_SUBCLASS     0x01    // IDE
+
+// Registradores do canal primário (offset a partir do BAR4)
+#define BM_REG_COMMAND       0x00
+#define BM_REG_STATUS        0x02
+#define BM_REG_PRDT          0x04
+
+#define BM_CMD_START         0x01
+#define BM_CMD_READ          0x08    // Direção: dispositivo -> memória
+
+#define BM_SR_ACTIVE         0x01
+#define BM_SR_ERR            0x02
+#define BM_SR_IRQ            0x04    // Write-1-to-clear
+
+// Entrada da PRD table: região física de até 64KB (bytes 0 = 64KB)
+#define PRD_EOT              0x8000  // Última entrada da tabela
+
+// IRQ do canal primário
+#define IRQ_IDE_PRIMARY      14
+
+// Bounce buffer: IDE_DMA_FRAMES frames contíguos do PMM, alinhados a 64KB
+// e abaixo de 16MB; cada entrada PRD cobre 64KB (nunca cruza a fronteira).
+// Pedidos maiores que IDE_DMA_MAX_SECTORS viram vários comandos DMA.
+#define IDE_DMA_FRAMES       64
+#define IDE_DMA_MAX_SECTORS  (IDE_DMA_FRAMES * 8)   // 256KB por comando
+#define IDE_PRD_MAX_BYTES    0x10000                // 64KB por entrada PRD
+
 // ============================================================
 // Info do disco detectado
 // ============================================================
 typedef struct {
     bool     present;           // Disco encontrado?
-    uint32_t total_sectors;     // Total de setores LBA28
+    bool     dma;               // Transferências via bus-master DMA?
+    bool     lba48;             // Disco suporta LBA48 (comandos EXT)?
+    uint32_t total_sectors;     // Total de setores (LBA28 ou LBA48, até 2^32)
     char     model[41];         // Modelo (string IDENTIFY)
 } ide_disk_info_t;
 
+typedef struct {
+    uint32_t dma_cmds;          // Comandos concluídos via DMA
+    uint32_t pio_cmds;          // Comandos concluídos via PIO
+    uint32_t irqs;              // IRQ14 recebidas
+    uint32_t dma_errors;        // Falhas de DMA (caem para PIO)
+    uint32_t lba48_cmds;        // Comandos emitidos em LBA48
+    uint32_t flushes;           // FLUSH CACHE enviados (barreiras)
+} ide_stats_t;
+
 // ============================================================
 // API pública
 // ============================================================
 
 // Inicializa o driver IDE — detecta disco no barramento primário
+// e habilita DMA se houver controlador bus-master no PCI
+// Deve ser chamada depois de pmm_init() (bounce buffers)
 // Retorna true se encontrou pelo menos um disco
 bool ide_init(void);
 
 // Retorna info do disco detectado
 const ide_disk_info_t *ide_get_info(void);
 
-// Lê count setores a partir de lba para buffer
+// Retorna o dispositivo de bloco "hda" (NULL se não há disco)
+blkdev_t *ide_get_blkdev(void);
+
+// Lê count setores a partir de lba para buffer (DMA se disponível, senão PIO)
+// count até 65535: um só comando LBA48 quando o disco suporta
 // buffer deve ter pelo menos count * 512 bytes
 // Retorna true se sucesso
-bool ide_read_sectors(uint32_t lba, uint8_t count, void *buffer);
+bool ide_read_sectors(uint32_t lba, uint16_t count, void *buffer);
 
-// Escreve count setores de buffer para lba
+// Escreve count setores de buffer para lba (DMA se disponível, senão PIO)
+// count até 65535: um só comando LBA48 quando o disco suporta
+// Write-back: os dados podem ficar no cache de escrita do disco até ide_flush()
 // buffer deve ter pelo menos count * 512 bytes
 // Retorna true se sucesso
-bool ide_write_sectors(uint32_t lba, uint8_t count, const void *buffer);
+bool ide_write_sectors(uint32_t lba, uint16_t count, const void *buffer);
+
+// Barreira de escrita: FLUSH CACHE (EXT) e espera o disco terminar
+// Chamada nos pontos de commit do FS (leonfs_sync) e pelo comando sync
+// Retorna true se sucesso (sem disco: false)
+bool ide_flush(void);
+
+// Retorna contadores de comandos/IRQs
+ide_stats_t ide_get_stats(void);
 
 #endif
@@ -0,0 +1,119 @@
+// LeonardOS - RAM Disk
+// Backend blkdev sobre frames do PMM (identity-mapped)
+
+#include "ramdisk.h"
+#include "../../common/string.h"
+#include "../../memory/pmm.h"
+#include "../../memory/heap.h"
+
+#define RAMDISK_SECTORS_PER_FRAME (PMM_FRAME_SIZE / BLKDEV_SECTOR_SIZE)
+
+typedef struct {
+    uint32_t *frames;       // Endereço físico de cada frame
+    uint32_t  frame_count;
+    uint32_t  sectors;
+} ramdisk_t;
+
+// ============================================================
+// Estado global
+// ============================================================
+static ramdisk_t ramdisks[RAMDISK_MAX_DEVICES];
+static blkdev_t  ramdisk_devs[RAMDISK_MAX_DEVICES];
+static int ramdisk_count = 0;
+
+// Endereço do setor lba dentro do seu frame
+static inline uint8_t *ramdisk_sector(ramdisk_t *rd, uint32_t lba) {
+    uint32_t frame = rd->frames[lba / RAMDISK_SECTORS_PER_FRAME];
+    return (uint8_t *)(frame + (lba % RAMDISK_SECTORS_PER_FRAME) * BLKDEV_SECTOR_SIZE);
+}
+
+// ============================================================
+// Operações blkdev
+// ============================================================
+
+// Copia trechos contíguos dentro de cada frame (até 8 setores por kmemcpy)
+static bool ramdisk_read(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer) {
+    ramdisk_t *rd = (ramdisk_t *)dev->priv;
+    uint8_t *dst = (uint8_t *)buffer;
+    uint32_t left = count;
+
+    while (left > 0) {
+        uint32_t n = RAMDISK_SECTORS_PER_FRAME - (lba % RAMDISK_SECTORS_PER_FRAME);
+        if (n > left) n = left;
+        kmemcpy(dst, ramdisk_sector(rd, lba), n * BLKDEV_SECTOR_SIZE);
+        dst += n * BLKDEV_SECTOR_SIZE;
+        lba += n;
+        left -= n;
+    }
+    return true;
+}
+
+static bool ramdisk_write(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer) {
+    ramdisk_t *rd = (ramdisk_t *)dev->priv;
+    const uint8_t *src = (const uint8_t *)buffer;
+    uint32_t left = count;
+
+    while (left > 0) {
+        uint32_t n = RAMDISK_SECTORS_PER_FRAME - (lba % RAMDISK_SECTORS_PER_FRAME);
+        if (n > left) n = left;
+        kmemcpy(ramdisk_sector(rd, lba), src, n * BLKDEV_SECTOR_SIZE);
+        src += n * BLKDEV_SECTOR_SIZE;
+        lba += n;
+        left -= n;
+    }
+    return true;
+}
+
+static uint32_t ramdisk_size(blkdev_t *dev) {
+    return ((ramdisk_t *)dev->priv)->sectors;
+}
+
+static const blkdev_ops_t ramdisk_ops = {
+    ramdisk_read,
+    ramdisk_write,
+    NULL,           // Nada a descarregar
+    ramdisk_size,
+};
+
+// ============================================================
+// ramdisk_create — Aloca frames e registra o dispositivo
+// ============================================================
+blkdev_t *ramdisk_create(const char *name, uint32_t sectors) {
+    if (ramdisk_count >= RAMDISK_MAX_DEVICES || sectors == 0) return NULL;
+
+    ramdisk_t *rd = &ramdisks[ramdisk_count];
+    blkdev_t *dev = &ramdisk_devs[ramdisk_count];
+
+    rd->sectors = sectors;
+    rd->frame_count = (sectors + RAMDISK_SECTORS_PER_FRAME - 1) / RAMDISK_SECTORS_PER_FRAME;
+    rd->frames = (uint32_t *)kmalloc(rd->frame_count * sizeof(uint32_t));
+    if (!rd->frames) return NULL;
+
+    for (uint32_t i = 0; i < rd->frame_count; i++) {
+        // Setores são acessados pelo endereço físico: só frames do identity map
+        rd->frames[i] = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+        if (rd->frames[i] == 0) {
+            for (uint32_t j = 0; j < i; j++) pmm_free_frame(rd->frames[j]);
+            kfree(rd->frames);
+            rd->frames = NULL;
+            return NULL;
+        }
+        kmemset((void *)rd->frames[i], 0, PMM_FRAME_SIZE);
+    }
+
+    kmemset(dev, 0, sizeof(blkdev_t));
+    kstrcpy(dev->name, name, BLKDEV_NAME_LEN);
+    dev->ops = &ramdisk_ops;
+    dev->priv = rd;
+    dev->flags = BLKDEV_F_NOCACHE;
+
+    if (!blkdev_register(dev)) {
+        for (uint32_t i = 0; i < rd->frame_count; i++) pmm_free_frame(rd->frames[i]);
+        kfree(rd->frames);
+        rd->frames = NULL;
+        return NULL;
+    }
+
+    ramdisk_count++;
+    return dev;
+}
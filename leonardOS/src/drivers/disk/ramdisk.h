@@ -0,0 +1,21 @@
+// LeonardOS - RAM Disk
+// Dispositivo de bloco em memória, sobre frames do PMM
+//
+// Os frames (abaixo de 16MB) não precisam ser contíguos: uma tabela (kmalloc) guarda o
+// endereço de cada frame de 4KB (8 setores). Sem latência de disco —
+// útil para medir o custo de CPU do LeonFS isoladamente ("test ram0").
+// API: ramdisk_create
+
+#ifndef __RAMDISK_H__
+#define __RAMDISK_H__
+
+#include "blkdev.h"
+
+#define RAMDISK_MAX_DEVICES  2
+#define RAMDISK_DEFAULT_SECTORS  8192    // 4MB
+
+// Cria e registra um RAM disk zerado com o nome e tamanho dados
+// Retorna o blkdev_t, ou NULL se faltar memória
+blkdev_t *ramdisk_create(const char *name, uint32_t sectors);
+
+#endif
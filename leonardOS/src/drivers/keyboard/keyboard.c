@@ -6,6 +6,7 @@
 #include "../pic/pic.h"
 #include "../../cpu/isr.h"
 #include "../../common/io.h"
+#include "../../memory/pmm.h"
 
 // Portas I/O PS/2
 #define KBD_DATA_PORT   0x60
@@ -202,8 +203,9 @@ void kbd_init(void) {
 // Lê um caractere do buffer (bloqueia até haver dados)
 char kbd_getchar(void) {
     while (kbd_head == kbd_tail) {
-        // Espera interrupção (CPU descansa até a próxima IRQ)
-        asm volatile("hlt");
+        // Ocioso: repõe frames zerados, senão espera interrupção
+        // (CPU descansa até a próxima IRQ)
+        if (!pmm_zero_pool_refill()) asm volatile("hlt");
     }
     
     char c = kbd_buffer[kbd_tail];
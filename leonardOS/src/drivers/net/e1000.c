@@ -0,0 +1,511 @@
+// LeonardOS - Intel e1000 Network Driver
+// Implementação do driver 82540EM (MMIO, rings de descriptors legacy)
+//
+// RX: 256 descriptors, cada um com um buffer fixo de 2KB de um bloco
+//     contíguo; o poll devolve o lote inteiro com uma escrita em RDT
+// TX: 256 descriptors; cada frame ocupa um descriptor de dados apontando
+//     para o pbuf, precedido de um descriptor de contexto quando o layout
+//     do checksum offload muda (IP/TCP/UDP)
+//
+// Referência: Intel PCI/PCI-X Family of Gigabit Ethernet Controllers
+// Software Developer's Manual (8254x), seções 3.2, 3.3 e 13
+
+#include "e1000.h"
+#include "../pci/pci.h"
+#include "../../common/io.h"
+#include "../../common/string.h"
+#include "../../cpu/isr.h"
+#include "../../cpu/softirq.h"
+#include "../../drivers/pic/pic.h"
+#include "../../drivers/timer/pit.h"
+#include "../../memory/pmm.h"
+#include "../../memory/vmm.h"
+
+// ============================================================
+// Descriptors (16 bytes; status sempre no byte 12)
+// ============================================================
+
+// RX legacy
+typedef struct {
+    uint64_t addr;
+    uint16_t length;
+    uint16_t checksum;
+    uint8_t  status;
+    uint8_t  errors;
+    uint16_t special;
+} __attribute__((packed)) e1000_rx_desc_t;
+
+#define RXD_STAT_DD      (1u << 0)   // Descriptor pronto
+#define RXD_STAT_EOP     (1u << 1)   // Fim do frame
+#define RXD_STAT_IXSM    (1u << 2)   // Placa não conferiu checksums
+#define RXD_STAT_TCPCS   (1u << 5)   // TCP/UDP conferido
+#define RXD_STAT_IPCS    (1u << 6)   // IPv4 conferido
+#define RXD_ERR_FRAME    0x97        // CE | SE | SEQ | CXE | RXE
+#define RXD_ERR_TCPE     (1u << 5)
+#define RXD_ERR_IPE      (1u << 6)
+
+// TX legacy (sem offload)
+typedef struct {
+    uint64_t addr;
+    uint16_t length;
+    uint8_t  cso;
+    uint8_t  cmd;
+    uint8_t  status;
+    uint8_t  css;
+    uint16_t special;
+} __attribute__((packed)) e1000_tx_desc_t;
+
+#define TXD_CMD_EOP      (1u << 0)
+#define TXD_CMD_IFCS     (1u << 1)   // Placa insere o CRC
+#define TXD_CMD_RS       (1u << 3)   // Reporta status (DD)
+#define TXD_STAT_DD      (1u << 0)
+#define TXD_STAT_EC      (1u << 1)   // Colisões em excesso
+#define TXD_STAT_LC      (1u << 2)   // Colisão tardia
+
+// TX de contexto: onde calcular e onde gravar cada checksum
+typedef struct {
+    uint8_t  ipcss;         // Início do header IPv4
+    uint8_t  ipcso;         // Campo de checksum IPv4
+    uint16_t ipcse;         // Último byte do header IPv4
+    uint8_t  tucss;         // Início do TCP/UDP
+    uint8_t  tucso;         // Campo de checksum TCP/UDP
+    uint16_t tucse;         // 0 = até o fim do frame
+    uint32_t cmd_len;       // TUCMD(31:24) | DTYP(23:20) | PAYLEN
+    uint8_t  status;
+    uint8_t  hdr_len;
+    uint16_t mss;
+} __attribute__((packed)) e1000_tx_ctx_desc_t;
+
+// TX de dados estendido (usa o último contexto)
+typedef struct {
+    uint64_t addr;
+    uint32_t cmd_len;       // DCMD(31:24) | DTYP(23:20) | DTALEN
+    uint8_t  status;
+    uint8_t  popts;
+    uint16_t special;
+} __attribute__((packed)) e1000_tx_data_desc_t;
+
+#define TXD_DCMD_EOP     (1u << 24)
+#define TXD_DCMD_IFCS    (1u << 25)
+#define TXD_DCMD_RS      (1u << 27)
+#define TXD_DCMD_DEXT    (1u << 29)
+#define TXD_DTYP_DATA    (1u << 20)
+#define TXD_TUCMD_TCP    (1u << 24)
+#define TXD_TUCMD_IP     (1u << 25)
+#define TXD_POPTS_IXSM   (1u << 0)   // Inserir checksum IPv4
+#define TXD_POPTS_TXSM   (1u << 1)   // Inserir checksum TCP/UDP
+
+// Offsets no frame (Ethernet sem VLAN)
+#define FRAME_IP_OFFSET  14
+#define IP_PROTO_OFFSET  (FRAME_IP_OFFSET + 9)
+#define IP_CSUM_OFFSET   (FRAME_IP_OFFSET + 10)
+#define TCP_CSUM_OFFSET  16
+
+// Escritas em descriptors (memória WB) antes da escrita MMIO no tail:
+// x86 não reordena stores, basta o compilador não reordenar
+#define e1000_wmb()  asm volatile("" ::: "memory")
+
+// ============================================================
+// Estado do driver (tudo estático)
+// ============================================================
+static bool     nic_present = false;
+static uint32_t mmio_base = 0;
+static uint8_t  irq_line = 0;
+static netdev_t netdev;
+
+// RX
+static volatile e1000_rx_desc_t *rx_ring = NULL;
+static uint8_t  *rx_bufs = NULL;
+static uint16_t  rx_cur = 0;            // Próximo descriptor a consumir
+
+// TX
+static volatile e1000_tx_desc_t *tx_ring = NULL;
+static pbuf_t   *tx_pbufs[E1000_NUM_TX_DESC];  // NULL em descriptors de contexto
+static uint16_t  tx_head = 0;           // Próximo descriptor a preencher (TDT)
+static uint16_t  tx_tail = 0;           // Mais antigo ainda com a placa
+static uint32_t  tx_ctx_key = 0;        // Layout do último contexto (0 = nenhum)
+
+// ============================================================
+// Acesso aos registradores
+// ============================================================
+static inline uint32_t e1000_read(uint32_t reg) {
+    return *(volatile uint32_t *)(mmio_base + reg);
+}
+
+static inline void e1000_write(uint32_t reg, uint32_t value) {
+    *(volatile uint32_t *)(mmio_base + reg) = value;
+}
+
+// ============================================================
+// e1000_eeprom_read — lê uma word da EEPROM via EERD
+// ============================================================
+static bool e1000_eeprom_read(uint8_t addr, uint16_t *out) {
+    e1000_write(E1000_REG_EERD, ((uint32_t)addr << 8) | E1000_EERD_START);
+    for (int i = 0; i < 100000; i++) {
+        uint32_t v = e1000_read(E1000_REG_EERD);
+        if (v & E1000_EERD_DONE) {
+            *out = (uint16_t)(v >> 16);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================
+// tx_free_desc — descriptors de TX livres (um fica vazio: head == tail)
+// ============================================================
+static inline uint16_t tx_free_desc(void) {
+    uint16_t used = (uint16_t)((tx_head - tx_tail + E1000_NUM_TX_DESC) % E1000_NUM_TX_DESC);
+    return (uint16_t)(E1000_NUM_TX_DESC - 1 - used);
+}
+
+// ============================================================
+// tx_reclaim — solta os pbufs cujos descriptors a placa concluiu
+// Chamar com interrupções desabilitadas
+// ============================================================
+static void tx_reclaim(void) {
+    while (tx_tail != tx_head) {
+        volatile e1000_tx_desc_t *d = &tx_ring[tx_tail];
+        if (!(d->status & TXD_STAT_DD)) break;
+
+        pbuf_t *p = tx_pbufs[tx_tail];
+        if (p) {
+            if (d->status & (TXD_STAT_EC | TXD_STAT_LC)) {
+                netdev.stats.tx_errors++;
+            } else {
+                netdev.stats.tx_packets++;
+                netdev.stats.tx_bytes += p->len;
+            }
+            pbuf_free(p);
+            tx_pbufs[tx_tail] = NULL;
+            netdev.stats.tx_queue_depth--;
+        }
+        d->status = 0;
+        tx_tail = (uint16_t)((tx_tail + 1) % E1000_NUM_TX_DESC);
+    }
+}
+
+// ============================================================
+// tx_csum_key — layout de offload pedido pelo pbuf
+// Codifica popts | tucss << 8 | tucso << 16 | ipcse << 24
+// (0 = sem offload: descriptor legacy)
+// ============================================================
+static uint32_t tx_csum_key(const pbuf_t *p) {
+    if (!(p->flags & (PBUF_F_CSUM_IP | PBUF_F_CSUM_L4))) return 0;
+    if (p->len < FRAME_IP_OFFSET + 20) return 0;
+
+    const uint8_t *frame = p->payload;
+    uint32_t ihl = (uint32_t)(frame[FRAME_IP_OFFSET] & 0x0F) * 4;
+    uint32_t tucss = FRAME_IP_OFFSET + ihl;
+    uint32_t popts = 0;
+    uint32_t tucso = 0;
+
+    if (p->flags & PBUF_F_CSUM_IP) popts |= TXD_POPTS_IXSM;
+    if (p->flags & PBUF_F_CSUM_L4) {
+        // Só TCP: a placa não troca uma soma UDP 0x0000 por 0xFFFF
+        if (frame[IP_PROTO_OFFSET] == 6) {
+            tucso = tucss + TCP_CSUM_OFFSET;
+            popts |= TXD_POPTS_TXSM;
+        }
+    }
+    if (!popts) return 0;
+
+    return popts | (tucss << 8) | (tucso << 16) | ((tucss - 1) << 24);
+}
+
+// ============================================================
+// tx_write_ctx — descriptor de contexto para o layout key
+// ============================================================
+static void tx_write_ctx(uint32_t key, uint8_t proto) {
+    volatile e1000_tx_ctx_desc_t *c = (volatile e1000_tx_ctx_desc_t *)&tx_ring[tx_head];
+    uint32_t tucmd = TXD_DCMD_DEXT | TXD_DCMD_RS | TXD_TUCMD_IP;
+    if (proto == 6) tucmd |= TXD_TUCMD_TCP;
+
+    c->ipcss   = FRAME_IP_OFFSET;
+    c->ipcso   = IP_CSUM_OFFSET;
+    c->ipcse   = (uint16_t)(key >> 24);
+    c->tucss   = (uint8_t)(key >> 8);
+    c->tucso   = (uint8_t)(key >> 16);
+    c->tucse   = 0;
+    c->cmd_len = tucmd;
+    c->status  = 0;
+    c->hdr_len = 0;
+    c->mss     = 0;
+
+    tx_pbufs[tx_head] = NULL;
+    tx_head = (uint16_t)((tx_head + 1) % E1000_NUM_TX_DESC);
+    tx_ctx_key = key;
+}
+
+// ============================================================
+// e1000_irq_handler — TX volta aqui; RX só agenda o poll
+// ============================================================
+static void e1000_irq_handler(struct isr_frame *frame) {
+    (void)frame;
+
+    // Leitura do ICR reconhece todas as causas
+    uint32_t icr = e1000_read(E1000_REG_ICR);
+
+    if (icr & E1000_INT_TXDW) {
+        tx_reclaim();
+    }
+
+    if (icr & E1000_INT_RXO) {
+        netdev.stats.rx_errors++;
+    }
+
+    if (icr & E1000_INT_RX_MASK) {
+        // Mascara RX até o poll esvaziar o ring e agenda o bottom half
+        e1000_write(E1000_REG_IMC, E1000_INT_RX_MASK);
+        softirq_raise(SOFTIRQ_NET_RX);
+    }
+}
+
+// ============================================================
+// e1000_poll — drena até budget frames do ring de RX (ops->poll)
+// Buffers voltam à placa com uma única escrita em RDT por lote
+// ============================================================
+static int e1000_poll(netdev_t *dev, int budget) {
+    (void)dev;
+    if (!nic_present) return 0;
+    netdev.stats.rx_polls++;
+
+    int done = 0;
+    int last = -1;
+    while (done < budget) {
+        volatile e1000_rx_desc_t *d = &rx_ring[rx_cur];
+        uint8_t status = d->status;
+        if (!(status & RXD_STAT_DD)) break;
+
+        uint8_t errors = d->errors;
+        uint16_t len = d->length;
+        if ((status & RXD_STAT_EOP) && !(errors & RXD_ERR_FRAME) &&
+            len > 0 && len <= E1000_RX_BUF_SIZE) {
+            // Checksums que a placa conferiu (IXSM = não conferiu nada)
+            uint32_t csum = 0;
+            if (!(status & RXD_STAT_IXSM)) {
+                if ((status & RXD_STAT_IPCS) && !(errors & RXD_ERR_IPE)) {
+                    csum |= NETDEV_RX_CSUM_IP;
+                }
+                if ((status & RXD_STAT_TCPCS) && !(errors & RXD_ERR_TCPE)) {
+                    csum |= NETDEV_RX_CSUM_L4;
+                }
+            }
+            netdev_rx(&netdev, rx_bufs + (uint32_t)rx_cur * E1000_RX_BUF_SIZE, len, csum);
+        } else {
+            netdev.stats.rx_errors++;
+        }
+
+        d->status = 0;
+        last = rx_cur;
+        rx_cur = (uint16_t)((rx_cur + 1) % E1000_NUM_RX_DESC);
+        done++;
+    }
+
+    if (last >= 0) {
+        // RDT aponta para o último devolvido: a placa usa até RDT - 1
+        e1000_wmb();
+        e1000_write(E1000_REG_RDT, (uint32_t)last);
+    }
+
+    if (done < budget) {
+        // Ring vazio: religa RX (causa que chegou no meio fica no ICR e dispara)
+        e1000_write(E1000_REG_IMS, E1000_INT_RX_MASK);
+    } else {
+        netdev.stats.rx_budget_hits++;
+    }
+    return done;
+}
+
+// ============================================================
+// e1000_send — coloca o pbuf no ring de TX (ops->send, consome a referência)
+// ============================================================
+static bool e1000_send(netdev_t *dev, pbuf_t *p) {
+    (void)dev;
+    if (!nic_present || !p || p->len == 0 || p->len > E1000_RX_BUF_SIZE) {
+        pbuf_free(p);
+        return false;
+    }
+
+    uint32_t key = tx_csum_key(p);
+    uint8_t proto = key ? p->payload[IP_PROTO_OFFSET] : 0;
+
+    // Ring compartilhado entre a shell, o softirq NET_RX (ACKs) e o IRQ de TX
+    uint32_t flags = irq_save();
+    tx_reclaim();
+
+    // Backpressure: ring cheio espera o IRQ de TX liberar descriptors
+    // (só se quem chamou estava com IF=1; senão o IRQ nunca viria)
+    uint16_t need = (key && key != tx_ctx_key) ? 2 : 1;
+    if (tx_free_desc() < need) {
+        netdev.stats.tx_stalls++;
+        uint32_t start = pit_get_ms();
+        while (tx_free_desc() < need) {
+            if (!(flags & 0x200) || pit_get_ms() - start >= E1000_TX_TIMEOUT_MS) {
+                netdev.stats.tx_drops++;
+                irq_restore(flags);
+                pbuf_free(p);
+                return false;
+            }
+            asm volatile("sti; hlt; cli" ::: "memory");
+            tx_reclaim();
+        }
+    }
+
+    if (key) {
+        if (key != tx_ctx_key) tx_write_ctx(key, proto);
+
+        volatile e1000_tx_data_desc_t *d = (volatile e1000_tx_data_desc_t *)&tx_ring[tx_head];
+        d->addr    = (uint32_t)p->payload;
+        d->cmd_len = TXD_DCMD_EOP | TXD_DCMD_IFCS | TXD_DCMD_RS | TXD_DCMD_DEXT |
+                     TXD_DTYP_DATA | p->len;
+        d->status  = 0;
+        d->popts   = (uint8_t)key;
+        d->special = 0;
+        netdev.stats.tx_csum_offload++;
+    } else {
+        volatile e1000_tx_desc_t *d = &tx_ring[tx_head];
+        d->addr    = (uint32_t)p->payload;
+        d->length  = p->len;
+        d->cso     = 0;
+        d->cmd     = TXD_CMD_EOP | TXD_CMD_IFCS | TXD_CMD_RS;
+        d->status  = 0;
+        d->css     = 0;
+        d->special = 0;
+    }
+    tx_pbufs[tx_head] = p;
+    tx_head = (uint16_t)((tx_head + 1) % E1000_NUM_TX_DESC);
+
+    netdev.stats.tx_queue_depth++;
+    if (netdev.stats.tx_queue_depth > netdev.stats.tx_queue_max) {
+        netdev.stats.tx_queue_max = netdev.stats.tx_queue_depth;
+    }
+
+    e1000_wmb();
+    e1000_write(E1000_REG_TDT, tx_head);
+    netdev.stats.tx_kicks++;
+
+    irq_restore(flags);
+    return true;
+}
+
+static const netdev_ops_t e1000_ops = {
+    .send = e1000_send,
+    .poll = e1000_poll,
+};
+
+// ============================================================
+// e1000_init — inicializa a NIC
+// ============================================================
+bool e1000_init(void) {
+    // 1. Busca o device no PCI (BAR0 precisa ser memória)
+    pci_device_t dev;
+    if (!pci_find_device(E1000_VENDOR_ID, E1000_DEVICE_ID, &dev)) {
+        return false;
+    }
+    if (dev.bar0 & 0x1) return false;
+
+    mmio_base = dev.bar0 & ~0xFu;
+    irq_line  = dev.irq_line;
+
+    uint16_t cmd = pci_config_read16(dev.bus, dev.slot, dev.func, PCI_REG_COMMAND);
+    pci_config_write16(dev.bus, dev.slot, dev.func, PCI_REG_COMMAND, cmd | PCI_CMD_MEMORY);
+    pci_enable_bus_mastering(&dev);
+
+    // 2. Mapeia os registradores (BAR fica fora do identity map de 16MB)
+    if (mmio_base >= PAGING_IDENTITY_MAP_MB * 1024 * 1024) {
+        for (uint32_t off = 0; off < E1000_MMIO_SIZE; off += PAGE_SIZE) {
+            map_page(mmio_base + off, mmio_base + off, PAGE_KERNEL | PAGE_NOCACHE | PAGE_WT);
+        }
+        if (!is_page_mapped(mmio_base + E1000_MMIO_SIZE - PAGE_SIZE)) return false;
+    }
+
+    // 3. Reset + interrupções desligadas
+    e1000_write(E1000_REG_IMC, 0xFFFFFFFF);
+    e1000_write(E1000_REG_CTRL, e1000_read(E1000_REG_CTRL) | E1000_CTRL_RST);
+    for (int i = 0; i < 100000 && (e1000_read(E1000_REG_CTRL) & E1000_CTRL_RST); i++) {
+        io_wait();
+    }
+    e1000_write(E1000_REG_IMC, 0xFFFFFFFF);
+    (void)e1000_read(E1000_REG_ICR);
+    e1000_write(E1000_REG_CTRL, e1000_read(E1000_REG_CTRL) | E1000_CTRL_SLU);
+
+    // 4. MAC: RAL/RAH (carregado da EEPROM no reset), senão EEPROM direto
+    static const uint8_t fallback_mac[ETH_ALEN] = {0x52, 0x54, 0x00, 0x12, 0x34, 0x58};
+    uint32_t ral = e1000_read(E1000_REG_RAL0);
+    uint32_t rah = e1000_read(E1000_REG_RAH0);
+    uint16_t w0, w1, w2;
+    if (rah & E1000_RAH_AV) {
+        for (int i = 0; i < 4; i++) netdev.mac[i] = (uint8_t)(ral >> (i * 8));
+        netdev.mac[4] = (uint8_t)rah;
+        netdev.mac[5] = (uint8_t)(rah >> 8);
+    } else if (e1000_eeprom_read(0, &w0) && e1000_eeprom_read(1, &w1) &&
+               e1000_eeprom_read(2, &w2)) {
+        netdev.mac[0] = (uint8_t)w0; netdev.mac[1] = (uint8_t)(w0 >> 8);
+        netdev.mac[2] = (uint8_t)w1; netdev.mac[3] = (uint8_t)(w1 >> 8);
+        netdev.mac[4] = (uint8_t)w2; netdev.mac[5] = (uint8_t)(w2 >> 8);
+    } else {
+        kmemcpy(netdev.mac, fallback_mac, ETH_ALEN);
+    }
+    e1000_write(E1000_REG_RAL0, netdev.mac[0] | (netdev.mac[1] << 8) |
+                                (netdev.mac[2] << 16) | ((uint32_t)netdev.mac[3] << 24));
+    e1000_write(E1000_REG_RAH0, netdev.mac[4] | (netdev.mac[5] << 8) | E1000_RAH_AV);
+    for (int i = 0; i < 128; i++) e1000_write(E1000_REG_MTA + i * 4, 0);
+
+    // 5. Rings (1 frame cada) + buffers de RX (contíguos, 512KB)
+    uint32_t rx_ring_phys = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    uint32_t tx_ring_phys = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    uint32_t rx_buf_frames = (E1000_NUM_RX_DESC * E1000_RX_BUF_SIZE) / PMM_FRAME_SIZE;
+    uint32_t rx_buf_phys = pmm_alloc_contiguous(rx_buf_frames, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (!rx_ring_phys || !tx_ring_phys || !rx_buf_phys) return false;
+
+    rx_ring = (volatile e1000_rx_desc_t *)rx_ring_phys;
+    tx_ring = (volatile e1000_tx_desc_t *)tx_ring_phys;
+    rx_bufs = (uint8_t *)rx_buf_phys;
+    kmemset((void *)rx_ring_phys, 0, PMM_FRAME_SIZE);
+    kmemset((void *)tx_ring_phys, 0, PMM_FRAME_SIZE);
+
+    // 6. RX: todos os buffers com a placa, checksum offload, CRC removido
+    for (int i = 0; i < E1000_NUM_RX_DESC; i++) {
+        rx_ring[i].addr = rx_buf_phys + (uint32_t)i * E1000_RX_BUF_SIZE;
+    }
+    rx_cur = 0;
+    e1000_write(E1000_REG_RDBAL, rx_ring_phys);
+    e1000_write(E1000_REG_RDBAH, 0);
+    e1000_write(E1000_REG_RDLEN, E1000_NUM_RX_DESC * sizeof(e1000_rx_desc_t));
+    e1000_write(E1000_REG_RDH, 0);
+    e1000_write(E1000_REG_RDT, E1000_NUM_RX_DESC - 1);
+    e1000_write(E1000_REG_RDTR, 0);
+    e1000_write(E1000_REG_RXCSUM, E1000_RXCSUM_IPOFL | E1000_RXCSUM_TUOFL);
+    e1000_write(E1000_REG_RCTL, E1000_RCTL_EN | E1000_RCTL_BAM |
+                                E1000_RCTL_BSIZE_2048 | E1000_RCTL_SECRC);
+
+    // 7. TX
+    for (int i = 0; i < E1000_NUM_TX_DESC; i++) tx_pbufs[i] = NULL;
+    tx_head = 0;
+    tx_tail = 0;
+    tx_ctx_key = 0;
+    e1000_write(E1000_REG_TDBAL, tx_ring_phys);
+    e1000_write(E1000_REG_TDBAH, 0);
+    e1000_write(E1000_REG_TDLEN, E1000_NUM_TX_DESC * sizeof(e1000_tx_desc_t));
+    e1000_write(E1000_REG_TDH, 0);
+    e1000_write(E1000_REG_TDT, 0);
+    e1000_write(E1000_REG_TIPG, E1000_TIPG_DEFAULT);
+    e1000_write(E1000_REG_TCTL, E1000_TCTL_EN | E1000_TCTL_PSP |
+                                E1000_TCTL_CT | E1000_TCTL_COLD);
+
+    // 8. Interrupt throttling: no máximo uma IRQ a cada ITR x 256ns
+    e1000_write(E1000_REG_ITR, E1000_ITR_INTERVAL);
+
+    // 9. Registra como eth0 (com checksum offload) e liga a IRQ
+    netdev.driver = "e1000";
+    netdev.ops = &e1000_ops;
+    netdev.features = NETDEV_F_TX_CSUM | NETDEV_F_RX_CSUM;
+    if (!netdev_register(&netdev)) return false;
+    nic_present = true;
+
+    isr_register_handler(IRQ_TO_INT(irq_line), e1000_irq_handler);
+    pic_unmask_irq(irq_line);
+    e1000_write(E1000_REG_IMS, E1000_INT_RX_MASK | E1000_INT_TXDW);
+    return true;
+}
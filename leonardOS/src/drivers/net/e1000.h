@@ -0,0 +1,112 @@
+// LeonardOS - Intel e1000 Network Driver
+// Driver para Intel 82540EM (placa padrão do QEMU, PCI, MMIO)
+//
+// Rings de 256 descriptors para RX e TX em frames do PMM abaixo de 16MB.
+// RX: buffers de 2KB fixos, drenados pelo softirq NET_RX; TX faz DMA
+// direto do pbuf. ITR limita a taxa de interrupções, e a placa calcula
+// (TX: IPv4/TCP) e confere (RX: IPv4/TCP/UDP) os checksums.
+// Cada frame em voo segura um pbuf: o TX fica limitado a PBUF_POOL_SIZE
+// frames (E1000_TX_MAX_FRAMES), não aos 256 descriptors do ring.
+
+#ifndef __E1000_H__
+#define __E1000_H__
+
+#include "../../common/types.h"
+#include "netdev.h"
+#include "../../net/pbuf.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+// PCI
+#define E1000_VENDOR_ID        0x8086
+#define E1000_DEVICE_ID        0x100E  // 82540EM
+#define E1000_MMIO_SIZE        0x20000 // BAR0: 128KB de registradores
+
+// Registradores (offset a partir do BAR0)
+#define E1000_REG_CTRL         0x0000
+#define E1000_REG_STATUS       0x0008
+#define E1000_REG_EERD         0x0014  // Leitura da EEPROM
+#define E1000_REG_ICR          0x00C0  // Causas (leitura limpa)
+#define E1000_REG_ITR          0x00C4  // Intervalo mínimo entre interrupções
+#define E1000_REG_IMS          0x00D0  // Habilita causas
+#define E1000_REG_IMC          0x00D8  // Desabilita causas
+#define E1000_REG_RCTL         0x0100
+#define E1000_REG_TCTL         0x0400
+#define E1000_REG_TIPG         0x0410
+#define E1000_REG_RDBAL        0x2800
+#define E1000_REG_RDBAH        0x2804
+#define E1000_REG_RDLEN        0x2808
+#define E1000_REG_RDH          0x2810
+#define E1000_REG_RDT          0x2818
+#define E1000_REG_RDTR         0x2820
+#define E1000_REG_TDBAL        0x3800
+#define E1000_REG_TDBAH        0x3804
+#define E1000_REG_TDLEN        0x3808
+#define E1000_REG_TDH          0x3810
+#define E1000_REG_TDT          0x3818
+#define E1000_REG_RXCSUM       0x5000
+#define E1000_REG_MTA          0x5200  // Multicast table (128 x 32-bit)
+#define E1000_REG_RAL0         0x5400
+#define E1000_REG_RAH0         0x5404
+
+// CTRL
+#define E1000_CTRL_SLU         (1u << 6)   // Set link up
+#define E1000_CTRL_RST         (1u << 26)
+
+// EERD
+#define E1000_EERD_START       (1u << 0)
+#define E1000_EERD_DONE        (1u << 4)
+
+// Causas de interrupção (ICR/IMS/IMC)
+#define E1000_INT_TXDW         (1u << 0)   // Descriptor de TX escrito de volta
+#define E1000_INT_LSC          (1u << 2)   // Mudança de link
+#define E1000_INT_RXDMT0       (1u << 4)   // Poucos descriptors de RX livres
+#define E1000_INT_RXO          (1u << 6)   // Overrun de RX
+#define E1000_INT_RXT0         (1u << 7)   // Frame recebido (timer)
+#define E1000_INT_RX_MASK      (E1000_INT_RXDMT0 | E1000_INT_RXO | E1000_INT_RXT0)
+
+// RCTL
+#define E1000_RCTL_EN          (1u << 1)
+#define E1000_RCTL_BAM         (1u << 15)  // Aceita broadcast
+#define E1000_RCTL_BSIZE_2048  (0u << 16)
+#define E1000_RCTL_SECRC       (1u << 26)  // Remove o CRC do frame
+
+// TCTL
+#define E1000_TCTL_EN          (1u << 1)
+#define E1000_TCTL_PSP         (1u << 3)   // Pad short packets
+#define E1000_TCTL_CT          (0x0Fu << 4)
+#define E1000_TCTL_COLD        (0x40u << 12)
+#define E1000_TIPG_DEFAULT     0x0060200A
+
+// RXCSUM
+#define E1000_RXCSUM_IPOFL     (1u << 8)   // Confere header IPv4
+#define E1000_RXCSUM_TUOFL     (1u << 9)   // Confere TCP/UDP
+
+// RAH
+#define E1000_RAH_AV           (1u << 31)  // Endereço válido
+
+// Limites do driver
+#define E1000_NUM_RX_DESC      256
+#define E1000_NUM_TX_DESC      256
+#define E1000_RX_BUF_SIZE      2048
+#define E1000_TX_TIMEOUT_MS    100     // Espera máxima por descriptor de TX livre
+
+// Frames de TX em voo: o ring comportaria 255, mas cada um segura um pbuf
+// do pool (contexto + dados: até 2 * PBUF_POOL_SIZE descriptors ocupados)
+#define E1000_TX_MAX_FRAMES    PBUF_POOL_SIZE
+
+// ITR em unidades de 256ns: 488 ~= 8000 interrupções/s no máximo
+#define E1000_ITR_INTERVAL     488
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Procura o 82540EM no PCI, mapeia os registradores, monta os rings,
+// liga o offload de checksum e registra a placa como eth0 na camada netdev
+// Retorna true se a NIC foi encontrada e inicializada
+bool e1000_init(void);
+
+#endif
@@ -0,0 +1,53 @@
+// LeonardOS - Network Device Layer
+// Registro da interface eth0 e entrega de frames recebidos
+
+#include "netdev.h"
+#include "../../common/string.h"
+
+static netdev_t            *active = NULL;
+static netdev_rx_callback_t rx_callback = NULL;
+static uint32_t             rx_csum = 0;     // Do frame em entrega (softirq NET_RX)
+
+// ============================================================
+// netdev_register — registra a placa como eth0
+// ============================================================
+bool netdev_register(netdev_t *dev) {
+    if (!dev || !dev->ops || !dev->ops->send || !dev->ops->poll) return false;
+    if (active) return false;
+
+    kstrcpy(dev->name, "eth0", NETDEV_NAME_LEN);
+    kmemset(&dev->stats, 0, sizeof(dev->stats));
+    active = dev;
+    return true;
+}
+
+netdev_t *netdev_get(void) {
+    return active;
+}
+
+void netdev_set_rx_callback(netdev_rx_callback_t cb) {
+    rx_callback = cb;
+}
+
+// ============================================================
+// netdev_rx — entrega um frame à camada Ethernet
+// ============================================================
+void netdev_rx(netdev_t *dev, const void *data, uint16_t len, uint32_t csum) {
+    dev->stats.rx_packets++;
+    dev->stats.rx_bytes += len;
+    if (csum) dev->stats.rx_csum_ok++;
+    if (rx_callback) {
+        // Vale só durante o callback: IPv4/TCP/UDP consultam via netdev_rx_csum()
+        rx_csum = csum;
+        rx_callback(data, len);
+        rx_csum = 0;
+    }
+}
+
+uint32_t netdev_rx_csum(void) {
+    return rx_csum;
+}
+
+bool netdev_tx_csum(void) {
+    return active && (active->features & NETDEV_F_TX_CSUM);
+}
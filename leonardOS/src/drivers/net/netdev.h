@@ -0,0 +1,110 @@
+// LeonardOS - Network Device Layer
+// Interface genérica de placas de rede (frames Ethernet)
+//
+// Cada driver (RTL8139, virtio-net, e1000) preenche um netdev_ops_t e registra
+// o dispositivo com netdev_register() no seu *_init. A camada Ethernet
+// fala só com netdev_t: envia com ops->send e, no softirq NET_RX, drena a
+// placa com ops->poll, que entrega cada frame via netdev_rx().
+// Há uma única interface (eth0): a primeira placa registrada.
+//
+// Checksum offload: com NETDEV_F_TX_CSUM a pilha deixa os checksums para a
+// placa (pbuf->flags); com NETDEV_F_RX_CSUM o driver informa em netdev_rx()
+// o que a placa já conferiu e IPv4/TCP/UDP pulam a verificação em software.
+// API: netdev_register, netdev_get, netdev_set_rx_callback, netdev_rx,
+//      netdev_rx_csum, netdev_tx_csum
+
+#ifndef __NETDEV_H__
+#define __NETDEV_H__
+
+#include "../../common/types.h"
+#include "../../net/pbuf.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+#define NETDEV_NAME_LEN   16
+#ifndef ETH_ALEN
+#define ETH_ALEN          6       // Tamanho de endereço MAC
+#endif
+
+// Features (netdev_t.features)
+#define NETDEV_F_TX_CSUM  (1u << 0)   // Placa calcula checksums IPv4/TCP no TX (UDP: software)
+#define NETDEV_F_RX_CSUM  (1u << 1)   // Placa confere checksums na recepção
+
+// Checksums conferidos pela placa no frame recebido (netdev_rx)
+#define NETDEV_RX_CSUM_IP (1u << 0)   // Header IPv4 válido
+#define NETDEV_RX_CSUM_L4 (1u << 1)   // TCP/UDP válido
+
+// ============================================================
+// Estruturas
+// ============================================================
+
+typedef struct netdev netdev_t;
+
+// Estatísticas da NIC (campos que o driver não usa ficam em 0)
+typedef struct {
+    uint32_t tx_packets;
+    uint32_t rx_packets;
+    uint32_t tx_bytes;
+    uint32_t rx_bytes;
+    uint32_t tx_errors;
+    uint32_t rx_errors;
+    uint32_t rx_polls;          // Chamadas de ops->poll
+    uint32_t rx_budget_hits;    // Polls que esgotaram o budget (ring ainda cheio)
+    uint32_t tx_realigned;      // Frames movidos para alinhar o DMA a 4 bytes
+    uint32_t tx_queue_depth;    // Frames esperando/na NIC agora
+    uint32_t tx_queue_max;      // Maior profundidade vista
+    uint32_t tx_stalls;         // Envios que esperaram espaço para TX
+    uint32_t tx_drops;          // Envios descartados (sem espaço após timeout)
+    uint32_t tx_kicks;          // Notificações de TX enviadas à NIC
+    uint32_t tx_csum_offload;   // Frames com checksum calculado pela NIC
+    uint32_t rx_csum_ok;        // Frames com checksum conferido pela NIC
+} nic_stats_t;
+
+// Operações implementadas pelo driver
+typedef struct {
+    // Envia um frame completo (p->payload, p->len); consome a referência
+    bool (*send)(netdev_t *dev, pbuf_t *p);
+    // Drena até budget frames recebidos (netdev_rx para cada um)
+    // Retorna frames processados; == budget significa que pode haver mais
+    int  (*poll)(netdev_t *dev, int budget);
+} netdev_ops_t;
+
+struct netdev {
+    char                name[NETDEV_NAME_LEN];  // "eth0"
+    const char         *driver;                 // "RTL8139", "virtio-net", "e1000"
+    uint8_t             mac[ETH_ALEN];
+    uint32_t            features;               // NETDEV_F_*
+    const netdev_ops_t *ops;
+    nic_stats_t         stats;
+};
+
+// Callback para frames recebidos (camada Ethernet)
+typedef void (*netdev_rx_callback_t)(const void *data, uint16_t len);
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Registra a placa como eth0. Retorna false se já há uma interface
+// ou se o driver não preencheu send/poll
+bool netdev_register(netdev_t *dev);
+
+// Interface ativa (NULL se nenhuma placa foi encontrada)
+netdev_t *netdev_get(void);
+
+// Registra quem recebe os frames (chamado por eth_init)
+void netdev_set_rx_callback(netdev_rx_callback_t cb);
+
+// Entrega um frame recebido à camada de cima (chamado pelo poll do driver)
+// csum: NETDEV_RX_CSUM_* que a placa conferiu (0 = nada, software confere)
+void netdev_rx(netdev_t *dev, const void *data, uint16_t len, uint32_t csum);
+
+// NETDEV_RX_CSUM_* do frame sendo entregue agora (0 fora de netdev_rx)
+uint32_t netdev_rx_csum(void);
+
+// true se a interface ativa calcula os checksums de TX
+bool netdev_tx_csum(void);
+
+#endif
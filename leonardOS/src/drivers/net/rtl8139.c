@@ -2,9 +2,9 @@
 // Implementação do driver Realtek RTL8139
 //
 // O RTL8139 é uma NIC PCI simples que opera via I/O ports:
-//   - 4 TX descriptors (round-robin)
+//   - 4 TX descriptors (anel com posse via TSD, fila de software atrás, DMA direto do pbuf)
 //   - 1 RX ring buffer contínuo (8KB + 16 + 1500 wrap)
-//   - IRQ para TX ok, RX ok, erros
+//   - IRQ para TX ok, RX ok, erros (RX drenado por rtl8139_poll no softirq)
 //
 // Referência: RTL8139 Programming Guide + OSDev wiki
 
@@ -14,7 +14,9 @@
 #include "../../common/string.h"
 #include "../../common/types.h"
 #include "../../cpu/isr.h"
+#include "../../cpu/softirq.h"
 #include "../../drivers/pic/pic.h"
+#include "../../drivers/timer/pit.h"
 #include "../../drivers/vga/vga.h"
 #include "../../common/colors.h"
 #include "../../memory/pmm.h"
@@ -69,12 +71,15 @@
 // Número de PMM frames para RX buffer (67052 bytes → 17 frames)
 #define RX_BUF_FRAMES   17
 
-// TX buffer size por descriptor
-#define TX_BUF_SIZE     RTL8139_BUF_SIZE
-
 // Número de TX descriptors
 #define TX_DESC_COUNT   4
 
+// TX status (TSD0-3)
+#define TSD_OWN         (1 << 13)   // DMA para a FIFO concluído
+#define TSD_TUN         (1 << 14)   // FIFO underrun
+#define TSD_TOK         (1 << 15)   // Transmit OK
+#define TSD_TABT        (1u << 30)  // Transmit abort
+
 // RX packet header (no início de cada pacote no ring)
 typedef struct {
     uint16_t status;    // bits: ROK, FAE, CRC, etc.
@@ -88,28 +93,97 @@ typedef struct {
 // ============================================================
 static bool          nic_present = false;
 static uint16_t      io_base = 0;           // I/O port base
-static uint8_t       mac_addr[ETH_ALEN];    // MAC address
 static uint8_t       irq_line = 0;          // IRQ number
-static nic_stats_t   stats;
+static netdev_t      netdev;                // eth0 quando esta placa é a ativa
 
 // RX buffer — RX_BUF_FRAMES frames PMM contíguos (68KB)
 // Dentro do identity map, phys == virt
 static uint8_t *rx_buffer = NULL;
 static uint32_t rx_offset = 0;  // Offset de leitura atual no ring (32-bit para 64K)
 
-// TX buffers — 4 descriptors, buffers estáticos
-// Alinhados a 4 bytes (uint32_t cast é seguro)
-static uint8_t  tx_buffers[TX_DESC_COUNT][TX_BUF_SIZE] __attribute__((aligned(4)));
-static uint8_t  tx_current = 0;  // Próximo descriptor a usar
-
-// Callback de recepção
-static rtl8139_rx_callback_t rx_callback = NULL;
+// TX — 4 descriptors em anel; cada um segura o pbuf que a NIC está lendo
+// (DMA direto do payload) até o TSD reportar TOK/TABT. Atrás deles, uma
+// fila de software (lista por pbuf->next) que o IRQ de TX OK esvazia
+static pbuf_t  *tx_pbufs[TX_DESC_COUNT];
+static uint8_t  tx_head = 0;        // Descriptor mais antigo em voo
+static uint8_t  tx_tail = 0;        // Próximo descriptor a preencher
+static uint8_t  tx_inflight = 0;    // Descriptors com a NIC
+static pbuf_t  *txq_first = NULL;   // Fila de software (FIFO)
+static pbuf_t  *txq_last = NULL;
 
 // Tamanho real do ring buffer do hardware (64K para bits 11:13=11)
 #define RX_RING_SIZE    65536
 
+// Interrupções de RX: mascaradas enquanto o poll drena o ring
+#define INT_RX_MASK     (INT_RX_OK | INT_RX_ERR | INT_RX_OVERFLOW)
+#define INT_TX_MASK     (INT_TX_OK | INT_TX_ERR)
+
+// Overflow visto no IRQ, tratado no próximo poll (reset do RX mexe no rx_offset)
+static volatile bool rx_overflow = false;
+
+// ============================================================
+// rx_reset — reinicia o RX e volta o ring para o offset 0
+// ============================================================
+static void rx_reset(void) {
+    uint8_t cmd = inb(io_base + REG_CMD);
+    outb(io_base + REG_CMD, cmd & ~CMD_RX_ENABLE);
+    outb(io_base + REG_CMD, cmd | CMD_RX_ENABLE);
+    rx_offset = 0;
+    outw(io_base + REG_CAPR, 0xFFF0);  // CAPR initial = -16
+}
+
+// ============================================================
+// tx_reclaim — devolve os descriptors que a NIC terminou (em ordem)
+// Chamar com interrupções desabilitadas
+// ============================================================
+static void tx_reclaim(void) {
+    while (tx_inflight > 0) {
+        uint32_t tsd = inl(io_base + REG_TX_STATUS0 + (tx_head * 4));
+        if (!(tsd & (TSD_TOK | TSD_TABT | TSD_TUN))) break;  // NIC ainda dona
+
+        pbuf_t *p = tx_pbufs[tx_head];
+        if (tsd & TSD_TOK) {
+            netdev.stats.tx_packets++;
+            netdev.stats.tx_bytes += p->len;
+        } else {
+            netdev.stats.tx_errors++;
+        }
+        pbuf_free(p);
+        tx_pbufs[tx_head] = NULL;
+        tx_head = (tx_head + 1) % TX_DESC_COUNT;
+        tx_inflight--;
+    }
+}
+
+// ============================================================
+// tx_kick — passa pbufs da fila de software para descriptors livres
+// Chamar com interrupções desabilitadas
+// ============================================================
+static void tx_kick(void) {
+    while (txq_first && tx_inflight < TX_DESC_COUNT) {
+        pbuf_t *p = txq_first;
+        txq_first = p->next;
+        if (!txq_first) txq_last = NULL;
+        p->next = NULL;
+        netdev.stats.tx_queue_depth--;
+
+        tx_pbufs[tx_tail] = p;
+
+        // Escreve endereço físico do payload (identity map: virt == phys)
+        outl(io_base + REG_TX_ADDR0 + (tx_tail * 4), (uint32_t)p->payload);
+
+        // Escreve status: tamanho nos bits 0-12, bit 13 = OWN (clear = NIC pode enviar)
+        // Threshold bits 16-21 = 0 (começa DMA imediatamente)
+        outl(io_base + REG_TX_STATUS0 + (tx_tail * 4), (uint32_t)p->len);
+
+        tx_tail = (tx_tail + 1) % TX_DESC_COUNT;
+        tx_inflight++;
+    }
+}
+
 // ============================================================
 // rtl8139_irq_handler — chamado pelo ISR dispatcher
+// Só reconhece o hardware; o RX fica para rtl8139_poll (softirq)
 // ============================================================
 static void rtl8139_irq_handler(struct isr_frame *frame) {
     (void)frame;
@@ -120,80 +194,160 @@ static void rtl8139_irq_handler(struct isr_frame *frame) {
     // RTL8139 requer ack antes de processar pacotes (level-triggered PCI interrupt).
     outw(io_base + REG_ISR, isr_status);
 
-    if (isr_status & INT_TX_OK) {
-        stats.tx_packets++;
+    if (isr_status & INT_TX_MASK) {
+        // Descriptors concluídos voltam e a fila de software anda
+        tx_reclaim();
+        tx_kick();
     }
 
-    if (isr_status & INT_TX_ERR) {
-        stats.tx_errors++;
+    if (isr_status & INT_RX_OVERFLOW) {
+        netdev.stats.rx_errors++;
+        rx_overflow = true;
     }
 
-    if (isr_status & INT_RX_OVERFLOW) {
-        stats.rx_errors++;
-        // Reset do RX em caso de overflow
-        uint8_t cmd = inb(io_base + REG_CMD);
-        outb(io_base + REG_CMD, cmd & ~CMD_RX_ENABLE);
-        outb(io_base + REG_CMD, cmd | CMD_RX_ENABLE);
-        rx_offset = 0;
-        outw(io_base + REG_CAPR, 0xFFF0);  // CAPR initial = -16
+    if (isr_status & INT_RX_MASK) {
+        // Mascara RX até o poll esvaziar o ring e agenda o bottom half
+        outw(io_base + REG_IMR, INT_TX_MASK);
+        softirq_raise(SOFTIRQ_NET_RX);
     }
+}
 
-    if (isr_status & (INT_RX_OK | INT_RX_ERR)) {
-        // Processa todos os pacotes pendentes no ring buffer.
+// ============================================================
+// rtl8139_poll — drena até budget pacotes do ring (ops->poll)
+// Ring vazio religa as interrupções de RX; == budget deixa mascarado
+// ============================================================
+static int rtl8139_poll(netdev_t *dev, int budget) {
+    (void)dev;
+    if (!nic_present) return 0;
+    netdev.stats.rx_polls++;
+
+    if (rx_overflow) {
+        rx_overflow = false;
+        rx_reset();
+    }
+
+    int done = 0;
+    while (done < budget) {
         // Compara CAPR+16 vs CBR para detectar pacotes (mais confiável que BUFE bit).
-        while (1) {
-            uint8_t cmd_reg = inb(io_base + REG_CMD);
-            if (cmd_reg & 0x01) break;  // Buffer empty bit set — nada mais
-
-            // Lê header do pacote
-            rx_header_t *hdr = (rx_header_t *)(rx_buffer + rx_offset);
-
-            if (!(hdr->status & RX_STATUS_ROK)) {
-                // Pacote com erro — pula este pacote
-                stats.rx_errors++;
-
-                // Se não tem tamanho válido, faz reset
-                if (hdr->length == 0 || hdr->length > RTL8139_BUF_SIZE) {
-                    // Corrupto — reset RX
-                    uint8_t c = inb(io_base + REG_CMD);
-                    outb(io_base + REG_CMD, c & ~CMD_RX_ENABLE);
-                    outb(io_base + REG_CMD, c | CMD_RX_ENABLE);
-                    rx_offset = 0;
-                    outw(io_base + REG_CAPR, 0xFFF0);
-                    break;
-                }
-
-                // Avança offset passando o pacote com erro
-                rx_offset = (rx_offset + sizeof(rx_header_t) + hdr->length + 3) & ~3;
-                rx_offset %= RX_RING_SIZE;
-                outw(io_base + REG_CAPR, (uint16_t)(rx_offset - 16));
-                continue;
-            }
+        uint8_t cmd_reg = inb(io_base + REG_CMD);
+        if (cmd_reg & 0x01) break;  // Buffer empty bit set — nada mais
 
-            uint16_t pkt_len = hdr->length - 4;  // Remove CRC (4 bytes)
+        // Lê header do pacote
+        rx_header_t *hdr = (rx_header_t *)(rx_buffer + rx_offset);
+        uint16_t raw_len = hdr->length;
 
-            if (pkt_len > 0 && pkt_len <= RTL8139_BUF_SIZE) {
-                stats.rx_packets++;
-                stats.rx_bytes += pkt_len;
+        if (!(hdr->status & RX_STATUS_ROK)) {
+            // Pacote com erro — pula este pacote
+            netdev.stats.rx_errors++;
 
-                // Dados do pacote começam após o header (4 bytes)
-                uint8_t *pkt_data = rx_buffer + rx_offset + sizeof(rx_header_t);
+            // Se não tem tamanho válido, faz reset
+            if (raw_len == 0 || raw_len > RTL8139_BUF_SIZE) {
+                rx_reset();  // Corrupto — reset RX
+                break;
+            }
+        } else {
+            uint16_t pkt_len = raw_len - 4;  // Remove CRC (4 bytes)
 
-                if (rx_callback) {
-                    rx_callback(pkt_data, pkt_len);
-                }
+            if (pkt_len > 0 && pkt_len <= RTL8139_BUF_SIZE) {
+                // Despacha direto do ring: a NIC não sobrescreve
+                // a área antes do CAPR avançar
+                netdev_rx(&netdev, rx_buffer + rx_offset + sizeof(rx_header_t), pkt_len, 0);
             }
+        }
+        done++;
+
+        // Avança offset: header(4) + length, alinhado a 4 bytes (DWORD)
+        rx_offset = (rx_offset + sizeof(rx_header_t) + raw_len + 3) & ~3;
+        rx_offset %= RX_RING_SIZE;  // Ring wraps at 64K, not at BUF_SIZE
 
-            // Avança offset: header(4) + length, alinhado a 4 bytes (DWORD)
-            rx_offset = (rx_offset + sizeof(rx_header_t) + hdr->length + 3) & ~3;
-            rx_offset %= RX_RING_SIZE;  // Ring wraps at 8K, not at BUF_SIZE
+        // Atualiza CAPR (offset - 16 por quirk do hardware RTL8139)
+        outw(io_base + REG_CAPR, (uint16_t)(rx_offset - 16));
+    }
 
-            // Atualiza CAPR (offset - 16 por quirk do hardware RTL8139)
-            outw(io_base + REG_CAPR, (uint16_t)(rx_offset - 16));
+    if (done >= budget) {
+        // Ring ainda pode ter pacotes: RX segue mascarado, quem chamou re-agenda
+        netdev.stats.rx_budget_hits++;
+        return done;
+    }
+
+    // Ring vazio: religa RX. Pacote que chegou depois do teste de vazio
+    // deixou ROK no ISR e dispara a IRQ assim que o IMR é restaurado.
+    outw(io_base + REG_IMR, INT_RX_MASK | INT_TX_MASK);
+    return done;
+}
+
+// ============================================================
+// rtl8139_send — envia um frame Ethernet (ops->send, consome a referência de p)
+// Vai para um descriptor livre ou para a fila de software; com a fila cheia
+// espera até RTL8139_TX_TIMEOUT_MS pelo IRQ de TX OK (backpressure)
+// ============================================================
+static bool rtl8139_send(netdev_t *dev, pbuf_t *p) {
+    (void)dev;
+    if (!nic_present || !p || p->len == 0 || p->len > RTL8139_BUF_SIZE) {
+        pbuf_free(p);
+        return false;
+    }
+
+    // TSAD exige endereço alinhado a 4 bytes. O buf do pbuf é alinhado,
+    // então recuar até o múltiplo de 4 anterior nunca sai do headroom
+    // (kmemcpy copia para frente: seguro com destino antes da origem)
+    uint32_t misalign = (uint32_t)p->payload & 3;
+    if (misalign) {
+        kmemcpy(p->payload - misalign, p->payload, p->len);
+        p->payload -= misalign;
+        netdev.stats.tx_realigned++;
+    }
+
+    // Padding mínimo Ethernet: 60 bytes (sem CRC)
+    if (p->len < 60) {
+        kmemset(p->payload + p->len, 0, 60 - p->len);
+        p->len = 60;
+    }
+
+    // Fila compartilhada entre a shell, o softirq NET_RX (ACKs) e o IRQ de TX
+    uint32_t flags = irq_save();
+    tx_reclaim();
+
+    // Backpressure: fila cheia espera o IRQ de TX OK liberar espaço
+    // (só se quem chamou estava com IF=1; senão o IRQ nunca viria)
+    if (netdev.stats.tx_queue_depth >= RTL8139_TX_QUEUE_MAX) {
+        netdev.stats.tx_stalls++;
+        uint32_t start = pit_get_ms();
+        while (netdev.stats.tx_queue_depth >= RTL8139_TX_QUEUE_MAX) {
+            if (!(flags & 0x200) || pit_get_ms() - start >= RTL8139_TX_TIMEOUT_MS) {
+                netdev.stats.tx_drops++;
+                irq_restore(flags);
+                pbuf_free(p);
+                return false;
+            }
+            asm volatile("sti; hlt; cli" ::: "memory");
+            tx_reclaim();
+            tx_kick();
         }
     }
+
+    p->next = NULL;
+    if (txq_last) {
+        txq_last->next = p;
+    } else {
+        txq_first = p;
+    }
+    txq_last = p;
+    netdev.stats.tx_queue_depth++;
+    if (netdev.stats.tx_queue_depth > netdev.stats.tx_queue_max) {
+        netdev.stats.tx_queue_max = netdev.stats.tx_queue_depth;
+    }
+
+    tx_kick();
+    irq_restore(flags);
+    return true;
 }
 
+static const netdev_ops_t rtl8139_ops = {
+    .send = rtl8139_send,
+    .poll = rtl8139_poll,
+};
+
 // ============================================================
 // rtl8139_init — inicializa a NIC
 // ============================================================
@@ -225,54 +379,17 @@ bool rtl8139_init(void) {
     // 6. Lê MAC address
     uint32_t mac_low  = inl(io_base + REG_MAC0);
     uint16_t mac_high = inw(io_base + REG_MAC4);
-    mac_addr[0] = (uint8_t)(mac_low >>  0);
-    mac_addr[1] = (uint8_t)(mac_low >>  8);
-    mac_addr[2] = (uint8_t)(mac_low >> 16);
-    mac_addr[3] = (uint8_t)(mac_low >> 24);
-    mac_addr[4] = (uint8_t)(mac_high >> 0);
-    mac_addr[5] = (uint8_t)(mac_high >> 8);
+    netdev.mac[0] = (uint8_t)(mac_low >>  0);
+    netdev.mac[1] = (uint8_t)(mac_low >>  8);
+    netdev.mac[2] = (uint8_t)(mac_low >> 16);
+    netdev.mac[3] = (uint8_t)(mac_low >> 24);
+    netdev.mac[4] = (uint8_t)(mac_high >> 0);
+    netdev.mac[5] = (uint8_t)(mac_high >> 8);
 
     // 7. Aloca RX buffer — RX_BUF_FRAMES frames PMM contíguos (68KB) para 64K ring
-    // Identity map garante phys == virt
-    // Estratégia: aloca frames sequencialmente até encontrar RX_BUF_FRAMES contíguos
-    uint32_t frame0 = 0;
-    {
-        uint32_t alloc_buf[64];  // Tenta até 64 frames
-        int allocated = 0;
-        bool found = false;
-
-        for (int i = 0; i < 64 && !found; i++) {
-            alloc_buf[i] = pmm_alloc_frame();
-            allocated = i + 1;
-            if (!alloc_buf[i]) break;
-
-            // Verifica se temos RX_BUF_FRAMES contíguos terminando aqui
-            if (i >= RX_BUF_FRAMES - 1) {
-                bool contiguous = true;
-                for (int j = 1; j < RX_BUF_FRAMES; j++) {
-                    if (alloc_buf[i - j + 1] != alloc_buf[i - j] + PMM_FRAME_SIZE) {
-                        contiguous = false;
-                        break;
-                    }
-                }
-                if (contiguous) {
-                    frame0 = alloc_buf[i - RX_BUF_FRAMES + 1];
-                    found = true;
-                }
-            }
-        }
-
-        // Libera frames que não fazem parte do bloco contíguo
-        for (int i = 0; i < allocated; i++) {
-            if (alloc_buf[i] &&
-                (alloc_buf[i] < frame0 ||
-                 alloc_buf[i] >= frame0 + RX_BUF_FRAMES * PMM_FRAME_SIZE)) {
-                pmm_free_frame(alloc_buf[i]);
-            }
-        }
-
-        if (!found) return false;
-    }
+    // Abaixo de 16MB: identity map garante phys == virt
+    uint32_t frame0 = pmm_alloc_contiguous(RX_BUF_FRAMES, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (!frame0) return false;
 
     rx_buffer = (uint8_t *)frame0;
     kmemset(rx_buffer, 0, RX_BUF_FRAMES * PMM_FRAME_SIZE);
@@ -282,7 +399,7 @@ bool rtl8139_init(void) {
     outl(io_base + REG_RX_BUF, (uint32_t)rx_buffer);
 
     // 9. Configura Interrupt Mask — ativa RX OK, TX OK, erros
-    outw(io_base + REG_IMR, INT_RX_OK | INT_RX_ERR | INT_TX_OK | INT_TX_ERR | INT_RX_OVERFLOW);
+    outw(io_base + REG_IMR, INT_RX_MASK | INT_TX_MASK);
 
     // 10. Configura RX: aceita broadcast + physical match, wrap, buffer 64KB
     // Bits 11:13 = buffer size: 11 = 64K+16
@@ -301,73 +418,15 @@ bool rtl8139_init(void) {
     // CAPR inicial = 0xFFF0 (= rx_offset(0) - 16), padrão do hardware
     outw(io_base + REG_CAPR, 0xFFF0);
 
-    // 13. Registra IRQ handler
+    // 13. Registra como eth0 (zera stats) antes de liberar a IRQ
+    netdev.driver = "RTL8139";
+    netdev.ops = &rtl8139_ops;
+    if (!netdev_register(&netdev)) return false;
+
+    // 14. Registra IRQ handler
     isr_register_handler(IRQ_TO_INT(irq_line), rtl8139_irq_handler);
     pic_unmask_irq(irq_line);
 
-    // 14. Zera stats
-    kmemset(&stats, 0, sizeof(stats));
-
     nic_present = true;
     return true;
 }
-
-// ============================================================
-// rtl8139_send — envia um frame Ethernet
-// ============================================================
-bool rtl8139_send(const void *data, uint16_t len) {
-    if (!nic_present || !data || len == 0 || len > RTL8139_BUF_SIZE) {
-        return false;
-    }
-
-    // Copia dados para o TX buffer do descriptor atual
-    kmemcpy(tx_buffers[tx_current], data, len);
-
-    // Padding mínimo Ethernet: 60 bytes (sem CRC)
-    if (len < 60) {
-        kmemset(tx_buffers[tx_current] + len, 0, 60 - len);
-        len = 60;
-    }
-
-    // Escreve endereço físico do buffer (identity map: virt == phys)
-    outl(io_base + REG_TX_ADDR0 + (tx_current * 4), (uint32_t)tx_buffers[tx_current]);
-
-    // Escreve status: tamanho nos bits 0-12, bit 13 = OWN (clear = NIC pode enviar)
-    // Threshold bits 16-21 = 0 (começa DMA imediatamente)
-    outl(io_base + REG_TX_STATUS0 + (tx_current * 4), (uint32_t)len);
-
-    stats.tx_bytes += len;
-
-    // Avança para próximo descriptor (round-robin)
-    tx_current = (tx_current + 1) % TX_DESC_COUNT;
-
-    return true;
-}
-
-// ============================================================
-// rtl8139_get_mac — copia MAC address
-// ============================================================
-void rtl8139_get_mac(uint8_t *mac_out) {
-    kmemcpy(mac_out, mac_addr, ETH_ALEN);
-}
-
-// ============================================================
-// rtl8139_is_present — verifica se NIC está ativa
-// ============================================================
-bool rtl8139_is_present(void) {
-    return nic_present;
-}
-
-// ============================================================
-// rtl8139_get_stats — retorna estatísticas
-// ============================================================
-nic_stats_t rtl8139_get_stats(void) {
-    return stats;
-}
-
-// ============================================================
-// rtl8139_set_rx_callback — registra callback de recepção
-// ============================================================
-void rtl8139_set_rx_callback(rtl8139_rx_callback_t cb) {
-    rx_callback = cb;
-}
@@ -0,0 +1,431 @@
+// LeonardOS - virtio-net Network Driver
+// Implementação do driver virtio-net (interface legacy, split virtqueues)
+//
+// Cada virtqueue ocupa frames contíguos do PMM abaixo de 16MB:
+//   descriptors (16B cada) | avail ring | padding até 4KB | used ring
+// RX: VIRTIO_NET_RX_BUFS slots de 2KB, cadeia fixa (2i: header, 2i+1: frame)
+// TX: cadeia fixa por slot (2i: header zerado, 2i+1: payload do pbuf).
+//     Com o ring ocioso o notify é imediato; com frames em voo é adiado e
+//     sai a cada VIRTIO_NET_TX_KICK_BATCH frames, quando os slots acabam,
+//     ou no fim do próximo poll (o envio agenda o NET_RX)
+//
+// Referência: Virtio 1.0 spec, seção 2.4 (legacy) e 5.1 (network device)
+
+#include "virtio_net.h"
+#include "../pci/pci.h"
+#include "../../common/io.h"
+#include "../../common/string.h"
+#include "../../cpu/isr.h"
+#include "../../cpu/softirq.h"
+#include "../../drivers/pic/pic.h"
+#include "../../drivers/timer/pit.h"
+#include "../../memory/pmm.h"
+
+// ============================================================
+// Split virtqueue
+// ============================================================
+#define VRING_DESC_F_NEXT           1   // Cadeia continua em .next
+#define VRING_DESC_F_WRITE          2   // Dispositivo escreve (RX)
+#define VRING_AVAIL_F_NO_INTERRUPT  1   // Driver: não interrompa ao usar buffers
+#define VRING_USED_F_NO_NOTIFY      1   // Dispositivo: não precisa de notify
+#define VRING_ALIGN                 4096
+
+typedef struct {
+    uint64_t addr;      // Endereço físico
+    uint32_t len;
+    uint16_t flags;     // VRING_DESC_F_*
+    uint16_t next;
+} __attribute__((packed)) vring_desc_t;
+
+typedef struct {
+    uint16_t flags;     // VRING_AVAIL_F_*
+    uint16_t idx;       // Próxima posição livre (cresce sem wrap)
+    uint16_t ring[];    // Índice do primeiro descriptor de cada cadeia
+} __attribute__((packed)) vring_avail_t;
+
+typedef struct {
+    uint32_t id;        // Primeiro descriptor da cadeia devolvida
+    uint32_t len;       // Bytes escritos pelo dispositivo
+} __attribute__((packed)) vring_used_elem_t;
+
+typedef struct {
+    uint16_t flags;     // VRING_USED_F_*
+    uint16_t idx;
+    vring_used_elem_t ring[];
+} __attribute__((packed)) vring_used_t;
+
+typedef struct {
+    uint16_t                index;      // 0 = RX, 1 = TX
+    uint16_t                size;       // Descriptors (fixo pelo dispositivo)
+    volatile vring_desc_t  *desc;
+    volatile vring_avail_t *avail;
+    volatile vring_used_t  *used;
+    uint16_t                last_used;  // Próxima entrada do used ring a consumir
+} virtq_t;
+
+// Header que precede cada frame (sem MRG_RXBUF: 10 bytes)
+typedef struct {
+    uint8_t  flags;
+    uint8_t  gso_type;
+    uint16_t hdr_len;
+    uint16_t gso_size;
+    uint16_t csum_start;
+    uint16_t csum_offset;
+} __attribute__((packed)) virtio_net_hdr_t;
+
+// Frame começa alinhado dentro do slot de RX
+#define RX_FRAME_OFFSET   16
+
+// Barreiras: x86 não reordena stores entre si; store->load precisa de fence
+#define virtio_wmb()  asm volatile("" ::: "memory")
+#define virtio_mb()   asm volatile("lock; addl $0, (%%esp)" ::: "memory")
+
+// ============================================================
+// Estado do driver (tudo estático)
+// ============================================================
+static bool      nic_present = false;
+static uint16_t  io_base = 0;
+static uint8_t   irq_line = 0;
+static netdev_t  netdev;
+
+static virtq_t   rxq;
+static virtq_t   txq;
+
+// RX — slots de VIRTIO_NET_BUF_SIZE contíguos (identity map, phys == virt)
+static uint8_t  *rx_slots = NULL;
+static uint16_t  rx_buf_count = 0;
+
+// TX — pbuf em voo por slot + pilha de slots livres
+static virtio_net_hdr_t tx_hdrs[VIRTIO_NET_TX_SLOTS];   // Sempre zerados (sem offload)
+static pbuf_t  *tx_pbufs[VIRTIO_NET_TX_SLOTS];
+static uint16_t tx_free[VIRTIO_NET_TX_SLOTS];
+static uint16_t tx_free_count = 0;
+static uint16_t tx_slot_count = 0;
+static uint16_t tx_unkicked = 0;        // Publicados no avail ring sem notify
+
+// ============================================================
+// virtq_setup — aloca e registra a virtqueue index
+// ============================================================
+static bool virtq_setup(virtq_t *q, uint16_t index) {
+    outw(io_base + VIRTIO_REG_QUEUE_SELECT, index);
+    uint16_t size = inw(io_base + VIRTIO_REG_QUEUE_SIZE);
+    if (size == 0 || size > VIRTIO_QUEUE_MAX || (size & (size - 1))) return false;
+
+    // Layout legacy: used ring começa no próximo limite de 4KB
+    uint32_t avail_end = 16u * size + 6 + 2u * size;
+    uint32_t used_off  = (avail_end + VRING_ALIGN - 1) & ~(VRING_ALIGN - 1);
+    uint32_t total     = used_off + ((6 + 8u * size + VRING_ALIGN - 1) & ~(VRING_ALIGN - 1));
+    uint32_t frames    = total / PMM_FRAME_SIZE;
+
+    uint32_t base = pmm_alloc_contiguous(frames, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (!base) return false;
+    kmemset((void *)base, 0, total);
+
+    q->index     = index;
+    q->size      = size;
+    q->desc      = (volatile vring_desc_t *)base;
+    q->avail     = (volatile vring_avail_t *)(base + 16u * size);
+    q->used      = (volatile vring_used_t *)(base + used_off);
+    q->last_used = 0;
+
+    outl(io_base + VIRTIO_REG_QUEUE_PFN, base >> 12);
+    return true;
+}
+
+// ============================================================
+// virtq_push — publica a cadeia head no avail ring (sem notify)
+// ============================================================
+static void virtq_push(virtq_t *q, uint16_t head) {
+    uint16_t idx = q->avail->idx;
+    q->avail->ring[idx % q->size] = head;
+    virtio_wmb();           // Entrada visível antes do índice
+    q->avail->idx = idx + 1;
+}
+
+// ============================================================
+// virtq_kick — notifica o dispositivo, se ele não suprimiu
+// Retorna true se escreveu no registrador de notify
+// ============================================================
+static bool virtq_kick(virtq_t *q) {
+    virtio_mb();            // avail->idx antes de ler used->flags
+    if (q->used->flags & VRING_USED_F_NO_NOTIFY) return false;
+    outw(io_base + VIRTIO_REG_QUEUE_NOTIFY, q->index);
+    return true;
+}
+
+// ============================================================
+// tx_flush — um notify para todos os frames de TX ainda não avisados
+// Chamar com interrupções desabilitadas
+// ============================================================
+static void tx_flush(void) {
+    if (tx_unkicked == 0) return;
+    tx_unkicked = 0;
+    if (virtq_kick(&txq)) netdev.stats.tx_kicks++;
+}
+
+// ============================================================
+// tx_reclaim — solta os pbufs que o dispositivo já transmitiu
+// Chamar com interrupções desabilitadas
+// ============================================================
+static void tx_reclaim(void) {
+    while (txq.last_used != txq.used->idx) {
+        volatile vring_used_elem_t *e = &txq.used->ring[txq.last_used % txq.size];
+        uint16_t slot = (uint16_t)(e->id / 2);
+        txq.last_used++;
+        if (slot >= tx_slot_count || !tx_pbufs[slot]) continue;
+
+        netdev.stats.tx_packets++;
+        netdev.stats.tx_bytes += tx_pbufs[slot]->len;
+        pbuf_free(tx_pbufs[slot]);
+        tx_pbufs[slot] = NULL;
+        tx_free[tx_free_count++] = slot;
+        netdev.stats.tx_queue_depth--;
+    }
+}
+
+// Gancho do pool de pbufs: com TX sem interrupção, pbufs transmitidos
+// só voltam quando alguém olha o used ring
+static void virtio_net_reclaim_hook(void) {
+    uint32_t flags = irq_save();
+    tx_reclaim();
+    irq_restore(flags);
+}
+
+// ============================================================
+// virtio_net_irq_handler — só reconhece e agenda o poll
+// ============================================================
+static void virtio_net_irq_handler(struct isr_frame *frame) {
+    (void)frame;
+
+    // Leitura do ISR reconhece a interrupção e baixa a linha
+    uint8_t isr = inb(io_base + VIRTIO_REG_ISR);
+
+    if (isr & 0x01) {
+        // Desliga interrupções de RX até o poll esvaziar a fila
+        rxq.avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+        softirq_raise(SOFTIRQ_NET_RX);
+    }
+}
+
+// ============================================================
+// virtio_net_poll — drena até budget frames do used ring de RX
+// Cada buffer volta ao avail ring logo após a entrega; um único
+// notify por poll para o lote reposto
+// ============================================================
+static int virtio_net_poll(netdev_t *dev, int budget) {
+    (void)dev;
+    if (!nic_present) return 0;
+    netdev.stats.rx_polls++;
+
+    // TX sem interrupção: aproveita o poll para devolver pbufs
+    uint32_t flags = irq_save();
+    tx_reclaim();
+    irq_restore(flags);
+
+    int done = 0;
+    int refilled = 0;
+    while (done < budget) {
+        if (rxq.last_used == rxq.used->idx) {
+            // Vazio: religa interrupções e confere de novo (um frame que
+            // chegou entre o teste e a religação não geraria IRQ)
+            rxq.avail->flags = 0;
+            virtio_mb();
+            if (rxq.last_used == rxq.used->idx) break;
+            rxq.avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+            continue;
+        }
+
+        volatile vring_used_elem_t *e = &rxq.used->ring[rxq.last_used % rxq.size];
+        uint16_t head = (uint16_t)e->id;
+        uint32_t len  = e->len;
+        rxq.last_used++;
+
+        uint16_t buf = head / 2;
+        if (buf < rx_buf_count && len > sizeof(virtio_net_hdr_t) &&
+            len - sizeof(virtio_net_hdr_t) <= VIRTIO_NET_BUF_SIZE - RX_FRAME_OFFSET) {
+            netdev_rx(&netdev, rx_slots + (uint32_t)buf * VIRTIO_NET_BUF_SIZE + RX_FRAME_OFFSET,
+                      (uint16_t)(len - sizeof(virtio_net_hdr_t)), 0);
+        } else {
+            netdev.stats.rx_errors++;
+        }
+
+        // Devolve o mesmo buffer (descriptors da cadeia não mudam)
+        if (buf < rx_buf_count) {
+            virtq_push(&rxq, head);
+            refilled++;
+        }
+        done++;
+    }
+
+    if (refilled > 0) virtq_kick(&rxq);
+    if (done >= budget) netdev.stats.rx_budget_hits++;
+
+    // Fecha o lote de TX: envios desde o último poll (inclusive respostas
+    // geradas pelos frames acima) saem com um só notify
+    flags = irq_save();
+    tx_flush();
+    irq_restore(flags);
+    return done;
+}
+
+// ============================================================
+// virtio_net_send — publica o pbuf no TX (ops->send, consome a referência)
+// ============================================================
+static bool virtio_net_send(netdev_t *dev, pbuf_t *p) {
+    (void)dev;
+    if (!nic_present || !p || p->len == 0 || p->len > VIRTIO_NET_BUF_SIZE) {
+        pbuf_free(p);
+        return false;
+    }
+
+    uint32_t flags = irq_save();
+    tx_reclaim();
+
+    // Sem slot livre: espera o dispositivo consumir (TX não interrompe,
+    // então acorda no tick do PIT e olha o used ring de novo)
+    if (tx_free_count == 0) {
+        netdev.stats.tx_stalls++;
+        tx_flush();         // O dispositivo só libera slots que conhece
+        uint32_t start = pit_get_ms();
+        while (tx_free_count == 0) {
+            if (!(flags & 0x200) || pit_get_ms() - start >= VIRTIO_NET_TX_TIMEOUT_MS) {
+                netdev.stats.tx_drops++;
+                irq_restore(flags);
+                pbuf_free(p);
+                return false;
+            }
+            asm volatile("sti; hlt; cli" ::: "memory");
+            tx_reclaim();
+        }
+    }
+
+    uint16_t slot = tx_free[--tx_free_count];
+    tx_pbufs[slot] = p;
+
+    // DMA direto do payload (identity map: virt == phys)
+    volatile vring_desc_t *d = &txq.desc[slot * 2 + 1];
+    d->addr = (uint32_t)p->payload;
+    d->len  = p->len;
+
+    // Frames que o dispositivo já conhece e ainda não devolveu
+    bool busy = netdev.stats.tx_queue_depth > tx_unkicked;
+
+    virtq_push(&txq, (uint16_t)(slot * 2));
+    netdev.stats.tx_queue_depth++;
+    if (netdev.stats.tx_queue_depth > netdev.stats.tx_queue_max) {
+        netdev.stats.tx_queue_max = netdev.stats.tx_queue_depth;
+    }
+
+    // Ring ocioso: notify já (um ping não espera o tick do PIT). Com frames
+    // em voo, acumula até o lote encher ou o fim do próximo poll
+    tx_unkicked++;
+    if (!busy || tx_unkicked >= VIRTIO_NET_TX_KICK_BATCH) tx_flush();
+    else softirq_raise(SOFTIRQ_NET_RX);
+
+    irq_restore(flags);
+    return true;
+}
+
+static const netdev_ops_t virtio_net_ops = {
+    .send = virtio_net_send,
+    .poll = virtio_net_poll,
+};
+
+// ============================================================
+// virtio_net_init — inicializa a NIC
+// ============================================================
+bool virtio_net_init(void) {
+    // 1. Busca o device no PCI (BAR0 precisa ser I/O: interface legacy)
+    pci_device_t dev;
+    if (!pci_find_device(VIRTIO_VENDOR_ID, VIRTIO_NET_DEVICE_ID, &dev)) {
+        return false;
+    }
+    if (!(dev.bar0 & 0x1)) return false;
+
+    io_base  = (uint16_t)(dev.bar0 & ~0x3);
+    irq_line = dev.irq_line;
+    pci_enable_bus_mastering(&dev);
+
+    // 2. Reset + ACK + DRIVER
+    outb(io_base + VIRTIO_REG_STATUS, 0);
+    outb(io_base + VIRTIO_REG_STATUS, VIRTIO_STATUS_ACK);
+    outb(io_base + VIRTIO_REG_STATUS, VIRTIO_STATUS_ACK | VIRTIO_STATUS_DRIVER);
+
+    // 3. Features: só o MAC no config space (sem offloads, sem MRG_RXBUF)
+    uint32_t features = inl(io_base + VIRTIO_REG_HOST_FEATURES) & VIRTIO_NET_F_MAC;
+    outl(io_base + VIRTIO_REG_GUEST_FEATURES, features);
+
+    // 4. Virtqueues: 0 = RX, 1 = TX
+    if (!virtq_setup(&rxq, 0) || !virtq_setup(&txq, 1)) {
+        outb(io_base + VIRTIO_REG_STATUS, VIRTIO_STATUS_FAILED);
+        return false;
+    }
+
+    // 5. Buffers de RX: cada slot vira uma cadeia header -> frame
+    rx_buf_count = rxq.size / 2;
+    if (rx_buf_count > VIRTIO_NET_RX_BUFS) rx_buf_count = VIRTIO_NET_RX_BUFS;
+    uint32_t rx_frames = ((uint32_t)rx_buf_count * VIRTIO_NET_BUF_SIZE + PMM_FRAME_SIZE - 1) / PMM_FRAME_SIZE;
+    uint32_t rx_base = pmm_alloc_contiguous(rx_frames, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (!rx_base) {
+        outb(io_base + VIRTIO_REG_STATUS, VIRTIO_STATUS_FAILED);
+        return false;
+    }
+    rx_slots = (uint8_t *)rx_base;
+
+    for (uint16_t i = 0; i < rx_buf_count; i++) {
+        uint32_t slot = rx_base + (uint32_t)i * VIRTIO_NET_BUF_SIZE;
+        volatile vring_desc_t *h = &rxq.desc[i * 2];
+        volatile vring_desc_t *f = &rxq.desc[i * 2 + 1];
+        h->addr  = slot;
+        h->len   = sizeof(virtio_net_hdr_t);
+        h->flags = VRING_DESC_F_WRITE | VRING_DESC_F_NEXT;
+        h->next  = (uint16_t)(i * 2 + 1);
+        f->addr  = slot + RX_FRAME_OFFSET;
+        f->len   = VIRTIO_NET_BUF_SIZE - RX_FRAME_OFFSET;
+        f->flags = VRING_DESC_F_WRITE;
+        virtq_push(&rxq, (uint16_t)(i * 2));
+    }
+
+    // 6. TX: cadeias fixas header -> payload, interrupções suprimidas
+    tx_slot_count = txq.size / 2;
+    if (tx_slot_count > VIRTIO_NET_TX_SLOTS) tx_slot_count = VIRTIO_NET_TX_SLOTS;
+    kmemset(tx_hdrs, 0, sizeof(tx_hdrs));
+    tx_free_count = 0;
+    for (int i = tx_slot_count - 1; i >= 0; i--) {
+        volatile vring_desc_t *h = &txq.desc[i * 2];
+        h->addr  = (uint32_t)&tx_hdrs[i];
+        h->len   = sizeof(virtio_net_hdr_t);
+        h->flags = VRING_DESC_F_NEXT;
+        h->next  = (uint16_t)(i * 2 + 1);
+        txq.desc[i * 2 + 1].flags = 0;
+        tx_pbufs[i] = NULL;
+        tx_free[tx_free_count++] = (uint16_t)i;
+    }
+    txq.avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+
+    // 7. MAC do config space (ou um endereço local fixo)
+    static const uint8_t fallback_mac[ETH_ALEN] = {0x52, 0x54, 0x00, 0x12, 0x34, 0x57};
+    for (int i = 0; i < ETH_ALEN; i++) {
+        netdev.mac[i] = (features & VIRTIO_NET_F_MAC)
+                      ? inb(io_base + VIRTIO_REG_NET_MAC + i) : fallback_mac[i];
+    }
+
+    // 8. Registra como eth0 e liga a IRQ
+    netdev.driver = "virtio-net";
+    netdev.ops = &virtio_net_ops;
+    if (!netdev_register(&netdev)) {
+        outb(io_base + VIRTIO_REG_STATUS, VIRTIO_STATUS_FAILED);
+        return false;
+    }
+    pbuf_set_reclaim(virtio_net_reclaim_hook);
+
+    isr_register_handler(IRQ_TO_INT(irq_line), virtio_net_irq_handler);
+    pic_unmask_irq(irq_line);
+
+    // 9. DRIVER_OK e primeiro notify do RX (buffers já postados)
+    outb(io_base + VIRTIO_REG_STATUS,
+         VIRTIO_STATUS_ACK | VIRTIO_STATUS_DRIVER | VIRTIO_STATUS_DRIVER_OK);
+    nic_present = true;
+    virtq_kick(&rxq);
+    return true;
+}
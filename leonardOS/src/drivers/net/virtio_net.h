@@ -0,0 +1,61 @@
+// LeonardOS - virtio-net Network Driver
+// Placa de rede paravirtualizada do QEMU (virtio legacy, PCI I/O mapped)
+//
+// Duas split virtqueues (0 = RX, 1 = TX), cada buffer uma cadeia de dois
+// descriptors: virtio_net_hdr + frame. RX pré-postado em lote; TX faz DMA
+// direto do pbuf. Interrupções de TX ficam suprimidas (descriptors voltam
+// no próximo envio/poll), o notify de TX é feito em lote, e as de RX são
+// desligadas enquanto o softirq NET_RX drena a fila.
+
+#ifndef __VIRTIO_NET_H__
+#define __VIRTIO_NET_H__
+
+#include "../../common/types.h"
+#include "netdev.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+// PCI: dispositivo transicional (expõe a interface legacy no BAR0)
+#define VIRTIO_VENDOR_ID        0x1AF4
+#define VIRTIO_NET_DEVICE_ID    0x1000
+
+// Registradores legacy (offset a partir do BAR0, I/O space)
+#define VIRTIO_REG_HOST_FEATURES   0x00   // 32-bit
+#define VIRTIO_REG_GUEST_FEATURES  0x04   // 32-bit
+#define VIRTIO_REG_QUEUE_PFN       0x08   // 32-bit (endereço físico >> 12)
+#define VIRTIO_REG_QUEUE_SIZE      0x0C   // 16-bit (fixo pelo dispositivo)
+#define VIRTIO_REG_QUEUE_SELECT    0x0E   // 16-bit
+#define VIRTIO_REG_QUEUE_NOTIFY    0x10   // 16-bit
+#define VIRTIO_REG_STATUS          0x12   // 8-bit
+#define VIRTIO_REG_ISR             0x13   // 8-bit (leitura reconhece)
+#define VIRTIO_REG_NET_MAC         0x14   // Config do dispositivo (sem MSI-X)
+
+// Device status
+#define VIRTIO_STATUS_ACK          0x01
+#define VIRTIO_STATUS_DRIVER       0x02
+#define VIRTIO_STATUS_DRIVER_OK    0x04
+#define VIRTIO_STATUS_FAILED       0x80
+
+// Features
+#define VIRTIO_NET_F_MAC           (1u << 5)
+
+// Limites do driver
+#define VIRTIO_QUEUE_MAX           1024    // Maior virtqueue aceita
+#define VIRTIO_NET_RX_BUFS         128     // Buffers de RX postados (2 descriptors cada)
+#define VIRTIO_NET_TX_SLOTS        128     // Frames de TX em voo (2 descriptors cada)
+#define VIRTIO_NET_BUF_SIZE        2048    // Slot de RX: header + frame
+#define VIRTIO_NET_TX_TIMEOUT_MS   100     // Espera máxima por slot de TX livre
+#define VIRTIO_NET_TX_KICK_BATCH   16      // Frames de TX por notify, no máximo
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Procura virtio-net no PCI, negocia features, monta as virtqueues,
+// posta os buffers de RX e registra a placa como eth0 na camada netdev
+// Retorna true se a NIC foi encontrada e inicializada
+bool virtio_net_init(void);
+
+#endif
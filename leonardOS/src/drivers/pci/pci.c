@@ -68,9 +68,26 @@ uint8_t pci_config_read8(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset
 }
 
 // ============================================================
-// pci_find_device — scan do barramento para achar vendor:device
+// pci_fill_device — preenche pci_device_t a partir do config space
+// ============================================================
+static void pci_fill_device(uint8_t bus, uint8_t slot, uint8_t func, pci_device_t *dev) {
+    dev->bus        = bus;
+    dev->slot       = slot;
+    dev->func       = func;
+    dev->vendor_id  = pci_config_read16(bus, slot, func, PCI_REG_VENDOR_ID);
+    dev->device_id  = pci_config_read16(bus, slot, func, PCI_REG_DEVICE_ID);
+    dev->class_code = pci_config_read8(bus, slot, func, PCI_REG_CLASS);
+    dev->subclass   = pci_config_read8(bus, slot, func, PCI_REG_SUBCLASS);
+    dev->irq_line   = pci_config_read8(bus, slot, func, PCI_REG_IRQ_LINE);
+    dev->bar0       = pci_config_read32(bus, slot, func, PCI_REG_BAR0);
+    dev->present    = true;
+}
+
 // ============================================================
-bool pci_find_device(uint16_t vendor_id, uint16_t device_id, pci_device_t *dev) {
+// pci_scan — percorre o barramento e para no primeiro device aceito
+// match_class: compara class/subclass; senão compara vendor/device
+// ============================================================
+static bool pci_scan(bool match_class, uint16_t a, uint16_t b, pci_device_t *dev) {
     for (uint16_t bus = 0; bus < 256; bus++) {
         for (uint8_t slot = 0; slot < 32; slot++) {
             for (uint8_t func = 0; func < 8; func++) {
@@ -81,18 +98,16 @@ bool pci_find_device(uint16_t vendor_id, uint16_t device_id, pci_device_t *dev)
                     continue;
                 }
 
-                uint16_t did = pci_config_read16((uint8_t)bus, slot, func, PCI_REG_DEVICE_ID);
-                if (vid == vendor_id && did == device_id) {
-                    dev->bus       = (uint8_t)bus;
-                    dev->slot      = slot;
-                    dev->func      = func;
-                    dev->vendor_id = vid;
-                    dev->device_id = did;
-                    dev->class_code = pci_config_read8((uint8_t)bus, slot, func, PCI_REG_CLASS);
-                    dev->subclass   = pci_config_read8((uint8_t)bus, slot, func, PCI_REG_SUBCLASS);
-                    dev->irq_line   = pci_config_read8((uint8_t)bus, slot, func, PCI_REG_IRQ_LINE);
-                    dev->bar0       = pci_config_read32((uint8_t)bus, slot, func, PCI_REG_BAR0);
-                    dev->present    = true;
+                bool match;
+                if (match_class) {
+                    match = pci_config_read8((uint8_t)bus, slot, func, PCI_REG_CLASS) == a &&
+                            pci_config_read8((uint8_t)bus, slot, func, PCI_REG_SUBCLASS) == b;
+                } else {
+                    match = vid == a &&
+                            pci_config_read16((uint8_t)bus, slot, func, PCI_REG_DEVICE_ID) == b;
+                }
+                if (match) {
+                    pci_fill_device((uint8_t)bus, slot, func, dev);
                     return true;
                 }
 
@@ -109,6 +124,20 @@ bool pci_find_device(uint16_t vendor_id, uint16_t device_id, pci_device_t *dev)
     return false;
 }
 
+// ============================================================
+// pci_find_device — scan do barramento para achar vendor:device
+// ============================================================
+bool pci_find_device(uint16_t vendor_id, uint16_t device_id, pci_device_t *dev) {
+    return pci_scan(false, vendor_id, device_id, dev);
+}
+
+// ============================================================
+// pci_find_class — scan do barramento para achar class:subclass
+// ============================================================
+bool pci_find_class(uint8_t class_code, uint8_t subclass, pci_device_t *dev) {
+    return pci_scan(true, class_code, subclass, dev);
+}
+
 // ============================================================
 // pci_enable_bus_mastering — habilita DMA para um device
 // ============================================================
@@ -69,6 +69,10 @@ uint8_t pci_config_read8(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset
 // Retorna true se encontrado, preenche *dev
 bool pci_find_device(uint16_t vendor_id, uint16_t device_id, pci_device_t *dev);
 
+// Busca o primeiro dispositivo com class_code e subclass dados
+// Retorna true se encontrado, preenche *dev
+bool pci_find_class(uint8_t class_code, uint8_t subclass, pci_device_t *dev);
+
 // Habilita Bus Mastering (DMA) para um dispositivo
 void pci_enable_bus_mastering(pci_device_t *dev);
 
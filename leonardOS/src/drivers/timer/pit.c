@@ -10,6 +10,7 @@
 #include "../../drivers/pic/pic.h"
 #include "../../drivers/vga/vga.h"
 #include "../../common/colors.h"
+#include "../../memory/pmm.h"
 
 // ============================================================
 // PIT I/O Ports
@@ -71,8 +72,9 @@ void pit_sleep_ms(uint32_t ms) {
 
     uint32_t start = tick_count;
     while ((tick_count - start) < ticks_to_wait) {
-        // Halt CPU até próxima interrupção — economiza energia
-        asm volatile("hlt");
+        // Tempo ocioso: repõe o pool de frames zerados; sem trabalho,
+        // halt CPU até próxima interrupção — economiza energia
+        if (!pmm_zero_pool_refill()) asm volatile("hlt");
     }
 }
 
@@ -0,0 +1,444 @@
+// LeonardOS - Buffer Cache (cache de setores de disco)
+// Implementação: hash por LBA + lista LRU duplamente encadeada
+//
+// Estrutura:
+//   bcache_bufs[]    — headers estáticos (até BCACHE_MAX_BUFFERS)
+//   hash_table[]     — buckets com encadeamento simples (lba & mask)
+//   lru_head/tail    — head = usado mais recentemente, tail = vítima
+//   Dados de cada buffer apontam para um frame do PMM (8 setores/frame)
+//
+// Sem cache inicializado (ou com BLKDEV_F_NOCACHE), leitura/escrita vão
+// direto ao dispositivo de bloco.
+
+#include "bcache.h"
+#include "../memory/pmm.h"
+#include "../common/string.h"
+
+// ============================================================
+// Estado interno
+// ============================================================
+static bcache_buf_t  bcache_bufs[BCACHE_MAX_BUFFERS];
+static bcache_buf_t *hash_table[BCACHE_HASH_SIZE];
+static bcache_buf_t *lru_head = NULL;
+static bcache_buf_t *lru_tail = NULL;
+
+static uint32_t bcache_count = 0;
+static uint32_t bcache_frames = 0;
+static bool     bcache_ready = false;
+static bool     bcache_deferred = false;    // Init sem dispositivo cacheável
+
+// Estatísticas
+static uint32_t stat_hits = 0;
+static uint32_t stat_misses = 0;
+static uint32_t stat_writebacks = 0;
+static uint32_t stat_evictions = 0;
+static uint32_t stat_dirty = 0;
+static uint32_t stat_direct = 0;
+
+// Buffer de agrupamento para writeback de setores consecutivos
+static uint8_t flush_buf[BCACHE_FLUSH_BATCH * BCACHE_SECTOR_SIZE];
+
+// Lote de pedidos enfileirados no blkdev (sync / prefetch)
+static blk_request_t  batch_reqs[BLKDEV_QUEUE_DEPTH];
+static bcache_buf_t  *batch_bufs[BLKDEV_QUEUE_DEPTH];
+
+#define HASH(lba) ((lba) & (BCACHE_HASH_SIZE - 1))
+
+// ============================================================
+// Lista LRU
+// ============================================================
+
+static void lru_unlink(bcache_buf_t *b) {
+    if (b->lru_prev) b->lru_prev->lru_next = b->lru_next;
+    else lru_head = b->lru_next;
+    if (b->lru_next) b->lru_next->lru_prev = b->lru_prev;
+    else lru_tail = b->lru_prev;
+    b->lru_prev = b->lru_next = NULL;
+}
+
+static void lru_push_front(bcache_buf_t *b) {
+    b->lru_prev = NULL;
+    b->lru_next = lru_head;
+    if (lru_head) lru_head->lru_prev = b;
+    lru_head = b;
+    if (!lru_tail) lru_tail = b;
+}
+
+// Move para a frente (mais recente)
+static void lru_touch(bcache_buf_t *b) {
+    if (lru_head == b) return;
+    lru_unlink(b);
+    lru_push_front(b);
+}
+
+// ============================================================
+// Tabela hash
+// ============================================================
+
+static bcache_buf_t *hash_lookup(blkdev_t *dev, uint32_t lba) {
+    bcache_buf_t *b = hash_table[HASH(lba)];
+    while (b) {
+        if (b->valid && b->lba == lba && b->dev == dev) return b;
+        b = b->hash_next;
+    }
+    return NULL;
+}
+
+static void hash_insert(bcache_buf_t *b) {
+    uint32_t h = HASH(b->lba);
+    b->hash_next = hash_table[h];
+    hash_table[h] = b;
+}
+
+static void hash_remove(bcache_buf_t *b) {
+    bcache_buf_t **pp = &hash_table[HASH(b->lba)];
+    while (*pp) {
+        if (*pp == b) {
+            *pp = b->hash_next;
+            b->hash_next = NULL;
+            return;
+        }
+        pp = &(*pp)->hash_next;
+    }
+}
+
+// ============================================================
+// Writeback
+// ============================================================
+
+static void mark_clean(bcache_buf_t *b) {
+    if (b->dirty) {
+        b->dirty = 0;
+        if (stat_dirty > 0) stat_dirty--;
+    }
+}
+
+static void mark_dirty(bcache_buf_t *b) {
+    if (!b->dirty) {
+        b->dirty = 1;
+        stat_dirty++;
+    }
+}
+
+// Grava um buffer sujo junto com os vizinhos consecutivos também sujos
+// (até BCACHE_FLUSH_BATCH setores num só pedido ao dispositivo)
+static bool writeback_run(bcache_buf_t *first) {
+    bcache_buf_t *run[BCACHE_FLUSH_BATCH];
+    uint32_t n = 0;
+
+    run[n++] = first;
+    while (n < BCACHE_FLUSH_BATCH) {
+        bcache_buf_t *next = hash_lookup(first->dev, first->lba + n);
+        if (!next || !next->dirty) break;
+        run[n++] = next;
+    }
+
+    bool ok;
+    if (n == 1) {
+        ok = blkdev_write(first->dev, first->lba, 1, first->data);
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            kmemcpy(flush_buf + i * BCACHE_SECTOR_SIZE, run[i]->data, BCACHE_SECTOR_SIZE);
+        }
+        ok = blkdev_write(first->dev, first->lba, (uint16_t)n, flush_buf);
+    }
+
+    if (!ok) return false;
+
+    for (uint32_t i = 0; i < n; i++) mark_clean(run[i]);
+    stat_writebacks += n;
+    return true;
+}
+
+// ============================================================
+// Obtém um buffer para lba (hit ou reciclado do LRU)
+// ============================================================
+static bcache_buf_t *get_buffer(blkdev_t *dev, uint32_t lba, bool *hit) {
+    bcache_buf_t *b = hash_lookup(dev, lba);
+    if (b) {
+        *hit = true;
+        lru_touch(b);
+        return b;
+    }
+
+    *hit = false;
+
+    // Vítima: buffer menos recente
+    b = lru_tail;
+    if (!b) return NULL;
+
+    if (b->valid) {
+        if (b->dirty && !writeback_run(b)) return NULL;
+        hash_remove(b);
+        stat_evictions++;
+    }
+
+    b->dev = dev;
+    b->lba = lba;
+    b->valid = 1;
+    b->dirty = 0;
+    hash_insert(b);
+    lru_touch(b);
+    return b;
+}
+
+// Descarta um buffer (volta para o fim do LRU como livre)
+static void drop_buffer(bcache_buf_t *b) {
+    hash_remove(b);
+    mark_clean(b);
+    b->valid = 0;
+    lru_unlink(b);
+    // Insere no fim: será o próximo reciclado
+    b->lru_prev = lru_tail;
+    b->lru_next = NULL;
+    if (lru_tail) lru_tail->lru_next = b;
+    lru_tail = b;
+    if (!lru_head) lru_head = b;
+}
+
+// ============================================================
+// bcache_alloc — Aloca buffers a partir dos frames livres
+// ============================================================
+// Frames abaixo de 16MB: os dados são acessados pelo endereço físico
+static bool bcache_alloc(void) {
+    bcache_deferred = false;
+    struct pmm_stats ps = pmm_get_stats();
+    uint32_t sectors_per_frame = PMM_FRAME_SIZE / BCACHE_SECTOR_SIZE;
+    uint32_t target = (ps.free_frames / BCACHE_RAM_DIVISOR) * sectors_per_frame;
+    if (target < BCACHE_MIN_BUFFERS) target = BCACHE_MIN_BUFFERS;
+    if (target > BCACHE_MAX_BUFFERS) target = BCACHE_MAX_BUFFERS;
+
+    while (bcache_count < target) {
+        uint32_t frame = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+        if (frame == 0) break;
+        bcache_frames++;
+
+        for (uint32_t s = 0; s < sectors_per_frame && bcache_count < target; s++) {
+            bcache_buf_t *b = &bcache_bufs[bcache_count++];
+            kmemset(b, 0, sizeof(bcache_buf_t));
+            b->data = (uint8_t *)(uintptr_t)(frame + s * BCACHE_SECTOR_SIZE);
+            lru_push_front(b);
+        }
+    }
+
+    bcache_ready = (bcache_count > 0);
+    return bcache_ready;
+}
+
+// Primeiro acesso a um dispositivo cacheável depois de um init adiado
+static bool bcache_use(blkdev_t *dev) {
+    if (dev->flags & BLKDEV_F_NOCACHE) return false;
+    if (!bcache_ready && bcache_deferred) bcache_alloc();
+    return bcache_ready;
+}
+
+// ============================================================
+// bcache_init — Dimensiona o cache (ou adia até haver o que cachear)
+// ============================================================
+bool bcache_init(void) {
+    bcache_count = 0;
+    bcache_frames = 0;
+    bcache_ready = false;
+    lru_head = lru_tail = NULL;
+    kmemset(hash_table, 0, sizeof(hash_table));
+
+    // Só RAM disk (NOCACHE): frames ficariam parados; aloca no primeiro
+    // acesso a um dispositivo cacheável
+    for (int i = 0; i < blkdev_count(); i++) {
+        blkdev_t *dev = blkdev_get(i);
+        if (dev && !(dev->flags & BLKDEV_F_NOCACHE)) return bcache_alloc();
+    }
+    bcache_deferred = true;
+    return false;
+}
+
+// ============================================================
+// bcache_read_sectors — Leitura via cache
+// ============================================================
+bool bcache_read_sectors(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer) {
+    if (!dev || !buffer || count == 0) return false;
+    if (!bcache_use(dev)) return blkdev_read(dev, lba, count, buffer);
+
+    uint8_t *dst = (uint8_t *)buffer;
+
+    // Quantos setores do intervalo já estão em cache?
+    uint32_t cached = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (hash_lookup(dev, lba + i)) cached++;
+    }
+
+    if (count > 1 && cached < count) {
+        // Um único pedido multi-setor direto para o buffer do chamador
+        if (!blkdev_read(dev, lba, count, dst)) return false;
+        stat_direct += count - cached;
+        stat_misses += count - cached;
+        stat_hits += cached;
+
+        // Cópias em cache podem estar sujas (mais novas que o disco): sobrepõe
+        // antes de qualquer evicção mexer nelas
+        for (uint32_t i = 0; i < count; i++) {
+            bcache_buf_t *b = hash_lookup(dev, lba + i);
+            if (b) {
+                kmemcpy(dst + i * BCACHE_SECTOR_SIZE, b->data, BCACHE_SECTOR_SIZE);
+                lru_touch(b);
+            }
+        }
+
+        // Intervalos pequenos entram no cache (releitura de arquivos pequenos)
+        if (count <= BCACHE_FILL_MAX) {
+            for (uint32_t i = 0; i < count; i++) {
+                bool hit;
+                bcache_buf_t *b = get_buffer(dev, lba + i, &hit);
+                if (b && !hit) {
+                    kmemcpy(b->data, dst + i * BCACHE_SECTOR_SIZE, BCACHE_SECTOR_SIZE);
+                }
+            }
+        }
+        return true;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        bool hit;
+        bcache_buf_t *b = get_buffer(dev, lba + i, &hit);
+        if (!b) return false;
+
+        if (hit) {
+            stat_hits++;
+        } else {
+            stat_misses++;
+            if (!blkdev_read(dev, lba + i, 1, b->data)) {
+                drop_buffer(b);
+                return false;
+            }
+        }
+        kmemcpy(dst + i * BCACHE_SECTOR_SIZE, b->data, BCACHE_SECTOR_SIZE);
+    }
+    return true;
+}
+
+// ============================================================
+// bcache_write_sectors — Write-back (1 setor) ou direta (multi)
+// ============================================================
+bool bcache_write_sectors(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer) {
+    if (!dev || !buffer || count == 0) return false;
+    if (!bcache_use(dev)) return blkdev_write(dev, lba, count, buffer);
+
+    const uint8_t *src = (const uint8_t *)buffer;
+
+    if (count > 1) {
+        // Cópias em cache do intervalo saem antes do pedido: nenhuma versão
+        // suja antiga pode ser gravada depois por cima, nem lida depois
+        for (uint32_t i = 0; i < count; i++) {
+            bcache_buf_t *b = hash_lookup(dev, lba + i);
+            if (b) drop_buffer(b);
+        }
+
+        // Um único pedido multi-setor direto do buffer do chamador
+        if (!blkdev_write(dev, lba, count, src)) return false;
+        stat_direct += count;
+        return true;
+    }
+
+    bool hit;
+    bcache_buf_t *b = get_buffer(dev, lba, &hit);
+    if (!b) return false;
+    if (hit) stat_hits++;
+
+    // Setor inteiro sobrescrito: não precisa ler do disco
+    kmemcpy(b->data, src, BCACHE_SECTOR_SIZE);
+    mark_dirty(b);
+    return true;
+}
+
+// Prepara batch_reqs[n] para um pedido de 1 setor sobre o buffer b
+static blk_request_t *batch_add(uint32_t n, uint8_t type, bcache_buf_t *b) {
+    blk_request_t *req = &batch_reqs[n];
+    kmemset(req, 0, sizeof(blk_request_t));
+    req->type = type;
+    req->lba = b->lba;
+    req->count = 1;
+    req->buffer = b->data;
+    batch_bufs[n] = b;
+    return req;
+}
+
+// ============================================================
+// bcache_sync — Grava os buffers sujos (de dev, ou de todos se NULL)
+// ============================================================
+bool bcache_sync(blkdev_t *dev) {
+    if (!bcache_ready) return true;
+
+    bool ok = true;
+    // Um dispositivo por vez: cada lote vai inteiro para a mesma fila,
+    // que ordena por LBA e junta os setores adjacentes
+    for (int d = 0; d < blkdev_count(); d++) {
+        blkdev_t *bd = blkdev_get(d);
+        if (dev && bd != dev) continue;
+
+        uint32_t i = 0;
+        while (i < bcache_count) {
+            uint32_t n = 0;
+            for (; i < bcache_count && n < BLKDEV_QUEUE_DEPTH; i++) {
+                bcache_buf_t *b = &bcache_bufs[i];
+                if (!b->valid || !b->dirty || b->dev != bd) continue;
+                blkdev_queue(bd, batch_add(n++, BLK_REQ_WRITE, b));
+            }
+            if (n == 0) break;
+
+            blkdev_wait(bd);
+            for (uint32_t k = 0; k < n; k++) {
+                if (batch_reqs[k].ok) {
+                    mark_clean(batch_bufs[k]);
+                    stat_writebacks++;
+                } else {
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+// ============================================================
+// bcache_prefetch — Leitura antecipada em lote
+// ============================================================
+void bcache_prefetch(blkdev_t *dev, const uint32_t *lbas, uint32_t n) {
+    if (!dev || !lbas || !bcache_use(dev)) return;
+
+    uint32_t i = 0;
+    while (i < n) {
+        // Lote menor que o cache: buffers recém-obtidos (frente do LRU)
+        // não são reciclados antes do blkdev_wait
+        uint32_t queued = 0;
+        for (; i < n && queued < BLKDEV_QUEUE_DEPTH; i++) {
+            bool hit;
+            if (hash_lookup(dev, lbas[i])) continue;
+            bcache_buf_t *b = get_buffer(dev, lbas[i], &hit);
+            if (!b) break;
+            stat_misses++;
+            blkdev_queue(dev, batch_add(queued++, BLK_REQ_READ, b));
+        }
+        if (queued == 0) break;
+
+        blkdev_wait(dev);
+        for (uint32_t k = 0; k < queued; k++) {
+            if (!batch_reqs[k].ok) drop_buffer(batch_bufs[k]);
+        }
+    }
+}
+
+// ============================================================
+// bcache_get_stats — Retorna estatísticas
+// ============================================================
+bcache_stats_t bcache_get_stats(void) {
+    bcache_stats_t st;
+    st.buffers = bcache_count;
+    st.frames = bcache_frames;
+    st.hits = stat_hits;
+    st.misses = stat_misses;
+    st.writebacks = stat_writebacks;
+    st.evictions = stat_evictions;
+    st.dirty = stat_dirty;
+    st.direct = stat_direct;
+    return st;
+}
@@ -0,0 +1,112 @@
+// LeonardOS - Buffer Cache (cache de setores de disco)
+// Camada write-back entre LeonFS e os dispositivos de bloco (blkdev)
+//
+// Cada buffer guarda 1 setor (512 bytes) de um dispositivo. Lookup por hash do LBA,
+// substituição LRU, escrita adiada (dirty) até bcache_sync() ou evicção.
+//
+// Política de write-back: escrever um setor só copia para o buffer e marca
+// sujo. Setores sujos vão para o disco apenas
+//   - na evicção (o LRU recicla um buffer sujo),
+//   - em bcache_sync(): comando sync, halt/reboot, format e leonfs_sync
+//     (que o LeonFS chama no fim de cada operação que altera o FS).
+// A memória dos buffers vem de frames do PMM abaixo de 16MB (8 setores por
+// frame), dimensionada a partir dos frames livres no boot, ou no primeiro
+// acesso a um dispositivo cacheável se no boot só havia RAM disk.
+// Dispositivos com BLKDEV_F_NOCACHE (RAM disk) são acessados direto.
+// bcache_sync e bcache_prefetch enfileiram lotes de pedidos de 1 setor na
+// fila do blkdev (elevador) e esperam uma vez: setores adjacentes viram um
+// único comando.
+// API: bcache_init, bcache_read_sectors, bcache_write_sectors, bcache_sync,
+//      bcache_prefetch
+
+#ifndef __BCACHE_H__
+#define __BCACHE_H__
+
+#include "../common/types.h"
+#include "../drivers/disk/blkdev.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+#define BCACHE_SECTOR_SIZE   512
+#define BCACHE_HASH_SIZE     256     // Buckets da tabela hash (potência de 2)
+
+// Dimensionamento: 1/256 dos frames livres, limitado a [64, 2048] setores
+#define BCACHE_RAM_DIVISOR   256
+#define BCACHE_MIN_BUFFERS   64      // 32KB
+#define BCACHE_MAX_BUFFERS   2048    // 1MB
+
+// Setores consecutivos agrupados num único comando no writeback
+#define BCACHE_FLUSH_BATCH   8
+
+// Leituras multi-setor vão direto ao buffer do chamador num só comando;
+// só intervalos até este tamanho são copiados para o cache (evita poluir
+// o LRU com leituras sequenciais grandes)
+#define BCACHE_FILL_MAX      16
+
+// ============================================================
+// Estruturas
+// ============================================================
+
+typedef struct bcache_buf {
+    blkdev_t *dev;                  // Dispositivo do setor
+    uint32_t lba;                   // Setor em cache
+    uint8_t *data;                  // 512 bytes (dentro de um frame do PMM)
+    uint8_t  valid;                 // 1 = contém dados do setor lba
+    uint8_t  dirty;                 // 1 = modificado, precisa writeback
+    uint8_t  _pad[2];
+    struct bcache_buf *hash_next;   // Encadeamento no bucket
+    struct bcache_buf *lru_prev;    // Lista LRU (head = mais recente)
+    struct bcache_buf *lru_next;
+} bcache_buf_t;
+
+typedef struct {
+    uint32_t buffers;       // Buffers (setores) disponíveis
+    uint32_t frames;        // Frames do PMM usados
+    uint32_t hits;          // Leituras/escritas atendidas pelo cache
+    uint32_t misses;        // Leituras que foram ao disco
+    uint32_t writebacks;    // Setores gravados no disco
+    uint32_t evictions;     // Buffers reciclados pelo LRU
+    uint32_t direct;        // Setores transferidos direto (multi-setor)
+    uint32_t dirty;         // Buffers sujos no momento
+} bcache_stats_t;
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Inicializa o cache — aloca frames do PMM conforme memória livre, se há
+// algum blkdev sem BLKDEV_F_NOCACHE; senão adia a alocação até o primeiro
+// acesso a um dispositivo assim. Chamar depois de pmm_init()/heap_init()
+// e do registro dos dispositivos
+// Retorna true se algum buffer foi alocado agora (senão opera direto no blkdev)
+bool bcache_init(void);
+
+// Lê count setores de dev a partir de lba (via cache)
+// count > 1 sem todos os setores em cache: um único pedido direto ao
+// dispositivo, depois sobrepõe as cópias em cache (mais recentes)
+// Retorna true se sucesso
+bool bcache_read_sectors(blkdev_t *dev, uint32_t lba, uint16_t count, void *buffer);
+
+// Escreve count setores em dev a partir de lba
+// count == 1: write-back (só marca sujo)
+// count > 1: descarta as cópias em cache do intervalo e faz um único pedido
+// direto do buffer do chamador
+// Retorna true se sucesso
+bool bcache_write_sectors(blkdev_t *dev, uint32_t lba, uint16_t count, const void *buffer);
+
+// Grava os buffers sujos de dev (NULL = todos os dispositivos)
+// Lotes de até BLKDEV_QUEUE_DEPTH setores por blkdev_wait
+// Retorna true se todos foram gravados
+bool bcache_sync(blkdev_t *dev);
+
+// Traz para o cache os setores de lbas[0..n-1] que ainda não estão lá
+// (ex: blocos de um diretório antes da varredura). Pedidos vão juntos
+// para a fila do dispositivo. Falhas só descartam o buffer
+void bcache_prefetch(blkdev_t *dev, const uint32_t *lbas, uint32_t n);
+
+// Retorna estatísticas do cache
+bcache_stats_t bcache_get_stats(void);
+
+#endif
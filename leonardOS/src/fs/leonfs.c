@@ -1,14 +1,18 @@
 // LeonardOS - LeonFS (Filesystem persistente em disco)
-// Implementação do backend VFS para disco ATA
+// Implementação do backend VFS sobre um dispositivo de bloco (blkdev)
 //
 // Estratégia:
-//   - Superbloco cached em RAM (flush após mudanças)
-//   - Inodes lidos sob demanda do disco
-//   - Bitmap de blocos cached parcialmente
+//   - Superbloco cached em RAM (flush nos pontos de sync)
+//   - Tabela de inodes inteira em RAM (32KB), setores sujos gravados no sync
+//   - Bitmap de blocos inteiro em RAM (4KB), flush em lote nos pontos de sync
 //   - Pool de vfs_node_t em RAM (cache de nós abertos)
+//   - Setores passam pelo buffer cache (bcache)
+//   - Cada operação que altera o FS (write/create/mkdir/remove) termina numa
+//     barreira: metadados e setores sujos da operação vão para o disco e um
+//     único blkdev_flush os torna persistentes (desligar a VM não perde nada)
 
 #include "leonfs.h"
-#include "../drivers/disk/ide.h"
+#include "bcache.h"
 #include "../common/string.h"
 #include "../common/io.h"
 
@@ -17,6 +21,7 @@
 // ============================================================
 static leonfs_superblock_t superblock;
 static bool fs_mounted = false;
+static blkdev_t *lfs_dev = NULL;         // Dispositivo montado
 
 // Pool de nós VFS para LeonFS (cache de nós abertos)
 #define LEONFS_NODE_POOL_SIZE 64
@@ -27,28 +32,39 @@ static uint32_t     lfs_pool_used = 0;
 // Buffer temporário para operações de disco (1 setor)
 static uint8_t sector_buf[512];
 
-// ============================================================
-// Helpers de disco
-// ============================================================
+// Bitmap de blocos em RAM (8 setores = 4KB = 1024 words de 32 bits)
+// Word w, bit b → bloco (w * 32 + b) — mesmo layout do disco em little-endian
+#define LEONFS_BITMAP_WORDS (LEONFS_BITMAP_SECTORS * LEONFS_BLOCK_SIZE / 4)
+static uint32_t block_bitmap[LEONFS_BITMAP_WORDS];
+static uint32_t bitmap_dirty_mask = 0;   // Bit s = setor s do bitmap precisa flush
+static uint32_t block_alloc_hint = 0;    // Cursor next-fit (próximo bloco a tentar)
+static bool     sb_dirty = false;        // Superbloco precisa flush
 
-// Lê um setor do disco para o buffer global
-static bool read_sector(uint32_t sector) {
-    return ide_read_sectors(sector, 1, sector_buf);
-}
+// Tabela de inodes em RAM (64 setores × 8 inodes = 512 inodes × 64 bytes)
+#define LEONFS_INODES_PER_SECTOR (LEONFS_BLOCK_SIZE / sizeof(leonfs_inode_t))
+static leonfs_inode_t inode_table[LEONFS_MAX_INODES];
+static uint32_t inode_dirty_map[LEONFS_INODE_SECTORS / 32]; // Bit s = setor s sujo
+static uint32_t inode_used_map[LEONFS_MAX_INODES / 32];     // Bit i = inode i em uso
 
-// Escreve o buffer global para um setor do disco
-static bool write_sector(uint32_t sector) {
-    return ide_write_sectors(sector, 1, sector_buf);
-}
+// ============================================================
+// Helpers de disco (todo acesso passa pelo buffer cache)
+// ============================================================
 
 // Lê um setor do disco para um buffer específico
 static bool read_sector_to(uint32_t sector, void *buf) {
-    return ide_read_sectors(sector, 1, buf);
+    return bcache_read_sectors(lfs_dev, sector, 1, buf);
 }
 
 // Escreve de um buffer específico para um setor do disco
 static bool write_sector_from(uint32_t sector, const void *buf) {
-    return ide_write_sectors(sector, 1, buf);
+    return bcache_write_sectors(lfs_dev, sector, 1, buf);
+}
+
+// Índice do primeiro bit zero de uma word (word != 0xFFFFFFFF)
+static inline uint32_t bitmap_ffz(uint32_t word) {
+    uint32_t idx;
+    asm("bsf %1, %0" : "=r"(idx) : "r"(~word));
+    return idx;
 }
 
 // ============================================================
@@ -61,6 +77,7 @@ static bool superblock_read(void) {
 }
 
 static bool superblock_write(void) {
+    sb_dirty = false;
     return write_sector_from(LEONFS_SUPERBLOCK_SECTOR, &superblock);
 }
 
@@ -68,62 +85,93 @@ static bool superblock_write(void) {
 // Inodes
 // ============================================================
 
-// Calcula o setor e offset de um inode
-// Cada setor tem 512/64 = 8 inodes
-static void inode_location(uint32_t inode_num, uint32_t *sector, uint32_t *offset) {
-    *sector = LEONFS_INODE_START + (inode_num / 8);
-    *offset = (inode_num % 8) * sizeof(leonfs_inode_t);
+// A tabela inteira fica em RAM desde o mount. inode_write só marca o setor
+// (8 inodes) como sujo; inode_flush grava setores sujos consecutivos juntos.
+
+static inline void inode_mark_used(uint32_t inode_num, bool used) {
+    if (used) inode_used_map[inode_num / 32] |= (1u << (inode_num % 32));
+    else      inode_used_map[inode_num / 32] &= ~(1u << (inode_num % 32));
 }
 
-static bool inode_read(uint32_t inode_num, leonfs_inode_t *inode) {
-    if (inode_num >= LEONFS_MAX_INODES) return false;
+// Carrega a tabela de inodes e monta o bitmap de inodes livres
+static bool inode_table_load(void) {
+    kmemset(inode_dirty_map, 0, sizeof(inode_dirty_map));
+    kmemset(inode_used_map, 0, sizeof(inode_used_map));
 
-    uint32_t sec, off;
-    inode_location(inode_num, &sec, &off);
+    if (!bcache_read_sectors(lfs_dev, LEONFS_INODE_START, LEONFS_INODE_SECTORS, inode_table)) return false;
 
-    if (!read_sector(sec)) return false;
+    for (uint32_t i = 0; i < LEONFS_MAX_INODES; i++) {
+        if (inode_table[i].type != LEONFS_TYPE_FREE) inode_mark_used(i, true);
+    }
+    inode_mark_used(0, true); // raiz sempre reservada
+    return true;
+}
 
-    kmemcpy(inode, sector_buf + off, sizeof(leonfs_inode_t));
+// Grava setores sujos da tabela de inodes, agrupando setores consecutivos
+static bool inode_flush(void) {
+    bool ok = true;
+    uint32_t s = 0;
+    while (s < LEONFS_INODE_SECTORS) {
+        if (!(inode_dirty_map[s / 32] & (1u << (s % 32)))) {
+            s++;
+            continue;
+        }
+        uint32_t run = s;
+        while (run < LEONFS_INODE_SECTORS && (inode_dirty_map[run / 32] & (1u << (run % 32)))) run++;
+
+        if (bcache_write_sectors(lfs_dev, LEONFS_INODE_START + s, (uint16_t)(run - s),
+                                 &inode_table[s * LEONFS_INODES_PER_SECTOR])) {
+            for (uint32_t i = s; i < run; i++) inode_dirty_map[i / 32] &= ~(1u << (i % 32));
+        } else {
+            ok = false;
+        }
+        s = run;
+    }
+    return ok;
+}
+
+static bool inode_read(uint32_t inode_num, leonfs_inode_t *inode) {
+    if (inode_num >= LEONFS_MAX_INODES) return false;
+    kmemcpy(inode, &inode_table[inode_num], sizeof(leonfs_inode_t));
     return true;
 }
 
 static bool inode_write(uint32_t inode_num, const leonfs_inode_t *inode) {
     if (inode_num >= LEONFS_MAX_INODES) return false;
 
-    uint32_t sec, off;
-    inode_location(inode_num, &sec, &off);
-
-    // Lê setor atual (para não sobrescrever outros inodes)
-    if (!read_sector(sec)) return false;
+    kmemcpy(&inode_table[inode_num], inode, sizeof(leonfs_inode_t));
 
-    kmemcpy(sector_buf + off, inode, sizeof(leonfs_inode_t));
-
-    return write_sector(sec);
+    uint32_t sec = inode_num / LEONFS_INODES_PER_SECTOR;
+    inode_dirty_map[sec / 32] |= (1u << (sec % 32));
+    return true;
 }
 
 // Aloca um inode livre. Retorna inode_num ou (uint32_t)-1 se falhar.
-static uint32_t __attribute__((unused)) inode_alloc(void) {
-    leonfs_inode_t inode;
-    // Começa em 1 (0 = raiz, já alocada)
-    for (uint32_t i = 1; i < LEONFS_MAX_INODES; i++) {
-        if (!inode_read(i, &inode)) continue;
-        if (inode.type == LEONFS_TYPE_FREE) {
-            superblock.free_inodes--;
-            superblock_write();
-            return i;
-        }
+// Busca no bitmap de inodes em RAM — nenhum I/O.
+static uint32_t inode_alloc(void) {
+    for (uint32_t w = 0; w < LEONFS_MAX_INODES / 32; w++) {
+        if (inode_used_map[w] == 0xFFFFFFFF) continue;
+
+        uint32_t i = w * 32 + bitmap_ffz(inode_used_map[w]);
+        inode_mark_used(i, true);
+        superblock.free_inodes--;
+        sb_dirty = true;
+        return i;
     }
     return (uint32_t)-1;
 }
 
 // Libera um inode
-static void __attribute__((unused)) inode_free(uint32_t inode_num) {
+static void inode_free(uint32_t inode_num) {
+    if (inode_num == 0 || inode_num >= LEONFS_MAX_INODES) return;
+
     leonfs_inode_t inode;
     kmemset(&inode, 0, sizeof(leonfs_inode_t));
     inode.type = LEONFS_TYPE_FREE;
     inode_write(inode_num, &inode);
+    inode_mark_used(inode_num, false);
     superblock.free_inodes++;
-    superblock_write();
+    sb_dirty = true;
 }
 
 // ============================================================
@@ -132,56 +180,89 @@ static void __attribute__((unused)) inode_free(uint32_t inode_num) {
 
 // O bitmap cobre os blocos de dados (a partir de LEONFS_DATA_START)
 // Bit N → setor (LEONFS_DATA_START + N)
+// Fica inteiro em RAM desde o mount; alterações só marcam o setor como sujo.
 
-static bool block_bitmap_get(uint32_t block_num) {
-    uint32_t byte_idx = block_num / 8;
-    uint32_t bit_idx  = block_num % 8;
-    uint32_t bitmap_sector = LEONFS_BITMAP_START + (byte_idx / 512);
-    uint32_t sector_offset = byte_idx % 512;
-
-    if (!read_sector(bitmap_sector)) return true; // assume usado se erro
+// Carrega os 8 setores do bitmap para RAM (uma única leitura multi-setor)
+static bool bitmap_load(void) {
+    bitmap_dirty_mask = 0;
+    block_alloc_hint = 0;
+    return bcache_read_sectors(lfs_dev, LEONFS_BITMAP_START, LEONFS_BITMAP_SECTORS, block_bitmap);
+}
 
-    return (sector_buf[sector_offset] >> bit_idx) & 1;
+// Grava os setores sujos do bitmap, agrupando setores consecutivos num só comando
+static bool bitmap_flush(void) {
+    bool ok = true;
+    uint32_t s = 0;
+    while (s < LEONFS_BITMAP_SECTORS) {
+        if (!(bitmap_dirty_mask & (1u << s))) {
+            s++;
+            continue;
+        }
+        uint32_t run = s;
+        while (run < LEONFS_BITMAP_SECTORS && (bitmap_dirty_mask & (1u << run))) run++;
+
+        const uint8_t *src = (const uint8_t *)block_bitmap + s * LEONFS_BLOCK_SIZE;
+        if (bcache_write_sectors(lfs_dev, LEONFS_BITMAP_START + s, (uint16_t)(run - s), src)) {
+            for (uint32_t i = s; i < run; i++) bitmap_dirty_mask &= ~(1u << i);
+        } else {
+            ok = false;
+        }
+        s = run;
+    }
+    return ok;
 }
 
-static bool block_bitmap_set(uint32_t block_num, bool used) {
-    uint32_t byte_idx = block_num / 8;
-    uint32_t bit_idx  = block_num % 8;
-    uint32_t bitmap_sector = LEONFS_BITMAP_START + (byte_idx / 512);
-    uint32_t sector_offset = byte_idx % 512;
+static bool block_bitmap_get(uint32_t block_num) {
+    if (block_num >= LEONFS_MAX_BLOCKS) return true; // fora do range = usado
+    return (block_bitmap[block_num / 32] >> (block_num % 32)) & 1;
+}
 
-    if (!read_sector(bitmap_sector)) return false;
+static void block_bitmap_set(uint32_t block_num, bool used) {
+    if (block_num >= LEONFS_MAX_BLOCKS) return;
 
     if (used) {
-        sector_buf[sector_offset] |= (1 << bit_idx);
+        block_bitmap[block_num / 32] |= (1u << (block_num % 32));
     } else {
-        sector_buf[sector_offset] &= ~(1 << bit_idx);
+        block_bitmap[block_num / 32] &= ~(1u << (block_num % 32));
     }
 
-    return write_sector(bitmap_sector);
+    // 1 setor do bitmap = 4096 bits
+    bitmap_dirty_mask |= 1u << (block_num / (LEONFS_BLOCK_SIZE * 8));
 }
 
 // Aloca um bloco livre. Retorna número do bloco (offset no data area) ou -1.
+// Next-fit: varre words de 32 bits a partir do cursor, com wrap-around.
 static uint32_t block_alloc(void) {
     uint32_t max = superblock.total_blocks;
     if (max > LEONFS_MAX_BLOCKS) max = LEONFS_MAX_BLOCKS;
+    if (max == 0) return (uint32_t)-1;
 
-    for (uint32_t i = 0; i < max; i++) {
-        if (!block_bitmap_get(i)) {
-            block_bitmap_set(i, true);
-            superblock.free_blocks--;
-            superblock_write();
-            return i;
-        }
+    uint32_t words = (max + 31) / 32;
+    uint32_t w = block_alloc_hint / 32;
+    if (w >= words) w = 0;
+
+    for (uint32_t n = 0; n < words; n++, w++) {
+        if (w >= words) w = 0;
+        if (block_bitmap[w] == 0xFFFFFFFF) continue;
+
+        uint32_t block = w * 32 + bitmap_ffz(block_bitmap[w]);
+        if (block >= max) continue;  // bits além do fim do disco
+
+        block_bitmap_set(block, true);
+        superblock.free_blocks--;
+        sb_dirty = true;
+        block_alloc_hint = block + 1;
+        return block;
     }
     return (uint32_t)-1;
 }
 
 // Libera um bloco
-static void __attribute__((unused)) block_free(uint32_t block_num) {
+static void block_free(uint32_t block_num) {
+    if (!block_bitmap_get(block_num)) return;
     block_bitmap_set(block_num, false);
     superblock.free_blocks++;
-    superblock_write();
+    sb_dirty = true;
 }
 
 // Converte block_num (relativo ao data area) para setor absoluto
@@ -255,6 +336,40 @@ static uint32_t node_inode_num(vfs_node_t *node) {
 // Helpers para resolver bloco por índice (direto ou indireto)
 // ============================================================
 
+// Cache do último bloco indireto lido (128 ponteiros)
+// Evita reler o bloco indireto a cada block_idx num mesmo read/write.
+// Bloco 0 nunca é indireto (reservado pela raiz no format) → 0 = vazio.
+// Alterações nos ponteiros ficam no cache (ind_cache_dirty) até ind_flush().
+static uint32_t ind_cache[LEONFS_INDIRECT_PTRS];
+static uint32_t ind_cache_block = 0;
+static bool     ind_cache_dirty = false;
+
+// Grava o bloco indireto em cache, se alterado
+static bool ind_flush(void) {
+    if (!ind_cache_dirty || ind_cache_block == 0) return true;
+    if (!write_sector_from(block_to_sector(ind_cache_block), ind_cache)) return false;
+    ind_cache_dirty = false;
+    return true;
+}
+
+// Descarta o cache (ex: bloco indireto foi liberado)
+static void ind_invalidate(void) {
+    ind_cache_block = 0;
+    ind_cache_dirty = false;
+}
+
+// Carrega os ponteiros de um bloco indireto (usa o cache se for o mesmo)
+static uint32_t *ind_load(uint32_t ind_block) {
+    if (ind_cache_block == ind_block) return ind_cache;
+    if (!ind_flush()) return NULL;
+    if (!read_sector_to(block_to_sector(ind_block), ind_cache)) {
+        ind_cache_block = 0;
+        return NULL;
+    }
+    ind_cache_block = ind_block;
+    return ind_cache;
+}
+
 // Lê o número de bloco para um block_idx (direto: 0-9, indireto: 10+)
 // Retorna 0 se o bloco não está alocado
 static uint32_t inode_get_block(leonfs_inode_t *inode, uint32_t block_idx) {
@@ -266,11 +381,8 @@ static uint32_t inode_get_block(leonfs_inode_t *inode, uint32_t block_idx) {
     uint32_t indirect_idx = block_idx - LEONFS_DIRECT_BLOCKS;
     if (indirect_idx >= LEONFS_INDIRECT_PTRS) return 0;
 
-    uint8_t ind_buf[512];
-    uint32_t ind_sector = block_to_sector(inode->indirect_block);
-    if (!read_sector_to(ind_sector, ind_buf)) return 0;
-
-    uint32_t *ptrs = (uint32_t *)ind_buf;
+    uint32_t *ptrs = ind_load(inode->indirect_block);
+    if (!ptrs) return 0;
     return ptrs[indirect_idx];
 }
 
@@ -286,32 +398,61 @@ static bool inode_set_block(leonfs_inode_t *inode, uint32_t block_idx, uint32_t
     uint32_t indirect_idx = block_idx - LEONFS_DIRECT_BLOCKS;
     if (indirect_idx >= LEONFS_INDIRECT_PTRS) return false;
 
-    // Aloca bloco indireto se necessário
+    uint32_t *ptrs;
+
+    // Aloca bloco indireto se necessário (já nasce zerado no cache)
     if (inode->indirect_block == 0) {
+        if (!ind_flush()) return false;
         uint32_t new_ind = block_alloc();
         if (new_ind == (uint32_t)-1) return false;
         inode->indirect_block = new_ind;
-        // Zera o bloco indireto
-        kmemset(sector_buf, 0, LEONFS_BLOCK_SIZE);
-        write_sector_from(block_to_sector(new_ind), sector_buf);
+        kmemset(ind_cache, 0, sizeof(ind_cache));
+        ind_cache_block = new_ind;
+        ptrs = ind_cache;
+    } else {
+        ptrs = ind_load(inode->indirect_block);
+        if (!ptrs) return false;
     }
 
-    uint8_t ind_buf[512];
-    uint32_t ind_sector = block_to_sector(inode->indirect_block);
-    if (!read_sector_to(ind_sector, ind_buf)) return false;
-
-    uint32_t *ptrs = (uint32_t *)ind_buf;
     ptrs[indirect_idx] = block_num;
-    return write_sector_from(ind_sector, ind_buf);
+    ind_cache_dirty = true;
+    return true;
 }
 
 // Número máximo de blocos que um inode suporta
 #define LEONFS_MAX_BLOCKS_PER_INODE (LEONFS_DIRECT_BLOCKS + LEONFS_INDIRECT_PTRS)
 
+// Máximo de setores num único pedido ao bcache/IDE (contagem de 16 bits)
+#define LEONFS_MAX_RUN 65535
+
+// Conta quantos blocos a partir de block_idx são fisicamente contíguos
+// (até max). Preenche *first_blk. Retorna 0 se block_idx não está alocado.
+static uint32_t inode_block_run(leonfs_inode_t *inode, uint32_t block_idx,
+                                uint32_t max, uint32_t *first_blk) {
+    uint32_t blk = inode_get_block(inode, block_idx);
+    if (blk == 0) return 0;
+
+    if (max > LEONFS_MAX_RUN) max = LEONFS_MAX_RUN;
+    uint32_t n = 1;
+    while (n < max && block_idx + n < LEONFS_MAX_BLOCKS_PER_INODE &&
+           inode_get_block(inode, block_idx + n) == blk + n) {
+        n++;
+    }
+
+    *first_blk = blk;
+    return n;
+}
+
 // ============================================================
 // Callbacks VFS — Arquivo
 // ============================================================
 
+// Fim de uma operação que altera o FS: barreira. Metadados sujos em RAM e os
+// setores que a operação sujou no bcache são gravados juntos, com um FLUSH
+static void leonfs_op_done(void) {
+    leonfs_sync();
+}
+
 static uint32_t leonfs_vfs_read(vfs_node_t *node, uint32_t offset, uint32_t size, uint8_t *buffer) {
     if (!node || !buffer || !(node->type & VFS_FILE)) return 0;
 
@@ -329,8 +470,23 @@ static uint32_t leonfs_vfs_read(vfs_node_t *node, uint32_t offset, uint32_t size
         uint32_t file_offset = offset + bytes_read;
         uint32_t block_idx = file_offset / LEONFS_BLOCK_SIZE;
         uint32_t block_off = file_offset % LEONFS_BLOCK_SIZE;
+        uint32_t remaining = size - bytes_read;
 
         if (block_idx >= LEONFS_MAX_BLOCKS_PER_INODE) break;
+
+        // Blocos inteiros alinhados: lê a sequência contígua num só comando,
+        // direto no buffer do chamador
+        if (block_off == 0 && remaining >= LEONFS_BLOCK_SIZE) {
+            uint32_t first;
+            uint32_t run = inode_block_run(&inode, block_idx, remaining / LEONFS_BLOCK_SIZE, &first);
+            if (run == 0) break;
+
+            if (!bcache_read_sectors(lfs_dev, block_to_sector(first), (uint16_t)run, buffer + bytes_read)) break;
+            bytes_read += run * LEONFS_BLOCK_SIZE;
+            continue;
+        }
+
+        // Bloco parcial (início desalinhado ou cauda): via sector_buf
         uint32_t blk = inode_get_block(&inode, block_idx);
         if (blk == 0) break;
 
@@ -339,7 +495,7 @@ static uint32_t leonfs_vfs_read(vfs_node_t *node, uint32_t offset, uint32_t size
 
         // Quantos bytes podemos ler deste bloco?
         uint32_t chunk = LEONFS_BLOCK_SIZE - block_off;
-        if (chunk > size - bytes_read) chunk = size - bytes_read;
+        if (chunk > remaining) chunk = remaining;
 
         kmemcpy(buffer + bytes_read, sector_buf + block_off, chunk);
         bytes_read += chunk;
@@ -362,38 +518,73 @@ static uint32_t leonfs_vfs_write(vfs_node_t *node, uint32_t offset, uint32_t siz
 
     uint32_t bytes_written = 0;
 
+    // Cada bloco de dados é gravado exatamente uma vez. Inode, bitmap,
+    // superbloco e ponteiros indiretos só mudam em RAM aqui e vão para
+    // o disco juntos na barreira do fim da operação (leonfs_op_done).
     while (bytes_written < size) {
         uint32_t file_offset = offset + bytes_written;
         uint32_t block_idx = file_offset / LEONFS_BLOCK_SIZE;
         uint32_t block_off = file_offset % LEONFS_BLOCK_SIZE;
+        uint32_t remaining = size - bytes_written;
 
         if (block_idx >= LEONFS_MAX_BLOCKS_PER_INODE) break;
 
-        // Aloca bloco se necessário
+        // Blocos inteiros: serão sobrescritos por completo, então blocos novos
+        // não precisam ser zerados nem lidos. Aloca o trecho todo e grava cada
+        // sequência contígua num só comando.
+        if (block_off == 0 && remaining >= LEONFS_BLOCK_SIZE) {
+            uint32_t nfull = remaining / LEONFS_BLOCK_SIZE;
+            if (nfull > LEONFS_MAX_BLOCKS_PER_INODE - block_idx) {
+                nfull = LEONFS_MAX_BLOCKS_PER_INODE - block_idx;
+            }
+
+            for (uint32_t i = 0; i < nfull; i++) {
+                if (inode_get_block(&inode, block_idx + i) != 0) continue;
+                uint32_t new_block = block_alloc();
+                if (new_block == (uint32_t)-1 ||
+                    !inode_set_block(&inode, block_idx + i, new_block)) {
+                    if (new_block != (uint32_t)-1) block_free(new_block);
+                    nfull = i;
+                    break;
+                }
+            }
+            if (nfull == 0) break;
+
+            uint32_t first;
+            uint32_t run = inode_block_run(&inode, block_idx, nfull, &first);
+            if (run == 0) break;
+
+            if (!bcache_write_sectors(lfs_dev, block_to_sector(first), (uint16_t)run,
+                                      buffer + bytes_written)) break;
+            bytes_written += run * LEONFS_BLOCK_SIZE;
+            continue;
+        }
+
+        // Bloco parcial (início desalinhado ou cauda)
+        uint32_t chunk = LEONFS_BLOCK_SIZE - block_off;
+        if (chunk > remaining) chunk = remaining;
+
         uint32_t blk = inode_get_block(&inode, block_idx);
         if (blk == 0) {
+            // Bloco novo: monta em RAM (zeros + dados), sem ler do disco
             uint32_t new_block = block_alloc();
             if (new_block == (uint32_t)-1) break;
-            if (!inode_set_block(&inode, block_idx, new_block)) break;
+            if (!inode_set_block(&inode, block_idx, new_block)) {
+                block_free(new_block);
+                break;
+            }
             blk = new_block;
-
-            // Zera o bloco novo
-            kmemset(sector_buf, 0, LEONFS_BLOCK_SIZE);
-            write_sector_from(block_to_sector(new_block), sector_buf);
+            // Só zera o que os dados não vão cobrir (início e cauda)
+            kmemset(sector_buf, 0, block_off);
+            kmemset(sector_buf + block_off + chunk, 0, LEONFS_BLOCK_SIZE - block_off - chunk);
+        } else {
+            // Bloco existente: read-modify-write
+            if (!read_sector_to(block_to_sector(blk), sector_buf)) break;
         }
 
-        uint32_t sector = block_to_sector(blk);
-
-        // Lê bloco atual (para não perder dados em escrita parcial)
-        if (!read_sector_to(sector, sector_buf)) break;
-
-        // Quantos bytes podemos escrever neste bloco?
-        uint32_t chunk = LEONFS_BLOCK_SIZE - block_off;
-        if (chunk > size - bytes_written) chunk = size - bytes_written;
-
         kmemcpy(sector_buf + block_off, buffer + bytes_written, chunk);
 
-        if (!write_sector_from(sector, sector_buf)) break;
+        if (!write_sector_from(block_to_sector(blk), sector_buf)) break;
 
         bytes_written += chunk;
     }
@@ -407,6 +598,8 @@ static uint32_t leonfs_vfs_write(vfs_node_t *node, uint32_t offset, uint32_t siz
     // Persiste inode
     inode_write(inum, &inode);
 
+    leonfs_op_done();
+
     // Atualiza cache VFS
     node->size = inode.size;
 
@@ -417,12 +610,25 @@ static uint32_t leonfs_vfs_write(vfs_node_t *node, uint32_t offset, uint32_t siz
 // Callbacks VFS — Diretório
 // ============================================================
 
+// Pede de uma vez todos os blocos diretos do diretório: a fila do blkdev
+// ordena e junta os adjacentes, e a varredura seguinte só acerta o cache
+static void dir_prefetch(const leonfs_inode_t *inode) {
+    uint32_t lbas[LEONFS_DIRECT_BLOCKS];
+    uint32_t n = 0;
+    for (uint32_t b = 0; b < LEONFS_DIRECT_BLOCKS; b++) {
+        if (inode->blocks[b] != 0) lbas[n++] = block_to_sector(inode->blocks[b]);
+    }
+    if (n > 1) bcache_prefetch(lfs_dev, lbas, n);
+}
+
 static vfs_node_t *leonfs_vfs_readdir(vfs_node_t *dir, uint32_t index) {
     if (!dir || !(dir->type & VFS_DIRECTORY)) return NULL;
 
     uint32_t inum = node_inode_num(dir);
     leonfs_inode_t inode;
     if (!inode_read(inum, &inode)) return NULL;
+    // Listagem chama readdir(0), readdir(1)...: prefetch só na primeira
+    if (index == 0) dir_prefetch(&inode);
 
     // Itera pelas entradas de diretório
     uint32_t entry_idx = 0;
@@ -463,6 +669,7 @@ static vfs_node_t *leonfs_vfs_finddir(vfs_node_t *dir, const char *name) {
     uint32_t inum = node_inode_num(dir);
     leonfs_inode_t inode;
     if (!inode_read(inum, &inode)) return NULL;
+    dir_prefetch(&inode);
 
     for (uint32_t b = 0; b < LEONFS_DIRECT_BLOCKS; b++) {
         if (inode.blocks[b] == 0) continue;
@@ -500,6 +707,7 @@ static vfs_node_t *leonfs_vfs_finddir(vfs_node_t *dir, const char *name) {
 static bool __attribute__((unused)) dir_add_entry(uint32_t dir_inum, uint32_t child_inum, const char *name) {
     leonfs_inode_t dir_inode;
     if (!inode_read(dir_inum, &dir_inode)) return false;
+    dir_prefetch(&dir_inode);
 
     // Procura slot vazio nos blocos existentes
     for (uint32_t b = 0; b < LEONFS_DIRECT_BLOCKS; b++) {
@@ -572,11 +780,11 @@ static bool __attribute__((unused)) dir_remove_entry(uint32_t dir_inum, const ch
 // leonfs_format — Formata o disco com LeonFS
 // ============================================================
 bool leonfs_format(void) {
-    const ide_disk_info_t *disk = ide_get_info();
-    if (!disk || !disk->present) return false;
+    uint32_t total_sectors = blkdev_size(lfs_dev);
+    if (total_sectors <= LEONFS_DATA_START) return false;
 
     // Calcula blocos de dados disponíveis
-    uint32_t data_sectors = disk->total_sectors - LEONFS_DATA_START;
+    uint32_t data_sectors = total_sectors - LEONFS_DATA_START;
     if (data_sectors > LEONFS_MAX_BLOCKS) data_sectors = LEONFS_MAX_BLOCKS;
 
     // --- Escreve superbloco ---
@@ -590,16 +798,16 @@ bool leonfs_format(void) {
     superblock.root_inode   = 0;
     superblock_write();
 
-    // --- Zera bitmap de blocos ---
-    kmemset(sector_buf, 0, 512);
-    for (uint32_t s = 0; s < LEONFS_BITMAP_SECTORS; s++) {
-        write_sector_from(LEONFS_BITMAP_START + s, sector_buf);
-    }
+    // --- Zera bitmap de blocos (em RAM, gravado inteiro abaixo) ---
+    kmemset(block_bitmap, 0, sizeof(block_bitmap));
+    bitmap_dirty_mask = (1u << LEONFS_BITMAP_SECTORS) - 1;
+    block_alloc_hint = 0;
 
-    // --- Zera tabela de inodes ---
-    for (uint32_t s = 0; s < LEONFS_INODE_SECTORS; s++) {
-        write_sector_from(LEONFS_INODE_START + s, sector_buf);
-    }
+    // --- Zera tabela de inodes (em RAM, gravada inteira abaixo) ---
+    kmemset(inode_table, 0, sizeof(inode_table));
+    kmemset(inode_dirty_map, 0xFF, sizeof(inode_dirty_map));
+    kmemset(inode_used_map, 0, sizeof(inode_used_map));
+    inode_mark_used(0, true);
 
     // --- Cria inode raiz (inode 0 = diretório raiz) ---
     leonfs_inode_t root_inode;
@@ -621,8 +829,12 @@ bool leonfs_format(void) {
     // Escreve inode raiz
     inode_write(0, &root_inode);
 
-    // Atualiza superbloco final
+    // Atualiza inodes, bitmap e superbloco finais e grava tudo no disco
+    inode_flush();
+    bitmap_flush();
     superblock_write();
+    bcache_sync(lfs_dev);
+    blkdev_flush(lfs_dev);
 
     return true;
 }
@@ -630,8 +842,12 @@ bool leonfs_format(void) {
 // ============================================================
 // leonfs_init — Inicializa LeonFS
 // ============================================================
-vfs_node_t *leonfs_init(void) {
+vfs_node_t *leonfs_init(blkdev_t *dev) {
+    if (!dev) return NULL;
+    lfs_dev = dev;
+    fs_mounted = false;
     lfs_pool_used = 0;
+    ind_invalidate();
     kmemset(lfs_node_pool, 0, sizeof(lfs_node_pool));
     kmemset(lfs_node_pool_inodes, 0, sizeof(lfs_node_pool_inodes));
 
@@ -643,6 +859,10 @@ vfs_node_t *leonfs_init(void) {
         if (!superblock_read()) return NULL;
     }
 
+    // Carrega bitmap de blocos e tabela de inodes inteiros para RAM
+    if (!bitmap_load()) return NULL;
+    if (!inode_table_load()) return NULL;
+
     fs_mounted = true;
 
     // Cria nó VFS para raiz
@@ -654,6 +874,21 @@ vfs_node_t *leonfs_init(void) {
     return root;
 }
 
+// ============================================================
+// leonfs_remount — Monta outro dispositivo no lugar do atual
+// ============================================================
+vfs_node_t *leonfs_remount(blkdev_t *dev) {
+    if (!dev) return NULL;
+    blkdev_t *old = fs_mounted ? lfs_dev : NULL;
+    if (old == dev) return &lfs_node_pool[0];
+    if (old) leonfs_sync();
+
+    // leonfs_init zera o pool: a raiz volta a ser lfs_node_pool[0]
+    vfs_node_t *root = leonfs_init(dev);
+    if (!root && old) leonfs_init(old);
+    return root;
+}
+
 // ============================================================
 // leonfs_create_file — Cria um arquivo em um diretório
 // ============================================================
@@ -687,6 +922,8 @@ vfs_node_t *leonfs_create_file(vfs_node_t *parent, const char *name) {
         return NULL;
     }
 
+    leonfs_op_done();
+
     // Cria nó VFS e retorna
     vfs_node_t *file = pool_alloc(new_inum);
     if (file) {
@@ -743,6 +980,8 @@ vfs_node_t *leonfs_create_dir(vfs_node_t *parent, const char *name) {
         return NULL;
     }
 
+    leonfs_op_done();
+
     // Cria nó VFS e retorna
     vfs_node_t *dir = pool_alloc(new_inum);
     if (dir) {
@@ -816,17 +1055,17 @@ bool leonfs_remove(vfs_node_t *parent, const char *name) {
     // Libera blocos indiretos
     if (target_inode.indirect_block != 0) {
         // Lê o bloco indireto para liberar os dados apontados
-        uint8_t ind_buf[512];
-        if (read_sector_to(block_to_sector(target_inode.indirect_block), ind_buf)) {
-            uint32_t *ptrs = (uint32_t *)ind_buf;
+        uint32_t *ptrs = ind_load(target_inode.indirect_block);
+        if (ptrs) {
             for (uint32_t i = 0; i < LEONFS_INDIRECT_PTRS; i++) {
                 if (ptrs[i] != 0) {
                     block_free(ptrs[i]);
                 }
             }
         }
-        // Libera o próprio bloco indireto
+        // Libera o próprio bloco indireto (e descarta do cache de ponteiros)
         block_free(target_inode.indirect_block);
+        ind_invalidate();
     }
 
     // Libera inode
@@ -835,6 +1074,8 @@ bool leonfs_remove(vfs_node_t *parent, const char *name) {
     // Remove entrada do diretório pai
     dir_remove_entry(parent_inum, name);
 
+    leonfs_op_done();
+
     // Invalida o nó no pool VFS (se existir)
     for (uint32_t i = 0; i < lfs_pool_used; i++) {
         if (lfs_node_pool_inodes[i] == target_inum && lfs_node_pool[i].type != 0) {
@@ -847,6 +1088,25 @@ bool leonfs_remove(vfs_node_t *parent, const char *name) {
     return true;
 }
 
+// ============================================================
+// leonfs_sync — Grava metadados pendentes (indireto + inodes + bitmap + superbloco)
+// e faz o flush do cache de escrita do disco
+// ============================================================
+bool leonfs_sync(void) {
+    if (!fs_mounted) return false;
+
+    bool ok = ind_flush();
+    ok = inode_flush() && ok;
+    ok = bitmap_flush() && ok;
+    if (sb_dirty) {
+        ok = superblock_write() && ok;
+    }
+    ok = bcache_sync(lfs_dev) && ok;
+
+    // Barreira: tira os dados do cache de escrita do disco (ponto de commit)
+    return blkdev_flush(lfs_dev) && ok;
+}
+
 // ============================================================
 // leonfs_get_superblock — Expõe o superbloco em cache
 // ============================================================
@@ -854,3 +1114,11 @@ leonfs_superblock_t *leonfs_get_superblock(void) {
     if (!fs_mounted) return NULL;
     return &superblock;
 }
+
+// ============================================================
+// leonfs_get_device — Dispositivo de bloco montado
+// ============================================================
+blkdev_t *leonfs_get_device(void) {
+    if (!fs_mounted) return NULL;
+    return lfs_dev;
+}
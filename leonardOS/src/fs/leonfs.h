@@ -1,5 +1,6 @@
 // LeonardOS - LeonFS (Filesystem persistente em disco)
-// Filesystem próprio do LeonardOS para discos ATA
+// Filesystem próprio do LeonardOS, sobre qualquer dispositivo de bloco
+// (disco IDE "hda", RAM disk "ram0", ...)
 //
 // Layout do disco:
 //   Setor 0       : Superbloco (512 bytes)
@@ -19,6 +20,7 @@
 
 #include "../common/types.h"
 #include "vfs.h"
+#include "../drivers/disk/blkdev.h"
 
 // ============================================================
 // Constantes do LeonFS
@@ -89,12 +91,17 @@ typedef struct __attribute__((packed)) {
 // API pública
 // ============================================================
 
-// Inicializa LeonFS — lê superbloco do disco
-// Se disco não tem LeonFS, formata automaticamente
+// Monta LeonFS no dispositivo dev — lê superbloco
+// Se o dispositivo não tem LeonFS, formata automaticamente
 // Retorna nó VFS raiz do LeonFS, ou NULL se falhar
-vfs_node_t *leonfs_init(void);
+vfs_node_t *leonfs_init(blkdev_t *dev);
 
-// Formata o disco com LeonFS vazio
+// Troca o dispositivo montado: sincroniza o atual e monta dev no mesmo nó
+// raiz (/mnt continua válido). Nós abertos abaixo da raiz são descartados.
+// Se dev falhar, volta ao dispositivo anterior e retorna NULL
+vfs_node_t *leonfs_remount(blkdev_t *dev);
+
+// Formata o dispositivo montado com LeonFS vazio
 // Cria superbloco, bitmap, inode root
 // Retorna true se sucesso
 bool leonfs_format(void);
@@ -114,8 +121,19 @@ bool leonfs_is_node(vfs_node_t *node);
 // Retorna true se removido com sucesso
 bool leonfs_remove(vfs_node_t *parent, const char *name);
 
+// Grava no disco os metadados pendentes em RAM (ponteiros indiretos, inodes,
+// bitmap de blocos, superbloco)
+// e todos os setores sujos do buffer cache, seguido de blkdev_flush() (barreira)
+// Chamada no fim de cada operação que altera o FS (write/create/mkdir/remove),
+// pelo comando sync e em halt/reboot
+// Retorna true se sucesso (false se não montado ou erro de I/O)
+bool leonfs_sync(void);
+
 // Retorna ponteiro para o superbloco do LeonFS em cache
 // Retorna NULL se LeonFS não foi montado
 leonfs_superblock_t *leonfs_get_superblock(void);
 
+// Retorna o dispositivo de bloco montado (NULL se não montado)
+blkdev_t *leonfs_get_device(void);
+
 #endif
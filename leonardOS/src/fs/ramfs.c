@@ -1,19 +1,30 @@
 // LeonardOS - RamFS (Filesystem em RAM)
 // Implementação do backend VFS para arquivos em memória
 //
-// Estratégia: pool estático de vfs_node_t + ramfs_data_t
-// para evitar fragmentação excessiva. Dados de arquivo
-// usam kmalloc sob demanda.
+// Estratégia: vfs_node_t + ramfs_data_t de cada nó saem juntos de um
+// slab cache (sem header por objeto, nós removidos são reaproveitados).
+// Dados de arquivo usam kmalloc sob demanda.
+//
+// Ponteiros de longa duração para nós: vfs_root (nunca removido),
+// current_dir do shell (rm recusa o diretório atual e seus ancestrais) e os
+// links pai/filhos daqui (só diretórios vazios saem). Comandos guardam nós
+// apenas durante a execução. Nós liberados são envenenados (type 0, sem
+// callbacks, sem fs_data): um ponteiro velho falha em todo vfs_* até o
+// slab reaproveitar o objeto.
 
 #include "ramfs.h"
 #include "../memory/heap.h"
+#include "../memory/slab.h"
 
 // ============================================================
-// Pool estático de nós
+// Cache de nós
 // ============================================================
-static vfs_node_t   node_pool[RAMFS_MAX_NODES];
-static ramfs_data_t data_pool[RAMFS_MAX_NODES];
-static uint32_t     pool_used = 0;
+typedef struct {
+    vfs_node_t   node;          // Primeiro campo: &rn->node == rn
+    ramfs_data_t data;
+} ramfs_node_t;
+
+static kmem_cache_t *node_cache = NULL;
 
 // ============================================================
 // Helpers internos
@@ -42,21 +53,28 @@ static void ramfs_memset(uint8_t *dst, uint8_t val, uint32_t n) {
 }
 
 // ============================================================
-// Aloca um nó do pool
+// Aloca / libera um nó do cache
 // ============================================================
 static vfs_node_t *ramfs_alloc_node(void) {
-    if (pool_used >= RAMFS_MAX_NODES) return NULL;
-
-    vfs_node_t   *node = &node_pool[pool_used];
-    ramfs_data_t *data = &data_pool[pool_used];
-    pool_used++;
+    ramfs_node_t *rn = (ramfs_node_t *)kmem_cache_alloc(node_cache);
+    if (!rn) return NULL;
 
     // Zera tudo
-    ramfs_memset((uint8_t *)node, 0, sizeof(vfs_node_t));
-    ramfs_memset((uint8_t *)data, 0, sizeof(ramfs_data_t));
+    ramfs_memset((uint8_t *)rn, 0, sizeof(ramfs_node_t));
+
+    rn->node.fs_data = &rn->data;
+    return &rn->node;
+}
+
+static void ramfs_free_node(vfs_node_t *node) {
+    // Envenena antes de devolver (o 1º word vira o link livre do slab)
+    ramfs_memset((uint8_t *)node, 0, sizeof(ramfs_node_t));
+    kmem_cache_free(node_cache, (ramfs_node_t *)node);
+}
 
-    node->fs_data = data;
-    return node;
+// Nó saiu do node_cache? (ex: a raiz do LeonFS pendurada em /mnt não)
+static bool ramfs_owns(vfs_node_t *node) {
+    return node->fs_data == &((ramfs_node_t *)node)->data;
 }
 
 // ============================================================
@@ -218,7 +236,10 @@ vfs_node_t *ramfs_create_file(vfs_node_t *parent, const char *name) {
 
     ramfs_setup_file(file, name);
 
-    if (!ramfs_add_child(parent, file)) return NULL;
+    if (!ramfs_add_child(parent, file)) {
+        ramfs_free_node(file);
+        return NULL;
+    }
 
     return file;
 }
@@ -235,7 +256,10 @@ vfs_node_t *ramfs_create_dir(vfs_node_t *parent, const char *name) {
 
     ramfs_setup_dir(dir, name);
 
-    if (!ramfs_add_child(parent, dir)) return NULL;
+    if (!ramfs_add_child(parent, dir)) {
+        ramfs_free_node(dir);
+        return NULL;
+    }
 
     return dir;
 }
@@ -262,6 +286,9 @@ bool ramfs_remove(vfs_node_t *parent, const char *name) {
 
     vfs_node_t *child = pd->children[found_idx];
 
+    // Ponto de montagem de outro FS: não é nosso para liberar
+    if (!ramfs_owns(child)) return false;
+
     // Se for diretório, deve estar vazio
     if (child->type & VFS_DIRECTORY) {
         ramfs_data_t *cd = (ramfs_data_t *)child->fs_data;
@@ -278,11 +305,6 @@ bool ramfs_remove(vfs_node_t *parent, const char *name) {
         }
     }
 
-    // Marca o nó como inválido (zera type)
-    child->type = 0;
-    child->size = 0;
-    child->name[0] = '\0';
-
     // Remove da lista de filhos (shift left)
     for (uint32_t i = (uint32_t)found_idx; i < pd->child_count - 1; i++) {
         pd->children[i] = pd->children[i + 1];
@@ -290,6 +312,9 @@ bool ramfs_remove(vfs_node_t *parent, const char *name) {
     pd->children[pd->child_count - 1] = NULL;
     pd->child_count--;
 
+    // Devolve o nó ao cache
+    ramfs_free_node(child);
+
     return true;
 }
 
@@ -297,7 +322,8 @@ bool ramfs_remove(vfs_node_t *parent, const char *name) {
 // ramfs_init — Cria o filesystem raiz com estrutura inicial
 // ============================================================
 vfs_node_t *ramfs_init(void) {
-    pool_used = 0;
+    node_cache = kmem_cache_create("ramfs_node", sizeof(ramfs_node_t));
+    if (!node_cache) return NULL;
 
     // Cria raiz "/"
     vfs_node_t *root = ramfs_alloc_node();
@@ -1,7 +1,8 @@
 // LeonardOS - RamFS (Filesystem em RAM)
 // Backend do VFS para arquivos e diretórios em memória
 //
-// Usa kmalloc/kfree para alocação.
+// Nós (vfs_node_t + ramfs_data_t) vêm do slab cache "ramfs_node";
+// dados de arquivo usam kmalloc/kfree.
 // Cada nó RamFS tem dados privados (ramfs_data_t) acessíveis via fs_data.
 // API: ramfs_init (retorna raiz montável no VFS)
 
@@ -20,9 +21,6 @@
 // Tamanho máximo de conteúdo de arquivo
 #define RAMFS_MAX_FILE_SIZE 4096
 
-// Máximo de nós alocáveis (pool estático para evitar fragmentação)
-#define RAMFS_MAX_NODES     64
-
 // ============================================================
 // Dados privados de cada nó RamFS
 // ============================================================
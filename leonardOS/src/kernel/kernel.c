@@ -13,6 +13,8 @@
 #include "fs/vfs.h"
 #include "fs/ramfs.h"
 #include "drivers/disk/ide.h"
+#include "drivers/disk/ramdisk.h"
+#include "fs/bcache.h"
 #include "fs/leonfs.h"
 #include "net/net_config.h"
 #include "net/ethernet.h"
@@ -85,8 +87,13 @@ void __attribute__((regparm(0))) kernel_main_32(unsigned int magic, void *multib
         vga_puts_color("Paging: identity map ", THEME_BOOT);
         vga_putint(vs.identity_map_mb);
         vga_puts_color("MB, ", THEME_BOOT);
-        vga_putint(vs.page_tables_used);
-        vga_puts_color(" page tables\n", THEME_BOOT);
+        if (vs.pse_enabled) {
+            vga_putint(vs.large_pages);
+            vga_puts_color(" paginas de 4MB (PSE)\n", THEME_BOOT);
+        } else {
+            vga_putint(vs.page_tables_used);
+            vga_puts_color(" page tables\n", THEME_BOOT);
+        }
     }
 
     // Inicializa Heap do Kernel (kmalloc/kfree)
@@ -95,8 +102,8 @@ void __attribute__((regparm(0))) kernel_main_32(unsigned int magic, void *multib
         struct heap_stats hs = heap_get_stats();
         vga_puts_color("[OK] ", THEME_BOOT_OK);
         vga_puts_color("Heap: ", THEME_BOOT);
-        vga_putint(hs.pages_allocated * 4);
-        vga_puts_color("KB inicial, ", THEME_BOOT);
+        vga_putint(hs.pages_reserved * 4);
+        vga_puts_color("KB inicial (sob demanda), ", THEME_BOOT);
         vga_putint(hs.free_bytes);
         vga_puts_color(" bytes livres\n", THEME_BOOT);
     }
@@ -118,18 +125,39 @@ void __attribute__((regparm(0))) kernel_main_32(unsigned int magic, void *multib
             vga_puts_color(disk->model, THEME_VALUE);
             vga_puts_color(" (", THEME_BOOT);
             vga_putint(disk->total_sectors / 2048);
-            vga_puts_color("MB)\n", THEME_BOOT);
+            vga_puts_color(disk->dma ? "MB, DMA" : "MB, PIO", THEME_BOOT);
+            vga_puts_color(disk->lba48 ? ", LBA48)\n" : ")\n", THEME_BOOT);
         } else {
             vga_puts_color("[--] ", THEME_DIM);
             vga_puts_color("IDE: nenhum disco detectado\n", THEME_DIM);
         }
     }
 
-    // Inicializa LeonFS em /mnt
+    // Inicializa LeonFS em /mnt (sobre o buffer cache)
+    // Sem disco IDE, monta sobre um RAM disk (conteúdo perdido no reboot)
     {
-        const ide_disk_info_t *disk = ide_get_info();
-        if (disk->present) {
-            vfs_node_t *mnt = leonfs_init();
+        blkdev_t *dev = ide_get_blkdev();
+        if (!dev) {
+            dev = ramdisk_create("ram0", RAMDISK_DEFAULT_SECTORS);
+            if (dev) {
+                vga_puts_color("[OK] ", THEME_BOOT_OK);
+                vga_puts_color("RAM disk ram0: ", THEME_BOOT);
+                vga_putint(blkdev_size(dev) / 2);
+                vga_puts_color("KB\n", THEME_BOOT);
+            }
+        }
+        if (dev) {
+            if (bcache_init()) {
+                bcache_stats_t bs = bcache_get_stats();
+                vga_puts_color("[OK] ", THEME_BOOT_OK);
+                vga_puts_color("Buffer cache: ", THEME_BOOT);
+                vga_putint(bs.buffers);
+                vga_puts_color(" setores (", THEME_BOOT);
+                vga_putint(bs.frames * 4);
+                vga_puts_color("KB)\n", THEME_BOOT);
+            }
+
+            vfs_node_t *mnt = leonfs_init(dev);
             if (mnt) {
                 // Monta LeonFS como /mnt no RamFS
                 // Cria /mnt como "filho" da raiz RamFS que redireciona para LeonFS
@@ -138,7 +166,9 @@ void __attribute__((regparm(0))) kernel_main_32(unsigned int magic, void *multib
                     root_data->children[root_data->child_count++] = mnt;
                 }
                 vga_puts_color("[OK] ", THEME_BOOT_OK);
-                vga_puts_color("LeonFS montado em /mnt\n", THEME_BOOT);
+                vga_puts_color("LeonFS montado em /mnt (", THEME_BOOT);
+                vga_puts_color(dev->name, THEME_VALUE);
+                vga_puts_color(")\n", THEME_BOOT);
             } else {
                 vga_puts_color("[!!] ", THEME_BOOT_FAIL);
                 vga_puts_color("LeonFS: falha ao inicializar\n", THEME_ERROR);
@@ -146,7 +176,7 @@ void __attribute__((regparm(0))) kernel_main_32(unsigned int magic, void *multib
         }
     }
 
-    // Inicializa rede (PCI + RTL8139 + Ethernet + ARP + IPv4 + ICMP + UDP + TCP + DNS + HTTP + Socket)
+    // Inicializa rede (PCI + virtio-net/e1000/RTL8139 + Ethernet + ARP + IPv4 + ICMP + UDP + TCP + DNS + HTTP + Socket)
     net_init();
     eth_init();
     arp_init();
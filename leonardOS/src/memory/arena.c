@@ -0,0 +1,118 @@
+// LeonardOS - Arena (região) para memória temporária de um pedido/comando
+// Implementação: lista de chunks de frames contíguos do PMM
+//
+// Primeiro chunk:  [arena_chunk_t][arena_t][dados...]
+// Chunks extras:   [arena_chunk_t][dados...]
+// arena_alloc só avança ptr; se não cabe, abre um chunk novo (o resto do
+// atual é desperdiçado — a arena vive pouco)
+
+#include "arena.h"
+#include "pmm.h"
+
+// Alinha um valor para cima ao próximo múltiplo de align
+static inline uint32_t align_up(uint32_t val, uint32_t align) {
+    return (val + align - 1) & ~(align - 1);
+}
+
+#define CHUNK_HDR   align_up(sizeof(arena_chunk_t), ARENA_ALIGNMENT)
+#define ARENA_HDR   align_up(sizeof(arena_t), ARENA_ALIGNMENT)
+
+// ============================================================
+// Chunks
+// ============================================================
+
+static arena_chunk_t *chunk_new(uint32_t frames) {
+    // Acima de 16MB o frame não está mapeado: restringe ao identity map
+    uint32_t phys = pmm_alloc_contiguous(frames, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (phys == 0) return NULL;
+
+    arena_chunk_t *c = (arena_chunk_t *)(uintptr_t)phys;
+    c->next = NULL;
+    c->frames = frames;
+    return c;
+}
+
+// Primeiro chunk = o último da lista (guarda o arena_t)
+static arena_chunk_t *first_chunk(arena_t *a) {
+    return (arena_chunk_t *)((uint8_t *)a - CHUNK_HDR);
+}
+
+// ============================================================
+// arena_create
+// ============================================================
+arena_t *arena_create(uint32_t chunk_frames) {
+    if (chunk_frames == 0) chunk_frames = ARENA_CHUNK_FRAMES;
+
+    arena_chunk_t *c = chunk_new(chunk_frames);
+    if (!c) return NULL;
+
+    arena_t *a = (arena_t *)((uint8_t *)c + CHUNK_HDR);
+    a->chunks = c;
+    a->ptr = (uint8_t *)a + ARENA_HDR;
+    a->end = (uint8_t *)c + chunk_frames * PMM_FRAME_SIZE;
+    a->chunk_frames = chunk_frames;
+    a->used = 0;
+    a->peak = 0;
+    return a;
+}
+
+// ============================================================
+// arena_alloc — O(1): bump pointer, chunk novo se não couber
+// ============================================================
+void *arena_alloc(arena_t *a, uint32_t size) {
+    if (!a || size == 0 || size > 0x10000000) return NULL;
+    size = align_up(size, ARENA_ALIGNMENT);
+
+    if (size > (uint32_t)(a->end - a->ptr)) {
+        uint32_t need = (size + CHUNK_HDR + PMM_FRAME_SIZE - 1) / PMM_FRAME_SIZE;
+        uint32_t frames = need > a->chunk_frames ? need : a->chunk_frames;
+
+        arena_chunk_t *c = chunk_new(frames);
+        if (!c) return NULL;
+        c->next = a->chunks;
+        a->chunks = c;
+        a->ptr = (uint8_t *)c + CHUNK_HDR;
+        a->end = (uint8_t *)c + frames * PMM_FRAME_SIZE;
+    }
+
+    void *p = a->ptr;
+    a->ptr += size;
+    a->used += size;
+    if (a->used > a->peak) a->peak = a->used;
+    return p;
+}
+
+// ============================================================
+// arena_reset — Libera todas as alocações de uma vez
+// ============================================================
+void arena_reset(arena_t *a) {
+    if (!a) return;
+
+    arena_chunk_t *first = first_chunk(a);
+    arena_chunk_t *c = a->chunks;
+    while (c != first) {
+        arena_chunk_t *next = c->next;
+        pmm_free_frames((uint32_t)(uintptr_t)c, c->frames);
+        c = next;
+    }
+
+    a->chunks = first;
+    a->ptr = (uint8_t *)a + ARENA_HDR;
+    a->end = (uint8_t *)first + first->frames * PMM_FRAME_SIZE;
+    a->used = 0;
+}
+
+// ============================================================
+// arena_destroy — Devolve todos os chunks ao PMM
+// ============================================================
+void arena_destroy(arena_t *a) {
+    if (!a) return;
+
+    arena_reset(a);
+    arena_chunk_t *first = first_chunk(a);
+    pmm_free_frames((uint32_t)(uintptr_t)first, first->frames);
+}
+
+uint32_t arena_used(const arena_t *a) {
+    return a ? a->used : 0;
+}
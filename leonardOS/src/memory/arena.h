@@ -0,0 +1,66 @@
+// LeonardOS - Arena (região) para memória temporária de um pedido/comando
+// Alocação por bump pointer em chunks de frames do PMM
+//
+// Sem header por objeto e sem free individual: tudo que saiu da arena é
+// devolvido de uma vez com arena_reset (mantém o primeiro chunk) ou
+// arena_destroy. Cada chamador cria a sua arena, então o código que a usa
+// é reentrante (pipeline dentro de script dentro de source...).
+// O arena_t mora no início do primeiro chunk. Os chunks vêm de abaixo de
+// PMM_DMA_MAX_PHYS (só os primeiros 16MB estão no identity map), então
+// phys == virt e nenhum kmalloc nem map_page é necessário.
+// API: arena_create, arena_alloc, arena_reset, arena_destroy, arena_used
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include "../common/types.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+#define ARENA_CHUNK_FRAMES   4       // Chunk padrão: 16KB
+#define ARENA_ALIGNMENT      8       // Alinhamento de cada alocação
+
+// ============================================================
+// Estruturas
+// ============================================================
+
+// Header no início de cada chunk (frames contíguos)
+typedef struct arena_chunk {
+    struct arena_chunk *next;   // Chunk anterior (lista do mais novo ao primeiro)
+    uint32_t            frames;
+} arena_chunk_t;
+
+typedef struct arena {
+    arena_chunk_t *chunks;      // Chunk atual (o mais novo)
+    uint8_t       *ptr;         // Próximo byte livre no chunk atual
+    uint8_t       *end;         // Fim do chunk atual
+    uint32_t       chunk_frames;// Tamanho padrão de chunk novo
+    uint32_t       used;        // Bytes entregues desde o último reset
+    uint32_t       peak;        // Maior used já visto
+} arena_t;
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Cria uma arena com chunks de chunk_frames frames (0 = ARENA_CHUNK_FRAMES)
+// Retorna NULL se o PMM não tem frames contíguos
+arena_t *arena_create(uint32_t chunk_frames);
+
+// Aloca size bytes alinhados a 8 (conteúdo indefinido). Pedidos maiores
+// que um chunk ganham um chunk sob medida. NULL se size == 0 ou sem memória
+void *arena_alloc(arena_t *a, uint32_t size);
+
+// Libera tudo de uma vez: devolve os chunks extras ao PMM e volta o bump
+// pointer para o início do primeiro chunk
+void arena_reset(arena_t *a);
+
+// Devolve todos os chunks (inclusive o que guarda o arena_t)
+void arena_destroy(arena_t *a);
+
+// Bytes alocados desde o último reset
+uint32_t arena_used(const arena_t *a);
+
+#endif
@@ -1,34 +1,70 @@
 // LeonardOS - Heap do Kernel (kmalloc / kfree)
-// Linked-list allocator com first-fit e coalescing
+// Segregated fit (estilo TLSF) com boundary tags
 //
 // Estrutura:
 //   heap_start → [block header][dados][block header][dados]...
-//   Cada block header tem size, free flag, e ponteiro para next
-//   kmalloc faz first-fit, split se sobrar espaço
-//   kfree marca livre e faz merge com vizinhos
+//   Blocos são fisicamente contíguos; cada header tem size, free flag
+//   e prev_phys (boundary tag: endereço do bloco físico anterior)
+//   Blocos livres ficam em free_lists[fl][sl] (classe do tamanho):
+//     fl = potência de 2 do tamanho, sl = subdivisão linear dela
+//   fl_bitmap / sl_bitmap[] dizem quais listas têm blocos, então achar
+//   a menor classe que serve é um bsf — sem percorrer o heap
+//   kmalloc: classe arredondada para cima, split do que sobrar
+//   kfree: merge imediato com vizinho anterior/seguinte se livres
+//
+// Memória sob demanda: heap_expand só reserva espaço na janela
+// [HEAP_START, HEAP_WINDOW_END); o page fault handler do VMM dá um frame
+// a cada página no primeiro acesso. Um buffer grande que só é escrito em
+// parte custa só as páginas tocadas. Ao liberar, as páginas inteiramente
+// dentro de um bloco livre >= HEAP_DECOMMIT_MIN voltam ao PMM (o header e
+// os links da lista livre, no início do bloco, continuam residentes).
+// Cada página que pode ser tocada é comprometida (kmalloc, header novo
+// em heap_expand) e descomprometida no decommit; cada compromisso novo
+// confere o pendente (comprometidas - residentes) contra os frames livres.
 
 #include "heap.h"
 #include "pmm.h"
 #include "vmm.h"
 #include "../drivers/vga/vga.h"
+#include "../drivers/timer/pit.h"
 #include "../common/colors.h"
+#include "../common/string.h"
+
+// Maior pedido aceito (evita overflow no arredondamento de classe)
+#define HEAP_MAX_ALLOC     0x10000000
+
+// Menor área de dados de um bloco (precisa caber heap_free_links_t)
+#define HEAP_MIN_PAYLOAD   HEAP_ALIGNMENT
 
 // ============================================================
 // Estado interno do heap
 // ============================================================
 
-// Ponteiro para o primeiro bloco da lista
-static heap_block_t *heap_head = NULL;
+// Último bloco físico (o que encosta em heap_end)
+static heap_block_t *heap_tail = NULL;
 
 // Limite atual do heap (endereço do próximo byte após o heap)
 static uint32_t heap_end = 0;
 
+// Listas livres segregadas + bitmaps de ocupação
+static heap_block_t *free_lists[HEAP_FL_COUNT][HEAP_SL_COUNT];
+static uint32_t fl_bitmap = 0;                  // Bit fl = alguma lista em fl
+static uint32_t sl_bitmap[HEAP_FL_COUNT];       // Bit sl = free_lists[fl][sl]
+
 // Contadores
-static uint32_t heap_pages_allocated = 0;
 static uint32_t heap_alloc_count = 0;
 static uint32_t heap_free_count = 0;
 
+// Compromisso de memória: uma página da janela com bit ligado pode ser
+// tocada (header, links ou dados entregues) e tem um frame prometido.
+// Pendente = comprometidas - residentes; kmalloc/heap_expand só comprometem
+// mais se o pendente + o novo couber nos frames livres do PMM
+#define HEAP_WINDOW_PAGES  (HEAP_MAX_SIZE / HEAP_PAGE_SIZE)
+static uint32_t commit_bitmap[HEAP_WINDOW_PAGES / 32];
+static uint32_t heap_committed = 0;
+
 static bool heap_initialized = false;
+static bool heap_track_on = false;
 
 // ============================================================
 // Helpers
@@ -39,153 +75,317 @@ static inline uint32_t align_up(uint32_t val, uint32_t align) {
     return (val + align - 1) & ~(align - 1);
 }
 
+// Índice do bit mais significativo (x != 0)
+static inline uint32_t fls32(uint32_t x) {
+    return 31 - (uint32_t)__builtin_clz(x);
+}
+
+static inline heap_free_links_t *links(heap_block_t *b) {
+    return (heap_free_links_t *)((uint8_t *)b + HEAP_HEADER_SIZE);
+}
+
+// Trailer de um bloco tracked (fim da área de dados)
+static inline heap_track_t *track_of(heap_block_t *b) {
+    return (heap_track_t *)((uint8_t *)b + HEAP_HEADER_SIZE + b->size - HEAP_TRACK_SIZE);
+}
+
+// Próximo bloco físico (NULL se b é o último)
+static inline heap_block_t *phys_next(heap_block_t *b) {
+    uint32_t addr = (uint32_t)(uintptr_t)b + HEAP_HEADER_SIZE + b->size;
+    return (addr < heap_end) ? (heap_block_t *)(uintptr_t)addr : NULL;
+}
+
 // ============================================================
-// heap_expand — Adiciona mais páginas ao heap
+// Compromisso por página
+// ============================================================
+
+// Compromete as páginas de [start, end) que ainda não estão; false (sem
+// mudar nada) se a RAM livre não cobre o pendente + as novas
+static bool heap_commit(uint32_t start, uint32_t end) {
+    uint32_t first = (start - HEAP_START) / HEAP_PAGE_SIZE;
+    uint32_t last = (align_up(end, HEAP_PAGE_SIZE) - HEAP_START) / HEAP_PAGE_SIZE;
+
+    uint32_t need = 0;
+    for (uint32_t i = first; i < last; i++) {
+        if (!(commit_bitmap[i / 32] & (1u << (i % 32)))) need++;
+    }
+    if (need == 0) return true;
+
+    uint32_t resident = vmm_demand_resident(HEAP_START);
+    uint32_t pending = heap_committed > resident ? heap_committed - resident : 0;
+    if (pending + need > pmm_get_stats().free_frames) return false;
+
+    for (uint32_t i = first; i < last; i++) commit_bitmap[i / 32] |= 1u << (i % 32);
+    heap_committed += need;
+    return true;
+}
+
+// Devolve o compromisso das páginas de [start, end) (alinhados a página)
+static void heap_uncommit(uint32_t start, uint32_t end) {
+    for (uint32_t va = start; va < end; va += HEAP_PAGE_SIZE) {
+        uint32_t i = (va - HEAP_START) / HEAP_PAGE_SIZE;
+        if (commit_bitmap[i / 32] & (1u << (i % 32))) {
+            commit_bitmap[i / 32] &= ~(1u << (i % 32));
+            heap_committed--;
+        }
+    }
+}
+
+// ============================================================
+// Classes de tamanho
+// ============================================================
+
+// Classe exata de um bloco de size bytes (para inserir)
+static void mapping_insert(uint32_t size, uint32_t *fl, uint32_t *sl) {
+    if (size < HEAP_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = size / HEAP_ALIGNMENT;
+    } else {
+        uint32_t f = fls32(size);
+        *sl = (size >> (f - HEAP_SL_LOG2)) ^ HEAP_SL_COUNT;
+        *fl = f - (HEAP_FL_SHIFT - 1);
+    }
+}
+
+// Tamanho arredondado para o início da próxima classe: qualquer bloco
+// dessa classe (ou acima) serve para o pedido
+static uint32_t search_size(uint32_t size) {
+    if (size >= HEAP_SMALL_BLOCK) {
+        size += (1u << (fls32(size) - HEAP_SL_LOG2)) - 1;
+    }
+    return size;
+}
+
+// ============================================================
+// Listas livres
 // ============================================================
-static bool heap_expand(uint32_t min_bytes) {
-    // Calcula quantas páginas precisamos
-    uint32_t pages_needed = (min_bytes + HEAP_PAGE_SIZE - 1) / HEAP_PAGE_SIZE;
-    if (pages_needed == 0) pages_needed = 1;
 
-    uint32_t new_bytes = 0;
+static void free_list_insert(heap_block_t *b) {
+    uint32_t fl, sl;
+    mapping_insert(b->size, &fl, &sl);
+
+    heap_free_links_t *l = links(b);
+    l->prev_free = NULL;
+    l->next_free = free_lists[fl][sl];
+    if (l->next_free) links(l->next_free)->prev_free = b;
+    free_lists[fl][sl] = b;
+
+    fl_bitmap |= 1u << fl;
+    sl_bitmap[fl] |= 1u << sl;
+    b->free = 1;
+}
 
-    for (uint32_t i = 0; i < pages_needed; i++) {
-        uint32_t frame = pmm_alloc_frame();
-        if (frame == 0) return false;
+static void free_list_remove(heap_block_t *b) {
+    uint32_t fl, sl;
+    mapping_insert(b->size, &fl, &sl);
 
-        // Mapeia o frame físico no endereço virtual heap_end
-        map_page(heap_end, frame, PAGE_KERNEL);
+    heap_free_links_t *l = links(b);
+    if (l->prev_free) links(l->prev_free)->next_free = l->next_free;
+    else free_lists[fl][sl] = l->next_free;
+    if (l->next_free) links(l->next_free)->prev_free = l->prev_free;
 
-        heap_end += HEAP_PAGE_SIZE;
-        heap_pages_allocated++;
-        new_bytes += HEAP_PAGE_SIZE;
+    if (!free_lists[fl][sl]) {
+        sl_bitmap[fl] &= ~(1u << sl);
+        if (!sl_bitmap[fl]) fl_bitmap &= ~(1u << fl);
     }
+    b->free = 0;
+}
+
+// Primeiro bloco da menor classe não vazia que comporta size (O(1))
+static heap_block_t *find_free(uint32_t size) {
+    uint32_t fl, sl;
+    mapping_insert(search_size(size), &fl, &sl);
+    if (fl >= HEAP_FL_COUNT) return NULL;
+
+    uint32_t sl_map = sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        uint32_t fl_map = (fl + 1 < 32) ? (fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (!fl_map) return NULL;
+        fl = (uint32_t)__builtin_ctz(fl_map);
+        sl_map = sl_bitmap[fl];
+    }
+    sl = (uint32_t)__builtin_ctz(sl_map);
+    return free_lists[fl][sl];
+}
+
+// ============================================================
+// Split / merge
+// ============================================================
+
+// Corta b em [size][resto livre] se o resto comportar um bloco
+static void block_split(heap_block_t *b, uint32_t size) {
+    if (b->size < size + HEAP_HEADER_SIZE + HEAP_MIN_PAYLOAD) return;
+
+    heap_block_t *rest = (heap_block_t *)((uint8_t *)b + HEAP_HEADER_SIZE + size);
+    rest->size = b->size - size - HEAP_HEADER_SIZE;
+    rest->magic = HEAP_MAGIC;
+    rest->prev_phys = b;
+    b->size = size;
+
+    heap_block_t *after = phys_next(rest);
+    if (after) after->prev_phys = rest;
+    else heap_tail = rest;
+
+    free_list_insert(rest);
+}
+
+// Absorve next (fisicamente logo após b) em b
+static void block_absorb(heap_block_t *b, heap_block_t *next) {
+    b->size += HEAP_HEADER_SIZE + next->size;
+    next->magic = 0;
 
-    if (new_bytes == 0) return false;
+    heap_block_t *after = phys_next(b);
+    if (after) after->prev_phys = b;
+    else heap_tail = b;
+}
 
-    // Encontra o último bloco da lista
-    heap_block_t *last = heap_head;
-    while (last->next != NULL) {
-        last = last->next;
+// ============================================================
+// heap_expand — Reserva mais espaço virtual no fim do heap (O(1))
+// ============================================================
+// Nenhum frame é alocado aqui: as páginas novas são mapeadas pelo page
+// fault handler quando tocadas. Só o header de um bloco novo é
+// comprometido agora; os dados, quando kmalloc entregar o bloco
+static bool heap_expand(uint32_t min_bytes) {
+    uint32_t new_bytes = align_up(min_bytes, HEAP_PAGE_SIZE);
+    if (new_bytes == 0) new_bytes = HEAP_PAGE_SIZE;
+    if (new_bytes > HEAP_WINDOW_END - heap_end) return false;
+
+    heap_block_t *tail = heap_tail;
+    uint32_t old_end = heap_end;
+
+    // Overcommit limitado: sem frame para o que será tocado, kmalloc
+    // falha (NULL) em vez de um fault sem frame mais tarde
+    if (!tail->free &&
+        !heap_commit(old_end, old_end + HEAP_HEADER_SIZE + sizeof(heap_free_links_t))) {
+        return false;
     }
 
-    if (last->free) {
+    heap_end += new_bytes;
+
+    if (tail->free) {
         // Estende o último bloco livre
-        last->size += new_bytes;
+        free_list_remove(tail);
+        tail->size += new_bytes;
+        free_list_insert(tail);
     } else {
         // Cria um novo bloco livre no espaço expandido
-        heap_block_t *new_block = (heap_block_t *)((uint8_t *)last + HEAP_HEADER_SIZE + last->size);
+        heap_block_t *new_block = (heap_block_t *)(uintptr_t)old_end;
         new_block->size = new_bytes - HEAP_HEADER_SIZE;
-        new_block->free = 1;
-        new_block->next = NULL;
-        last->next = new_block;
+        new_block->magic = HEAP_MAGIC;
+        new_block->prev_phys = tail;
+        heap_tail = new_block;
+        free_list_insert(new_block);
     }
 
     return true;
 }
 
+// ============================================================
+// heap_decommit — Devolve ao PMM as páginas internas de um bloco livre
+// ============================================================
+// Só olha a parte de b que veio de [freed_start, freed_end) e as páginas
+// das bordas (headers absorvidos, links do vizinho seguinte): o resto de
+// b já foi devolvido quando os vizinhos foram liberados
+static void heap_decommit(heap_block_t *b, uint32_t freed_start, uint32_t freed_end) {
+    if (b->size < HEAP_DECOMMIT_MIN) return;
+
+    uint32_t keep = (uint32_t)(uintptr_t)b + HEAP_HEADER_SIZE + sizeof(heap_free_links_t);
+    uint32_t start = align_up(keep, HEAP_PAGE_SIZE);
+    uint32_t end = ((uint32_t)(uintptr_t)b + HEAP_HEADER_SIZE + b->size) & ~(HEAP_PAGE_SIZE - 1);
+
+    uint32_t lo = freed_start & ~(HEAP_PAGE_SIZE - 1);
+    uint32_t hi = align_up(freed_end, HEAP_PAGE_SIZE) + HEAP_PAGE_SIZE;
+    if (start < lo) start = lo;
+    if (end > hi) end = hi;
+
+    if (start < end) {
+        vmm_demand_release(start, end);
+        heap_uncommit(start, end);
+    }
+}
+
 // ============================================================
 // heap_init — Inicializa o heap com páginas iniciais
 // ============================================================
 void heap_init(void) {
-    heap_end = HEAP_START;
-
-    // Aloca as páginas iniciais e mapeia no espaço virtual do heap
-    for (uint32_t i = 0; i < HEAP_INITIAL_PAGES; i++) {
-        uint32_t frame = pmm_alloc_frame();
-        if (frame == 0) {
-            vga_puts_color("[FAIL] ", THEME_BOOT_FAIL);
-            vga_puts_color("Heap: sem memoria para pagina inicial!\n", THEME_ERROR);
-            return;
-        }
+    // Janela sob demanda: frames só no primeiro acesso a cada página
+    if (!vmm_demand_register(HEAP_START, HEAP_WINDOW_END, PAGE_KERNEL)) {
+        vga_puts_color("[FAIL] ", THEME_BOOT_FAIL);
+        vga_puts_color("Heap: janela virtual nao registrada!\n", THEME_ERROR);
+        return;
+    }
 
-        // Mapeia frame físico → endereço virtual do heap
-        map_page(heap_end, frame, PAGE_KERNEL);
+    heap_end = HEAP_START + HEAP_INITIAL_PAGES * HEAP_PAGE_SIZE;
+    heap_committed = 0;
+    kmemset(commit_bitmap, 0, sizeof(commit_bitmap));
+    heap_commit(HEAP_START, heap_end);
 
-        heap_end += HEAP_PAGE_SIZE;
-        heap_pages_allocated++;
+    for (uint32_t fl = 0; fl < HEAP_FL_COUNT; fl++) {
+        sl_bitmap[fl] = 0;
+        for (uint32_t sl = 0; sl < HEAP_SL_COUNT; sl++) free_lists[fl][sl] = NULL;
     }
+    fl_bitmap = 0;
 
     // Cria o bloco livre inicial que cobre todo o espaço
-    heap_head = (heap_block_t *)HEAP_START;
-    heap_head->size = (heap_end - HEAP_START) - HEAP_HEADER_SIZE;
-    heap_head->free = 1;
-    heap_head->next = NULL;
+    heap_block_t *first = (heap_block_t *)HEAP_START;
+    first->size = (heap_end - HEAP_START) - HEAP_HEADER_SIZE;
+    first->magic = HEAP_MAGIC;
+    first->prev_phys = NULL;
+    heap_tail = first;
+    free_list_insert(first);
 
     heap_initialized = true;
 }
 
 // ============================================================
-// kmalloc — Aloca size bytes (first-fit)
+// kmalloc — Aloca size bytes (good-fit por classe, O(1))
 // ============================================================
 void *kmalloc(uint32_t size) {
-    if (!heap_initialized || size == 0) return NULL;
-
-    // Alinha o tamanho pedido
-    size = align_up(size, HEAP_ALIGNMENT);
+    if (!heap_initialized || size == 0 || size > HEAP_MAX_ALLOC) return NULL;
 
-    // First-fit: percorre a lista procurando bloco livre com espaço suficiente
-    heap_block_t *current = heap_head;
+    uint32_t req_size = size;
+    bool track = heap_track_on;
 
-    while (current != NULL) {
-        if (current->free && current->size >= size) {
-            // Encontrou! Verifica se vale a pena fazer split
-            uint32_t remaining = current->size - size;
-
-            if (remaining > HEAP_HEADER_SIZE + HEAP_ALIGNMENT) {
-                // Split: cria um novo bloco livre no espaço que sobrou
-                heap_block_t *new_block = (heap_block_t *)((uint8_t *)current + HEAP_HEADER_SIZE + size);
-                new_block->size = remaining - HEAP_HEADER_SIZE;
-                new_block->free = 1;
-                new_block->next = current->next;
-
-                current->size = size;
-                current->next = new_block;
-            }
-
-            current->free = 0;
-            heap_alloc_count++;
-
-            // Retorna ponteiro para a área de dados (logo após o header)
-            return (void *)((uint8_t *)current + HEAP_HEADER_SIZE);
-        }
-
-        current = current->next;
+    // Alinha o tamanho pedido (+ trailer do profiler)
+    size = align_up(size, HEAP_ALIGNMENT);
+    if (track) size += HEAP_TRACK_SIZE;
+    if (size < HEAP_MIN_PAYLOAD) size = HEAP_MIN_PAYLOAD;
+
+    heap_block_t *b = find_free(size);
+    if (!b) {
+        // Nenhuma classe serve — expande o heap o bastante para a classe
+        // arredondada caber num bloco novo
+        heap_expand(search_size(size) + HEAP_HEADER_SIZE);
+        b = find_free(size);
+        if (!b) return NULL;  // Sem memória
     }
 
-    // Não encontrou bloco livre — tenta expandir o heap
-    uint32_t needed = size + HEAP_HEADER_SIZE;
-    if (heap_expand(needed)) {
-        // Tenta alocar novamente (recursão limitada a 1 nível)
-        // Percorre de novo para encontrar o bloco expandido
-        current = heap_head;
-        while (current != NULL) {
-            if (current->free && current->size >= size) {
-                uint32_t remaining = current->size - size;
-
-                if (remaining > HEAP_HEADER_SIZE + HEAP_ALIGNMENT) {
-                    heap_block_t *new_block = (heap_block_t *)((uint8_t *)current + HEAP_HEADER_SIZE + size);
-                    new_block->size = remaining - HEAP_HEADER_SIZE;
-                    new_block->free = 1;
-                    new_block->next = current->next;
-
-                    current->size = size;
-                    current->next = new_block;
-                }
-
-                current->free = 0;
-                heap_alloc_count++;
-                return (void *)((uint8_t *)current + HEAP_HEADER_SIZE);
-            }
-            current = current->next;
-        }
+    // Compromete o que será tocado: o bloco entregue e o header + links
+    // do resto do split (páginas devolvidas por heap_decommit voltam aqui)
+    uint32_t b_addr = (uint32_t)(uintptr_t)b;
+    uint32_t touch_end = b_addr + HEAP_HEADER_SIZE + size + HEAP_HEADER_SIZE + sizeof(heap_free_links_t);
+    uint32_t b_end = b_addr + HEAP_HEADER_SIZE + b->size;
+    if (touch_end > b_end) touch_end = b_end;
+    if (!heap_commit(b_addr, touch_end)) return NULL;  // Sem RAM para cobrir
+
+    free_list_remove(b);
+    block_split(b, size);
+    heap_alloc_count++;
+
+    b->tracked = track;
+    if (track) {
+        b->caller = (uint32_t)(uintptr_t)__builtin_return_address(0);
+        heap_track_t *t = track_of(b);
+        t->req_size = req_size;
+        t->time_ms = pit_get_ms();
     }
 
-    return NULL;  // Sem memória
+    // Retorna ponteiro para a área de dados (logo após o header)
+    return (void *)((uint8_t *)b + HEAP_HEADER_SIZE);
 }
 
 // ============================================================
-// kfree — Libera memória e faz coalescing
+// kfree — Libera memória e faz coalescing imediato (O(1))
 // ============================================================
 void kfree(void *ptr) {
     if (!heap_initialized || ptr == NULL) return;
@@ -193,29 +393,37 @@ void kfree(void *ptr) {
     // O header está logo antes do ponteiro retornado
     heap_block_t *block = (heap_block_t *)((uint8_t *)ptr - HEAP_HEADER_SIZE);
 
-    // Validação básica: o ponteiro deve estar dentro do heap
+    // Validação básica: o ponteiro deve estar dentro do heap e ter a marca
     uint32_t addr = (uint32_t)(uintptr_t)block;
     if (addr < HEAP_START || addr >= heap_end) return;
+    if (addr & (HEAP_ALIGNMENT - 1)) return;
+    // Header de bloco válido sempre é residente: não cria página só para ler lixo
+    if (!is_page_mapped(addr)) return;
+    if (block->magic != HEAP_MAGIC) return;
 
     // Já está livre? (double-free protection)
     if (block->free) return;
 
-    block->free = 1;
     heap_free_count++;
+    uint32_t freed_end = addr + HEAP_HEADER_SIZE + block->size;
 
-    // Coalescing: merge com blocos livres adjacentes
-    // Percorre toda a lista e faz merge de pares consecutivos livres
-    heap_block_t *current = heap_head;
-    while (current != NULL && current->next != NULL) {
-        if (current->free && current->next->free) {
-            // Merge: absorve o próximo bloco
-            current->size += HEAP_HEADER_SIZE + current->next->size;
-            current->next = current->next->next;
-            // Não avança — pode ter mais merges consecutivos
-        } else {
-            current = current->next;
-        }
+    // Merge com o próximo bloco físico
+    heap_block_t *next = phys_next(block);
+    if (next && next->free) {
+        free_list_remove(next);
+        block_absorb(block, next);
+    }
+
+    // Merge com o anterior (boundary tag)
+    heap_block_t *prev = block->prev_phys;
+    if (prev && prev->free) {
+        free_list_remove(prev);
+        block_absorb(prev, block);
+        block = prev;
     }
+
+    free_list_insert(block);
+    heap_decommit(block, addr, freed_end);
 }
 
 // ============================================================
@@ -231,9 +439,12 @@ struct heap_stats heap_get_stats(void) {
     stats.used_blocks = 0;
     stats.alloc_count = heap_alloc_count;
     stats.free_count = heap_free_count;
-    stats.pages_allocated = heap_pages_allocated;
+    stats.pages_allocated = vmm_demand_resident(HEAP_START);
+    stats.pages_reserved = (heap_end - HEAP_START) / HEAP_PAGE_SIZE;
+    stats.pages_committed = heap_committed;
 
-    heap_block_t *current = heap_head;
+    // Percorre os blocos físicos em ordem de endereço
+    heap_block_t *current = heap_initialized ? (heap_block_t *)HEAP_START : NULL;
     while (current != NULL) {
         stats.total_blocks++;
         if (current->free) {
@@ -243,8 +454,90 @@ struct heap_stats heap_get_stats(void) {
             stats.used_blocks++;
             stats.used_bytes += current->size;
         }
-        current = current->next;
+        current = phys_next(current);
     }
 
     return stats;
 }
+
+// ============================================================
+// Profiler de alocação
+// ============================================================
+
+void heap_set_tracking(bool on) {
+    heap_track_on = on;
+}
+
+bool heap_tracking(void) {
+    return heap_track_on;
+}
+
+// Agregação por site (estática: o relatório roda no shell, sem reentrada)
+static heap_site_t prof_sites[HEAP_PROF_MAX_SITES];
+
+void heap_profile(heap_profile_t *out) {
+    kmemset(out, 0, sizeof(heap_profile_t));
+    uint32_t nsites = 0;
+
+    heap_block_t *b = heap_initialized ? (heap_block_t *)HEAP_START : NULL;
+    for (; b != NULL; b = phys_next(b)) {
+        if (b->free) {
+            out->free_blocks++;
+            out->free_bytes += b->size;
+            if (b->size > out->largest_free) out->largest_free = b->size;
+            continue;
+        }
+
+        // Histograma pelo tamanho do bloco: bucket 0 = [8,16)
+        uint32_t bucket = fls32(b->size) - 3;
+        if (bucket >= HEAP_PROF_BUCKETS) bucket = HEAP_PROF_BUCKETS - 1;
+        out->histogram[bucket]++;
+
+        if (!b->tracked) {
+            out->untracked_blocks++;
+            continue;
+        }
+        out->tracked_blocks++;
+
+        heap_track_t *t = track_of(b);
+        uint32_t i = 0;
+        while (i < nsites && prof_sites[i].caller != b->caller) i++;
+        if (i == nsites) {
+            if (nsites == HEAP_PROF_MAX_SITES) {
+                out->other_bytes += t->req_size;
+                continue;
+            }
+            prof_sites[i].caller = b->caller;
+            prof_sites[i].live_bytes = 0;
+            prof_sites[i].live_blocks = 0;
+            prof_sites[i].oldest_ms = t->time_ms;
+            nsites++;
+        }
+        prof_sites[i].live_bytes += t->req_size;
+        prof_sites[i].live_blocks++;
+        if (t->time_ms < prof_sites[i].oldest_ms) prof_sites[i].oldest_ms = t->time_ms;
+    }
+    out->total_sites = nsites;
+
+    // Top HEAP_PROF_TOP por bytes vivos (seleção: nsites <= 64)
+    while (out->site_count < HEAP_PROF_TOP && out->site_count < nsites) {
+        uint32_t best = out->site_count;
+        for (uint32_t i = best + 1; i < nsites; i++) {
+            if (prof_sites[i].live_bytes > prof_sites[best].live_bytes) best = i;
+        }
+        heap_site_t tmp = prof_sites[out->site_count];
+        prof_sites[out->site_count] = prof_sites[best];
+        prof_sites[best] = tmp;
+        out->sites[out->site_count] = prof_sites[out->site_count];
+        out->site_count++;
+    }
+
+    // Fragmentação: 0% = todo o espaço livre num bloco só
+    // (sem divisão de 64 bits: escala antes se * 100 estouraria)
+    uint32_t f = out->free_bytes;
+    if (f > 0) {
+        uint32_t largest_pct = (f > 0xFFFFFFFFu / 100) ? out->largest_free / (f / 100)
+                                                       : out->largest_free * 100 / f;
+        out->frag_pct = largest_pct >= 100 ? 0 : 100 - largest_pct;
+    }
+}
@@ -1,9 +1,18 @@
 // LeonardOS - Heap do Kernel (kmalloc / kfree)
-// Alocador de memória dinâmica com linked-list e first-fit
+// Alocador segregated-fit (estilo TLSF) com boundary tags
 //
-// Usa PMM para obter frames de 4KB sob demanda.
-// Dentro do identity map (0-16MB), não precisa de map_page extra.
-// API: heap_init, kmalloc, kfree, heap_get_stats
+// kmalloc, kfree e a expansão são O(1): listas livres por classe de
+// tamanho com bitmaps de dois níveis, e cada bloco aponta para o vizinho
+// físico anterior, então o coalescing é imediato e local.
+// O heap vive numa janela virtual reservada (fora do identity map)
+// registrada no VMM como região sob demanda: crescer o heap só avança
+// heap_end; cada página ganha um frame do PMM no primeiro acesso (page
+// fault). Blocos livres grandes devolvem suas páginas internas ao PMM.
+// Profiler opcional (heap_set_tracking): cada kmalloc grava o endereço de
+// retorno do chamador no header e tamanho pedido + instante num trailer
+// no fim do bloco; heap_profile agrega os blocos vivos por site.
+// API: heap_init, kmalloc, kfree, heap_get_stats,
+//      heap_set_tracking, heap_tracking, heap_profile
 
 #ifndef __HEAP_H__
 #define __HEAP_H__
@@ -14,32 +23,66 @@
 // Constantes do Heap
 // ============================================================
 
-// Endereço inicial do heap (5MB — dentro do identity map, acima do kernel)
-#define HEAP_START        0x00500000
+// Janela virtual do heap (3.25GB — acima de qualquer identity map)
+#define HEAP_START        0xD0000000
+#define HEAP_MAX_SIZE     0x10000000                    // 256MB de espaço virtual
+#define HEAP_WINDOW_END   (HEAP_START + HEAP_MAX_SIZE)
 
-// Páginas iniciais alocadas no boot (4 frames = 16KB)
+// Páginas reservadas no boot (16KB de espaço, frames só no primeiro toque)
 #define HEAP_INITIAL_PAGES 4
 
+// Bloco livre a partir deste tamanho devolve as páginas internas ao PMM
+#define HEAP_DECOMMIT_MIN  0x10000                      // 64KB
+
 // Alinhamento mínimo de retorno do kmalloc (8 bytes)
 #define HEAP_ALIGNMENT     8
 
 // Tamanho de uma página (deve bater com PMM_FRAME_SIZE)
 #define HEAP_PAGE_SIZE     4096
 
+// Classes de tamanho (TLSF): primeiro nível = potência de 2,
+// segundo nível = HEAP_SL_COUNT subdivisões lineares de cada potência
+#define HEAP_SL_LOG2       4
+#define HEAP_SL_COUNT      (1 << HEAP_SL_LOG2)                 // 16
+#define HEAP_FL_SHIFT      (HEAP_SL_LOG2 + 3)                  // log2(SL_COUNT * ALIGNMENT)
+#define HEAP_SMALL_BLOCK   (1 << HEAP_FL_SHIFT)                // 128: abaixo disso, classes de 8 bytes
+#define HEAP_FL_COUNT      (32 - HEAP_FL_SHIFT + 1)            // Até blocos de 4GB
+
+// Marca de bloco válido (kfree rejeita ponteiros que não vieram do heap)
+#define HEAP_MAGIC         0x4B48      // "HK"
+
 // ============================================================
 // Estrutura de bloco do heap
 // ============================================================
 // Cada bloco tem um header seguido dos dados úteis.
 // Layout: [heap_block_t header][dados do usuário...]
+// Blocos são fisicamente contíguos: o próximo começa em
+// (header + HEAP_HEADER_SIZE + size); prev_phys é a boundary tag do anterior.
+// Bloco livre guarda os ponteiros da lista de classe nos próprios dados.
 
 typedef struct heap_block {
     uint32_t size;              // Tamanho útil (sem contar o header)
     uint8_t  free;              // 1 = livre, 0 = em uso
-    uint8_t  _pad[3];           // Padding interno
-    struct heap_block *next;    // Próximo bloco na lista
-    uint32_t _reserved;         // Pad struct para 16 bytes (alinha dados a 8)
+    uint8_t  tracked;           // 1 = alocado com profiler ligado (tem trailer)
+    uint16_t magic;             // HEAP_MAGIC
+    struct heap_block *prev_phys; // Bloco físico anterior (NULL = primeiro)
+    uint32_t caller;            // Endereço de retorno do kmalloc (se tracked)
 } heap_block_t;
 
+// Trailer de um bloco tracked (últimos bytes da área de dados)
+typedef struct heap_track {
+    uint32_t req_size;          // Tamanho pedido ao kmalloc
+    uint32_t time_ms;           // pit_get_ms() na alocação
+} heap_track_t;
+
+#define HEAP_TRACK_SIZE   sizeof(heap_track_t)
+
+// Ponteiros da lista livre (no início dos dados de um bloco livre)
+typedef struct heap_free_links {
+    heap_block_t *next_free;
+    heap_block_t *prev_free;
+} heap_free_links_t;
+
 // Tamanho do header (deve ser múltiplo de HEAP_ALIGNMENT)
 #define HEAP_HEADER_SIZE  sizeof(heap_block_t)
 
@@ -55,9 +98,40 @@ struct heap_stats {
     uint32_t used_blocks;       // Blocos em uso
     uint32_t alloc_count;       // Total de kmalloc chamados
     uint32_t free_count;        // Total de kfree chamados
-    uint32_t pages_allocated;   // Páginas de 4KB alocadas para o heap
+    uint32_t pages_allocated;   // Páginas da janela com frame (residentes)
+    uint32_t pages_reserved;    // Páginas da janela até heap_end
+    uint32_t pages_committed;   // Páginas com frame prometido (residentes ou não)
 };
 
+// ============================================================
+// Profiler de alocação
+// ============================================================
+
+#define HEAP_PROF_MAX_SITES  64     // Sites distintos agregados por relatório
+#define HEAP_PROF_TOP        10     // Sites devolvidos (maiores em bytes vivos)
+#define HEAP_PROF_BUCKETS    16     // Histograma: [8,16), [16,32) ... [256KB, ∞)
+
+typedef struct {
+    uint32_t caller;            // Endereço de retorno do kmalloc
+    uint32_t live_bytes;        // Soma dos tamanhos pedidos ainda vivos
+    uint32_t live_blocks;
+    uint32_t oldest_ms;         // Alocação viva mais antiga (pit_get_ms)
+} heap_site_t;
+
+typedef struct {
+    heap_site_t sites[HEAP_PROF_TOP];   // Ordenados por live_bytes
+    uint32_t site_count;                // Entradas válidas em sites[]
+    uint32_t total_sites;               // Sites distintos vistos
+    uint32_t other_bytes;               // Bytes de sites além da tabela
+    uint32_t tracked_blocks;            // Blocos em uso com site
+    uint32_t untracked_blocks;          // Alocados com o profiler desligado
+    uint32_t histogram[HEAP_PROF_BUCKETS]; // Blocos em uso por tamanho
+    uint32_t free_bytes;
+    uint32_t free_blocks;
+    uint32_t largest_free;
+    uint32_t frag_pct;                  // 100 * (1 - maior livre / total livre)
+} heap_profile_t;
+
 // ============================================================
 // API pública
 // ============================================================
@@ -66,15 +140,24 @@ struct heap_stats {
 // Deve ser chamada DEPOIS de paging_init() e ANTES de sti
 void heap_init(void);
 
-// Aloca size bytes de memória do kernel
+// Aloca size bytes de memória do kernel (good-fit por classe, O(1))
 // Retorna ponteiro alinhado a 8 bytes, ou NULL se falhar
 void *kmalloc(uint32_t size);
 
 // Libera memória previamente alocada com kmalloc
-// Faz merge com blocos adjacentes livres (coalescing)
+// Faz merge imediato com os vizinhos físicos livres (O(1))
 void kfree(void *ptr);
 
-// Retorna estatísticas atuais do heap
+// Retorna estatísticas atuais do heap (percorre os blocos: O(n))
 struct heap_stats heap_get_stats(void);
 
+// Liga/desliga o rastreamento por site (custa HEAP_TRACK_SIZE por bloco)
+// Só blocos alocados com ele ligado aparecem por site no relatório
+void heap_set_tracking(bool on);
+bool heap_tracking(void);
+
+// Percorre o heap: top sites por bytes vivos, histograma de tamanhos e
+// índice de fragmentação (O(blocos))
+void heap_profile(heap_profile_t *out);
+
 #endif
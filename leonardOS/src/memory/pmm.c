@@ -1,13 +1,23 @@
 // LeonardOS - PMM (Physical Memory Manager)
-// Bitmap allocator para frames de 4KB
+// Bitmap allocator de dois níveis para frames de 4KB
 //
 // Usa Multiboot2 mmap para detectar RAM disponível.
 // Cada bit no bitmap = 1 frame de 4KB.
 // bit=0 → frame livre, bit=1 → frame em uso.
+// Resumo: bit w = word w do bitmap cheia (32 frames em uso).
+// search_hint = primeira word do resumo que pode ter frame livre; só
+// avança quando a região abaixo enche e volta quando algo é liberado.
+//
+// Pool pré-zerado: pilha de frames já alocados e zerados no tempo ocioso.
+// pmm_alloc_zeroed_frame tira dali sem memset; o pool é mexido também
+// por page faults (IRQs podem tocar o heap), então push/pop são com cli,
+// assim como toda alteração do bitmap, do resumo e dos contadores.
 
 #include "pmm.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
+#include "../common/string.h"
+#include "../common/io.h"
 
 // ============================================================
 // Símbolo do linker: fim do kernel na memória
@@ -15,15 +25,32 @@
 extern uint32_t _kernel_end;
 
 // ============================================================
-// Bitmap de frames físicos
+// Bitmap de frames físicos + resumo
 // ============================================================
-static uint8_t pmm_bitmap[PMM_BITMAP_SIZE];
+// Dimensionados no boot a partir do memory map e alocados dentro da
+// primeira região disponível grande o bastante (acima do kernel)
+static uint32_t *pmm_bitmap = NULL;
+static uint32_t *pmm_summary = NULL;
+static uint32_t pmm_max_frames = 0;     // Frames cobertos (múltiplo de 1024)
+static uint32_t pmm_bitmap_words = 0;
+static uint32_t pmm_summary_words = 0;
+static uint32_t pmm_bitmap_frames = 0;  // Frames ocupados pelo bitmap + resumo
+static uint32_t search_hint = 0;        // Índice em pmm_summary
 
 // Estatísticas
 static uint32_t pmm_total_frames;
 static uint32_t pmm_used_frames;
 static uint32_t pmm_total_memory_kb;
 static uint32_t pmm_kernel_frames;
+static uint32_t pmm_contig_allocs;
+static uint32_t pmm_contig_failures;
+
+// Pool de frames pré-zerados
+static uint32_t zero_pool[PMM_ZERO_POOL_SIZE];
+static uint32_t zero_pool_count = 0;
+static uint32_t zero_hits = 0;
+static uint32_t zero_misses = 0;
+static uint32_t zero_refilled = 0;
 
 // Flag de inicialização
 static bool pmm_initialized = false;
@@ -32,24 +59,67 @@ static bool pmm_initialized = false;
 // Helpers de bitmap
 // ============================================================
 
-// Marca um frame como usado
+#define WORD_FULL 0xFFFFFFFFu
+
+// Marca um frame como usado (word cheia → marca no resumo)
 static inline void bitmap_set(uint32_t frame) {
-    if (frame < PMM_MAX_FRAMES) {
-        pmm_bitmap[frame / 8] |= (1 << (frame % 8));
+    if (frame < pmm_max_frames) {
+        uint32_t w = frame / 32;
+        pmm_bitmap[w] |= (1u << (frame % 32));
+        if (pmm_bitmap[w] == WORD_FULL) {
+            pmm_summary[w / 32] |= (1u << (w % 32));
+        }
     }
 }
 
 // Marca um frame como livre
 static inline void bitmap_clear(uint32_t frame) {
-    if (frame < PMM_MAX_FRAMES) {
-        pmm_bitmap[frame / 8] &= ~(1 << (frame % 8));
+    if (frame < pmm_max_frames) {
+        uint32_t w = frame / 32;
+        pmm_bitmap[w] &= ~(1u << (frame % 32));
+        pmm_summary[w / 32] &= ~(1u << (w % 32));
+        if (w / 32 < search_hint) search_hint = w / 32;
     }
 }
 
 // Verifica se um frame está em uso
 static inline bool bitmap_test(uint32_t frame) {
-    if (frame >= PMM_MAX_FRAMES) return true;  // Fora do range = "usado"
-    return (pmm_bitmap[frame / 8] & (1 << (frame % 8))) != 0;
+    if (frame >= pmm_max_frames) return true;  // Fora do range = "usado"
+    return (pmm_bitmap[frame / 32] & (1u << (frame % 32))) != 0;
+}
+
+// Maior frame em uso dentro de [first, first + count), ou -1 se todos livres
+// Testa uma word inteira (até 32 frames) por vez
+static int32_t last_used_in_range(uint32_t first, uint32_t count) {
+    uint32_t end = first + count;
+    int32_t last = -1;
+    uint32_t f = first;
+    while (f < end) {
+        uint32_t bit = f % 32;
+        uint32_t n = 32 - bit;
+        if (n > end - f) n = end - f;
+        uint32_t mask = (n == 32) ? WORD_FULL : (((1u << n) - 1) << bit);
+        uint32_t hit = pmm_bitmap[f / 32] & mask;
+        if (hit) last = (int32_t)((f / 32) * 32 + 31 - (uint32_t)__builtin_clz(hit));
+        f += n;
+    }
+    return last;
+}
+
+// Menor frame em uso dentro de [first, first + count), ou -1 se todos livres
+static int32_t first_used_in_range(uint32_t first, uint32_t count) {
+    uint32_t end = first + count;
+    uint32_t f = first;
+    while (f < end) {
+        uint32_t bit = f % 32;
+        uint32_t n = 32 - bit;
+        if (n > end - f) n = end - f;
+        uint32_t mask = (n == 32) ? WORD_FULL : (((1u << n) - 1) << bit);
+        uint32_t hit = pmm_bitmap[f / 32] & mask;
+        if (hit) return (int32_t)((f / 32) * 32 + (uint32_t)__builtin_ctz(hit));
+        f += n;
+    }
+    return -1;
 }
 
 // ============================================================
@@ -59,19 +129,77 @@ static inline uint32_t align_up(uint32_t addr, uint32_t align) {
     return (addr + align - 1) & ~(align - 1);
 }
 
+static inline uint32_t align_down(uint32_t addr, uint32_t align) {
+    return addr & ~(align - 1);
+}
+
+// Marca [first, first + count) como usado
+static void mark_range(uint32_t first, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) bitmap_set(first + i);
+    pmm_used_frames += count;
+}
+
 // ============================================================
-// pmm_init - Inicializa PMM via Multiboot2 memory map
+// Helpers do memory map Multiboot2
 // ============================================================
-void pmm_init(void *multiboot_info) {
-    // Zera bitmap (tudo "usado" por padrão para segurança)
-    for (uint32_t i = 0; i < PMM_BITMAP_SIZE; i++) {
-        pmm_bitmap[i] = 0xFF;
+
+// Procura o tag de memory map (tipo 6). NULL se não existe
+static struct mb2_tag_mmap *find_mmap_tag(void *multiboot_info) {
+    // Estrutura Multiboot2 info:
+    //   [0..3]  total_size (uint32_t)
+    //   [4..7]  reserved   (uint32_t)
+    //   [8..]   tags (alinhadas a 8 bytes)
+    struct mb2_tag *tag = (struct mb2_tag *)((uint8_t *)multiboot_info + 8);
+    while (tag->type != MB2_TAG_TYPE_END) {
+        if (tag->type == MB2_TAG_TYPE_MMAP) return (struct mb2_tag_mmap *)tag;
+        // Próximo tag (alinhado a 8 bytes)
+        tag = (struct mb2_tag *)((uint8_t *)tag + align_up(tag->size, 8));
     }
+    return NULL;
+}
+
+// Entrada número i do mmap (NULL depois da última)
+static struct mb2_mmap_entry *mmap_entry(struct mb2_tag_mmap *mmap, uint32_t i) {
+    uint32_t off = sizeof(struct mb2_tag_mmap) + i * mmap->entry_size;
+    if (off + sizeof(struct mb2_mmap_entry) > mmap->size) return NULL;
+    return (struct mb2_mmap_entry *)((uint8_t *)mmap + off);
+}
+
+// Frames inteiros [*first, *end) de uma região disponível abaixo de 4GB
+static bool entry_frames(const struct mb2_mmap_entry *e, uint32_t *first, uint32_t *end) {
+    if (e->type != MB2_MMAP_AVAILABLE || e->length == 0) return false;
+    uint64_t base = e->base_addr;
+    uint64_t top = base + e->length;
+    if (base >= PMM_PHYS_LIMIT) return false;
+    if (top > PMM_PHYS_LIMIT) top = PMM_PHYS_LIMIT;
+
+    *first = (uint32_t)((base + PMM_FRAME_SIZE - 1) / PMM_FRAME_SIZE);
+    *end = (uint32_t)(top / PMM_FRAME_SIZE);
+    return *end > *first;
+}
 
+// Marca [first, end) como usado se estava livre (regiões protegidas)
+static void protect_range(uint32_t first, uint32_t end) {
+    for (uint32_t f = first; f < end; f++) {
+        if (!bitmap_test(f)) {
+            bitmap_set(f);
+            pmm_used_frames++;
+        }
+    }
+}
+
+// ============================================================
+// pmm_init - Inicializa PMM via Multiboot2 memory map
+// ============================================================
+void pmm_init(void *multiboot_info) {
     pmm_total_frames = 0;
     pmm_used_frames = 0;
     pmm_total_memory_kb = 0;
     pmm_kernel_frames = 0;
+    pmm_contig_allocs = 0;
+    pmm_contig_failures = 0;
+    pmm_max_frames = 0;
+    pmm_bitmap_frames = 0;
 
     if (!multiboot_info) {
         vga_puts_color("[WARN] ", THEME_BOOT_FAIL);
@@ -79,112 +207,104 @@ void pmm_init(void *multiboot_info) {
         return;
     }
 
-    // ========================================================
-    // Parse das tags Multiboot2
-    // ========================================================
-    // Estrutura Multiboot2 info:
-    //   [0..3]  total_size (uint32_t)
-    //   [4..7]  reserved   (uint32_t)
-    //   [8..]   tags (alinhadas a 8 bytes)
     uint32_t mb_total_size = *(uint32_t *)multiboot_info;
-    (void)mb_total_size;
+    struct mb2_tag_mmap *mmap = find_mmap_tag(multiboot_info);
+    if (!mmap) {
+        vga_puts_color("[WARN] ", THEME_BOOT_FAIL);
+        vga_puts_color("PMM: Multiboot2 mmap nao encontrado!\n", THEME_ERROR);
+        return;
+    }
 
-    // Começa no primeiro tag (offset 8)
-    struct mb2_tag *tag = (struct mb2_tag *)((uint8_t *)multiboot_info + 8);
+    // Regiões que nunca podem receber o bitmap
+    uint32_t kernel_start_frame = 0x100000 / PMM_FRAME_SIZE;
+    uint32_t kernel_end_frame =
+        align_up((uint32_t)(uintptr_t)&_kernel_end, PMM_FRAME_SIZE) / PMM_FRAME_SIZE;
+    uint32_t mb_start = (uint32_t)(uintptr_t)multiboot_info;
+    uint32_t mb_start_frame = mb_start / PMM_FRAME_SIZE;
+    uint32_t mb_end_frame = align_up(mb_start + mb_total_size, PMM_FRAME_SIZE) / PMM_FRAME_SIZE;
 
-    bool found_mmap = false;
+    // ========================================================
+    // 1ª passada: RAM utilizável e maior endereço (até 4GB)
+    // ========================================================
+    uint32_t first, end;
+    uint32_t highest = 0;
+    for (uint32_t i = 0; mmap_entry(mmap, i); i++) {
+        if (!entry_frames(mmap_entry(mmap, i), &first, &end)) continue;
+        pmm_total_memory_kb += (end - first) * (PMM_FRAME_SIZE / 1024);
+        if (end > highest) highest = end;
+    }
 
-    while (tag->type != MB2_TAG_TYPE_END) {
-        if (tag->type == MB2_TAG_TYPE_MMAP) {
-            found_mmap = true;
-            struct mb2_tag_mmap *mmap_tag = (struct mb2_tag_mmap *)tag;
-            uint32_t entry_size = mmap_tag->entry_size;
-
-            // Itera pelas entradas do mmap
-            struct mb2_mmap_entry *entry = (struct mb2_mmap_entry *)((uint8_t *)mmap_tag + sizeof(struct mb2_tag_mmap));
-            struct mb2_mmap_entry *end = (struct mb2_mmap_entry *)((uint8_t *)mmap_tag + mmap_tag->size);
-
-            while (entry < end) {
-                uint32_t base = (uint32_t)entry->base_addr;
-                uint32_t length = (uint32_t)entry->length;
-
-                // Contabiliza memória total
-                pmm_total_memory_kb += length / 1024;
-
-                if (entry->type == MB2_MMAP_AVAILABLE && length > 0) {
-                    // Região disponível: marca frames como livres
-                    uint32_t start_frame = align_up(base, PMM_FRAME_SIZE) / PMM_FRAME_SIZE;
-                    uint32_t end_addr = base + length;
-                    uint32_t end_frame = end_addr / PMM_FRAME_SIZE;
-
-                    // Limita ao máximo suportado
-                    if (end_frame > PMM_MAX_FRAMES) {
-                        end_frame = PMM_MAX_FRAMES;
-                    }
-
-                    for (uint32_t f = start_frame; f < end_frame; f++) {
-                        bitmap_clear(f);
-                        pmm_total_frames++;
-                    }
-                }
-
-                // Próxima entrada (usa entry_size do tag)
-                entry = (struct mb2_mmap_entry *)((uint8_t *)entry + entry_size);
-            }
-        }
+    // Bitmap cobre até o último frame utilizável, arredondado para words
+    // inteiras do resumo (1024 frames)
+    pmm_max_frames = align_up(highest, 1024);
+    if (pmm_max_frames == 0 || pmm_max_frames > PMM_MAX_FRAMES) pmm_max_frames = PMM_MAX_FRAMES;
+    pmm_bitmap_words = pmm_max_frames / 32;
+    pmm_summary_words = pmm_bitmap_words / 32;
+    uint32_t bytes = (pmm_bitmap_words + pmm_summary_words) * sizeof(uint32_t);
+    pmm_bitmap_frames = align_up(bytes, PMM_FRAME_SIZE) / PMM_FRAME_SIZE;
 
-        // Próximo tag (alinhado a 8 bytes)
-        uint32_t tag_size = align_up(tag->size, 8);
-        tag = (struct mb2_tag *)((uint8_t *)tag + tag_size);
+    // ========================================================
+    // 2ª passada: primeira região disponível com espaço para o bitmap,
+    // acima do kernel e dentro do identity map
+    // ========================================================
+    uint32_t place = 0;
+    for (uint32_t i = 0; mmap_entry(mmap, i) && place == 0; i++) {
+        if (!entry_frames(mmap_entry(mmap, i), &first, &end)) continue;
+
+        uint32_t start = first;
+        if (start < kernel_end_frame) start = kernel_end_frame;
+        if (start < mb_end_frame && start + pmm_bitmap_frames > mb_start_frame) {
+            start = mb_end_frame;
+        }
+        if (start + pmm_bitmap_frames <= end &&
+            start + pmm_bitmap_frames <= PMM_BITMAP_MAX_PHYS / PMM_FRAME_SIZE) {
+            place = start;
+        }
     }
 
-    if (!found_mmap) {
+    if (place == 0) {
         vga_puts_color("[WARN] ", THEME_BOOT_FAIL);
-        vga_puts_color("PMM: Multiboot2 mmap nao encontrado!\n", THEME_ERROR);
+        vga_puts_color("PMM: sem regiao para o bitmap!\n", THEME_ERROR);
         return;
     }
 
+    pmm_bitmap = (uint32_t *)(uintptr_t)(place * PMM_FRAME_SIZE);
+    pmm_summary = pmm_bitmap + pmm_bitmap_words;
+
+    // Tudo "usado" por padrão para segurança
+    for (uint32_t i = 0; i < pmm_bitmap_words; i++) pmm_bitmap[i] = WORD_FULL;
+    for (uint32_t i = 0; i < pmm_summary_words; i++) pmm_summary[i] = WORD_FULL;
+    search_hint = pmm_summary_words;
+
+    // ========================================================
+    // 3ª passada: regiões disponíveis viram frames livres
+    // ========================================================
+    for (uint32_t i = 0; mmap_entry(mmap, i); i++) {
+        if (!entry_frames(mmap_entry(mmap, i), &first, &end)) continue;
+        if (end > pmm_max_frames) end = pmm_max_frames;
+        for (uint32_t f = first; f < end; f++) {
+            bitmap_clear(f);
+            pmm_total_frames++;
+        }
+    }
+
     // ========================================================
     // Protege regiões que não podem ser alocadas
     // ========================================================
 
     // 1. Protege memória baixa (0x00000 - 0xFFFFF = primeiro 1MB)
     //    Inclui IVT, BDA, VGA, ROM BIOS, etc.
-    uint32_t low_frames = 0x100000 / PMM_FRAME_SIZE;  // 256 frames
-    for (uint32_t f = 0; f < low_frames; f++) {
-        if (!bitmap_test(f)) {
-            bitmap_set(f);
-            pmm_used_frames++;
-        }
-    }
+    protect_range(0, kernel_start_frame);
 
     // 2. Protege o kernel (0x100000 até _kernel_end)
-    uint32_t kernel_start = 0x100000;
-    uint32_t kernel_end = align_up((uint32_t)(uintptr_t)&_kernel_end, PMM_FRAME_SIZE);
-    uint32_t kernel_start_frame = kernel_start / PMM_FRAME_SIZE;
-    uint32_t kernel_end_frame = kernel_end / PMM_FRAME_SIZE;
-
     pmm_kernel_frames = kernel_end_frame - kernel_start_frame;
-
-    for (uint32_t f = kernel_start_frame; f < kernel_end_frame; f++) {
-        if (!bitmap_test(f)) {
-            bitmap_set(f);
-            pmm_used_frames++;
-        }
-    }
+    protect_range(kernel_start_frame, kernel_end_frame);
 
     // 3. Protege a estrutura Multiboot2 info
-    uint32_t mb_start = (uint32_t)(uintptr_t)multiboot_info;
-    uint32_t mb_end = align_up(mb_start + mb_total_size, PMM_FRAME_SIZE);
-    uint32_t mb_start_frame = mb_start / PMM_FRAME_SIZE;
-    uint32_t mb_end_frame = mb_end / PMM_FRAME_SIZE;
+    protect_range(mb_start_frame, mb_end_frame);
 
-    for (uint32_t f = mb_start_frame; f < mb_end_frame; f++) {
-        if (!bitmap_test(f)) {
-            bitmap_set(f);
-            pmm_used_frames++;
-        }
-    }
+    // 4. Protege o próprio bitmap
+    protect_range(place, place + pmm_bitmap_frames);
 
     // Frame 0 nunca deve ser alocável (endereço 0 = NULL)
     if (!bitmap_test(0)) {
@@ -196,29 +316,205 @@ void pmm_init(void *multiboot_info) {
 }
 
 // ============================================================
-// pmm_alloc_frame - Aloca um frame físico (first-fit)
+// bitmap_alloc_frame - Aloca um frame do bitmap (first-fit via resumo)
+// ============================================================
+// Bitmap, resumo e contadores só mudam com IRQs desligadas: o idle loop
+// (refill do pool) e o page fault do heap podem alocar ao mesmo tempo
+// limit: só aceita frames abaixo dele (a busca sobe a partir do menor
+// frame livre, então o primeiro achado >= limit significa que não há)
+static uint32_t bitmap_alloc_frame(uint32_t limit) {
+    uint32_t flags = irq_save();
+
+    // Resumo abaixo de search_hint está todo cheio
+    for (uint32_t s = search_hint; s < pmm_summary_words; s++) {
+        if (pmm_summary[s] == WORD_FULL) continue;  // 1024 frames usados
+
+        uint32_t w = s * 32 + (uint32_t)__builtin_ctz(~pmm_summary[s]);
+        uint32_t frame = w * 32 + (uint32_t)__builtin_ctz(~pmm_bitmap[w]);
+        search_hint = s;
+        if (frame >= limit) {
+            // Há memória livre, mas só acima de limit: o hint continua válido
+            irq_restore(flags);
+            return 0;
+        }
+
+        bitmap_set(frame);
+        pmm_used_frames++;
+        irq_restore(flags);
+        return frame * PMM_FRAME_SIZE;
+    }
+
+    search_hint = pmm_summary_words;
+    irq_restore(flags);
+    return 0;  // Sem memória
+}
+
+// Frame para zerar pelo endereço físico: tem que estar no identity map
+static uint32_t low_alloc_frame(void) {
+    return bitmap_alloc_frame(PMM_DMA_MAX_PHYS / PMM_FRAME_SIZE);
+}
+
+// Tira um frame do pool pré-zerado (0 se vazio)
+static uint32_t zero_pool_pop(void) {
+    uint32_t flags = irq_save();
+    uint32_t frame = zero_pool_count ? zero_pool[--zero_pool_count] : 0;
+    irq_restore(flags);
+    return frame;
+}
+
+// ============================================================
+// pmm_alloc_frame - Aloca um frame físico
 // ============================================================
 uint32_t pmm_alloc_frame(void) {
     if (!pmm_initialized) return 0;
 
-    // Busca linear no bitmap (first-fit)
-    for (uint32_t i = 0; i < PMM_BITMAP_SIZE; i++) {
-        if (pmm_bitmap[i] == 0xFF) continue;  // Byte todo usado
+    uint32_t frame = bitmap_alloc_frame(pmm_max_frames);
+    if (frame == 0) frame = zero_pool_pop();  // Último recurso: o pool
+    return frame;
+}
+
+// ============================================================
+// Pool de frames pré-zerados
+// ============================================================
+
+uint32_t pmm_alloc_zeroed_frame(void) {
+    if (!pmm_initialized) return 0;
+
+    uint32_t frame = zero_pool_pop();
+    if (frame) {
+        uint32_t flags = irq_save();
+        zero_hits++;
+        irq_restore(flags);
+        return frame;
+    }
+
+    frame = low_alloc_frame();
+    if (frame == 0) return 0;
+    kmemset((void *)(uintptr_t)frame, 0, PMM_FRAME_SIZE);
+    uint32_t flags = irq_save();
+    zero_misses++;
+    irq_restore(flags);
+    return frame;
+}
 
-        // Encontra bit livre neste byte
-        for (int bit = 0; bit < 8; bit++) {
-            if (!(pmm_bitmap[i] & (1 << bit))) {
-                uint32_t frame = i * 8 + bit;
-                if (frame >= PMM_MAX_FRAMES) return 0;
+bool pmm_zero_pool_refill(void) {
+    if (!pmm_initialized || zero_pool_count >= PMM_ZERO_POOL_SIZE) return false;
 
-                bitmap_set(frame);
-                pmm_used_frames++;
-                return frame * PMM_FRAME_SIZE;
-            }
+    uint32_t done = 0;
+    while (done < PMM_ZERO_REFILL_BATCH && zero_pool_count < PMM_ZERO_POOL_SIZE) {
+        // Não prende os últimos frames livres no pool
+        if (pmm_total_frames - pmm_used_frames <= PMM_ZERO_POOL_SIZE) break;
+
+        uint32_t frame = low_alloc_frame();
+        if (frame == 0) break;
+
+        // Zera com IRQs habilitadas; só o push é atômico
+        kmemset((void *)(uintptr_t)frame, 0, PMM_FRAME_SIZE);
+
+        uint32_t flags = irq_save();
+        bool pushed = zero_pool_count < PMM_ZERO_POOL_SIZE;
+        if (pushed) zero_pool[zero_pool_count++] = frame;
+        irq_restore(flags);
+
+        if (!pushed) {
+            pmm_free_frame(frame);
+            break;
         }
+        flags = irq_save();
+        zero_refilled++;
+        irq_restore(flags);
+        done++;
     }
+    return done > 0;
+}
 
-    return 0;  // Sem memória
+// ============================================================
+// pmm_alloc_frames - Aloca count frames contíguos e alinhados
+// ============================================================
+uint32_t pmm_alloc_frames(uint32_t count, uint32_t align) {
+    if (!pmm_initialized || count == 0 || count > pmm_max_frames) return 0;
+    if (align == 0) align = 1;
+    if (align & (align - 1)) return 0;
+    if (count == 1 && align == 1) return pmm_alloc_frame();
+
+    uint32_t flags = irq_save();
+    uint32_t f = align_up(search_hint * 1024, align);
+    while (f < pmm_max_frames && count <= pmm_max_frames - f) {
+        uint32_t w = f / 32;
+
+        // Pula blocos cheios pelo resumo e words cheias pelo bitmap
+        if (pmm_summary[w / 32] == WORD_FULL) {
+            f = align_up((w / 32 + 1) * 1024, align);
+            continue;
+        }
+        if (pmm_bitmap[w] == WORD_FULL) {
+            f = align_up((w + 1) * 32, align);
+            continue;
+        }
+
+        int32_t used = last_used_in_range(f, count);
+        if (used < 0) {
+            mark_range(f, count);
+            irq_restore(flags);
+            return f * PMM_FRAME_SIZE;
+        }
+
+        // Próximo candidato alinhado depois do último frame ocupado
+        f = align_up((uint32_t)used + 1, align);
+    }
+
+    irq_restore(flags);
+    return 0;  // Nenhum intervalo livre
+}
+
+// ============================================================
+// pmm_alloc_contiguous - Intervalo contíguo para DMA, abaixo de max_phys
+// ============================================================
+// Busca de cima para baixo: buffers de DMA ficam no topo da janela
+// permitida, longe da região baixa que pmm_alloc_frame vai enchendo
+// (kernel, heap, tabelas de página), e não a fragmentam.
+uint32_t pmm_alloc_contiguous(uint32_t frames, uint32_t alignment, uint32_t max_phys) {
+    if (!pmm_initialized || frames == 0) return 0;
+
+    if (alignment < PMM_FRAME_SIZE) alignment = PMM_FRAME_SIZE;
+    if (alignment & (alignment - 1)) return 0;
+    uint32_t align = alignment / PMM_FRAME_SIZE;
+
+    uint32_t limit = (max_phys == 0) ? pmm_max_frames : max_phys / PMM_FRAME_SIZE;
+    if (limit > pmm_max_frames) limit = pmm_max_frames;
+    if (frames > limit) return 0;
+
+    uint32_t flags = irq_save();
+    uint32_t f = align_down(limit - frames, align);
+    for (;;) {
+        // Última word do candidato cheia: desce para antes dela
+        uint32_t w = (f + frames - 1) / 32;
+        if (pmm_bitmap[w] == WORD_FULL) {
+            if (w * 32 < frames) break;
+            f = align_down(w * 32 - frames, align);
+            continue;
+        }
+
+        int32_t used = first_used_in_range(f, frames);
+        if (used < 0) {
+            mark_range(f, frames);
+            pmm_contig_allocs++;
+            irq_restore(flags);
+            return f * PMM_FRAME_SIZE;
+        }
+
+        // Próximo candidato termina antes do primeiro frame ocupado
+        if ((uint32_t)used < frames) break;
+        f = align_down((uint32_t)used - frames, align);
+    }
+
+    pmm_contig_failures++;
+    irq_restore(flags);
+    return 0;
+}
+
+void pmm_free_contiguous(uint32_t phys, uint32_t frames) {
+    pmm_free_frames(phys, frames);
 }
 
 // ============================================================
@@ -231,15 +527,26 @@ void pmm_free_frame(uint32_t frame_addr) {
     if (frame_addr % PMM_FRAME_SIZE != 0) return;
 
     uint32_t frame = frame_addr / PMM_FRAME_SIZE;
-    if (frame >= PMM_MAX_FRAMES) return;
+    if (frame >= pmm_max_frames) return;
 
     // Só libera se estava em uso (previne double-free)
+    uint32_t flags = irq_save();
     if (bitmap_test(frame)) {
         bitmap_clear(frame);
         if (pmm_used_frames > 0) {
             pmm_used_frames--;
         }
     }
+    irq_restore(flags);
+}
+
+// ============================================================
+// pmm_free_frames - Libera um intervalo contíguo
+// ============================================================
+void pmm_free_frames(uint32_t frame_addr, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        pmm_free_frame(frame_addr + i * PMM_FRAME_SIZE);
+    }
 }
 
 // ============================================================
@@ -254,6 +561,26 @@ bool pmm_is_frame_used(uint32_t frame_addr) {
 // ============================================================
 // pmm_get_stats - Retorna estatísticas do PMM
 // ============================================================
+// Bits setados numa word (sem libgcc: __builtin_popcount vira chamada)
+static inline uint32_t popcount32(uint32_t v) {
+    v = v - ((v >> 1) & 0x55555555u);
+    v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+    return (((v + (v >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+// Frames livres a partir de PMM_DMA_MAX_PHYS (fora do identity map)
+static uint32_t count_free_high(void) {
+    uint32_t first_word = PMM_DMA_MAX_PHYS / PMM_FRAME_SIZE / 32;
+    uint32_t used = 0;
+    uint32_t flags = irq_save();
+    for (uint32_t w = first_word; w < pmm_bitmap_words; w++) {
+        used += popcount32(pmm_bitmap[w]);
+    }
+    irq_restore(flags);
+    uint32_t words = pmm_bitmap_words > first_word ? pmm_bitmap_words - first_word : 0;
+    return words * 32 - used;
+}
+
 struct pmm_stats pmm_get_stats(void) {
     struct pmm_stats stats;
     stats.total_frames = pmm_total_frames;
@@ -264,5 +591,14 @@ struct pmm_stats pmm_get_stats(void) {
     stats.used_memory_kb = pmm_used_frames * (PMM_FRAME_SIZE / 1024);
     stats.free_memory_kb = stats.free_frames * (PMM_FRAME_SIZE / 1024);
     stats.kernel_frames = pmm_kernel_frames;
+    stats.contig_allocs = pmm_contig_allocs;
+    stats.contig_failures = pmm_contig_failures;
+    stats.tracked_frames = pmm_max_frames;
+    stats.bitmap_frames = pmm_bitmap_frames;
+    stats.zero_pool = zero_pool_count;
+    stats.zero_hits = zero_hits;
+    stats.zero_misses = zero_misses;
+    stats.zero_refilled = zero_refilled;
+    stats.high_free_frames = count_free_high();
     return stats;
 }
@@ -1,9 +1,13 @@
 // LeonardOS - PMM (Physical Memory Manager)
-// Gerencia frames de 4KB de memória física usando bitmap
+// Gerencia frames de 4KB de memória física usando bitmap de dois níveis
 //
 // Lê o mapa de memória do Multiboot2 para descobrir a RAM disponível.
 // Marca regiões do kernel e reservadas como usadas.
-// API: pmm_alloc_frame, pmm_free_frame, pmm_get_stats
+// Nível 0: 1 bit por frame (words de 32). Nível 1 (resumo): 1 bit por
+// word do nível 0, setado quando a word está cheia — a busca pula blocos
+// de 1024 frames ocupados sem ler o bitmap.
+// API: pmm_alloc_frame, pmm_alloc_frames, pmm_alloc_contiguous,
+//      pmm_free_frame, pmm_free_frames, pmm_free_contiguous, pmm_get_stats
 
 #ifndef __PMM_H__
 #define __PMM_H__
@@ -13,11 +17,24 @@
 // Tamanho de um frame (4KB)
 #define PMM_FRAME_SIZE 4096
 
-// Máximo de memória suportada: 256MB = 65536 frames
-// Bitmap: 65536 bits = 8192 bytes = 8KB
-#define PMM_MAX_MEMORY_MB  256
-#define PMM_MAX_FRAMES     ((PMM_MAX_MEMORY_MB * 1024 * 1024) / PMM_FRAME_SIZE)
-#define PMM_BITMAP_SIZE    (PMM_MAX_FRAMES / 8)
+// Limite de endereçamento físico (paging de 32 bits sem PAE): 4GB
+// O bitmap é dimensionado no boot pelo maior endereço utilizável do
+// memory map: 1 bit por frame + 1 bit de resumo por word (4GB → ~132KB)
+#define PMM_PHYS_LIMIT     0x100000000ULL
+#define PMM_MAX_FRAMES     ((uint32_t)(PMM_PHYS_LIMIT / PMM_FRAME_SIZE))   // 1M frames
+
+// O bitmap é acessado por ponteiro desde o boot: precisa ficar no identity map
+#define PMM_BITMAP_MAX_PHYS 0x01000000  // 16MB
+
+// Limite para buffers de DMA: dentro do identity map (phys == virt)
+// Também vale para todo consumidor que acessa frames pelo endereço físico:
+// bcache, pbuf, arena, slab, RAM disk, page tables. RAM acima de 16MB só é
+// usada pelo heap sob demanda (mapeada no page fault); "mem" mostra quanto
+#define PMM_DMA_MAX_PHYS   0x01000000   // 16MB
+
+// Pool de frames pré-zerados, reposto no tempo ocioso (antes do hlt)
+#define PMM_ZERO_POOL_SIZE    32     // Frames guardados (128KB)
+#define PMM_ZERO_REFILL_BATCH 8      // Frames zerados por chamada de refill
 
 // ============================================================
 // Estruturas Multiboot2 (simplificadas, só o que precisamos)
@@ -64,10 +81,19 @@ struct pmm_stats {
     uint32_t total_frames;     // Total de frames disponíveis
     uint32_t used_frames;      // Frames em uso
     uint32_t free_frames;      // Frames livres
-    uint32_t total_memory_kb;  // RAM total em KB
+    uint32_t total_memory_kb;  // RAM utilizável em KB (regiões disponíveis < 4GB)
     uint32_t free_memory_kb;   // RAM livre em KB
     uint32_t used_memory_kb;   // RAM usada em KB
     uint32_t kernel_frames;    // Frames do kernel
+    uint32_t contig_allocs;    // pmm_alloc_contiguous bem-sucedidos
+    uint32_t contig_failures;  // pmm_alloc_contiguous sem intervalo
+    uint32_t tracked_frames;   // Frames cobertos pelo bitmap (até o maior endereço)
+    uint32_t bitmap_frames;    // Frames ocupados pelo bitmap + resumo
+    uint32_t zero_pool;        // Frames zerados à espera (contam como usados)
+    uint32_t zero_hits;        // pmm_alloc_zeroed_frame servidos pelo pool
+    uint32_t zero_misses;      // pmm_alloc_zeroed_frame que zeraram na hora
+    uint32_t zero_refilled;    // Frames zerados no tempo ocioso
+    uint32_t high_free_frames; // Livres acima de PMM_DMA_MAX_PHYS (só heap)
 };
 
 // ============================================================
@@ -78,13 +104,43 @@ struct pmm_stats {
 // multiboot_info: ponteiro passado pelo GRUB (EBX no boot)
 void pmm_init(void *multiboot_info);
 
-// Aloca um frame físico de 4KB
+// Aloca um frame físico de 4KB (o de menor endereço livre, O(1) amortizado)
+// Com o bitmap esgotado, usa um frame do pool pré-zerado
 // Retorna endereço físico do frame, ou 0 se não há memória
 uint32_t pmm_alloc_frame(void);
 
+// Aloca count frames fisicamente contíguos, com o primeiro alinhado a
+// align frames (potência de 2; 0 ou 1 = sem alinhamento)
+// Retorna endereço físico do primeiro frame, ou 0 se não há intervalo
+uint32_t pmm_alloc_frames(uint32_t count, uint32_t align);
+
+// Aloca um frame de 4KB já zerado: sai do pool pré-zerado se houver,
+// senão aloca e zera na hora. O frame é zerado pelo endereço físico, então
+// vem sempre de baixo de PMM_DMA_MAX_PHYS (identity map)
+// Retorna 0 se não há memória abaixo desse limite
+uint32_t pmm_alloc_zeroed_frame(void);
+
+// Repõe o pool de frames zerados (até PMM_ZERO_REFILL_BATCH por chamada)
+// Chamada pelos laços ociosos (pit_sleep_ms, kbd_getchar) antes do hlt
+// Retorna true se zerou algum frame (o chamador revê sua condição
+// antes de dormir)
+bool pmm_zero_pool_refill(void);
+
 // Libera um frame físico previamente alocado
 void pmm_free_frame(uint32_t frame_addr);
 
+// Libera count frames contíguos a partir de frame_addr
+void pmm_free_frames(uint32_t frame_addr, uint32_t count);
+
+// Aloca frames contíguos para DMA: primeiro frame alinhado a alignment
+// bytes (potência de 2, mínimo 4KB) e o intervalo inteiro abaixo de
+// max_phys (0 = sem limite). Escolhe o intervalo mais alto que couber.
+// Retorna o endereço físico, ou 0 se não há intervalo
+uint32_t pmm_alloc_contiguous(uint32_t frames, uint32_t alignment, uint32_t max_phys);
+
+// Libera um intervalo obtido com pmm_alloc_contiguous
+void pmm_free_contiguous(uint32_t phys, uint32_t frames);
+
 // Verifica se um frame está em uso
 bool pmm_is_frame_used(uint32_t frame_addr);
 
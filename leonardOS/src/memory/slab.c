@@ -0,0 +1,198 @@
+// LeonardOS - Slab Allocator (caches de objetos de tamanho fixo)
+// Implementação: um frame do PMM por slab, três listas por cache
+//
+// Estrutura de um slab (frame de 4KB):
+//   [kmem_slab_t][pad até 8][obj 0][obj 1]...[obj n-1]
+//   Objetos livres formam uma lista encadeada pelo primeiro word
+//
+// Listas do cache:
+//   partial — alocação sai daqui primeiro (mantém slabs cheios densos)
+//   full    — só voltam para partial quando um objeto é liberado
+//   empty   — reserva de SLAB_KEEP_EMPTY slabs; excedente volta ao PMM
+
+#include "slab.h"
+#include "pmm.h"
+#include "../common/string.h"
+
+// ============================================================
+// Estado global
+// ============================================================
+static kmem_cache_t caches[SLAB_MAX_CACHES];
+static int cache_count = 0;
+
+// Offset do primeiro objeto dentro do frame
+#define SLAB_OBJ_OFFSET \
+    ((sizeof(kmem_slab_t) + SLAB_ALIGNMENT - 1) & ~(uint32_t)(SLAB_ALIGNMENT - 1))
+
+// ============================================================
+// Listas duplamente encadeadas de slabs
+// ============================================================
+
+static void slab_list_push(kmem_slab_t **head, kmem_slab_t *s) {
+    s->prev = NULL;
+    s->next = *head;
+    if (*head) (*head)->prev = s;
+    *head = s;
+}
+
+static void slab_list_remove(kmem_slab_t **head, kmem_slab_t *s) {
+    if (s->prev) s->prev->next = s->next;
+    else *head = s->next;
+    if (s->next) s->next->prev = s->prev;
+    s->next = s->prev = NULL;
+}
+
+// ============================================================
+// slab_new — Obtém um frame e monta a lista livre dos objetos
+// ============================================================
+static kmem_slab_t *slab_new(kmem_cache_t *cache) {
+    // Abaixo de 16MB: o free lê o header pelo identity map
+    uint32_t frame = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (frame == 0) return NULL;
+
+    kmem_slab_t *s = (kmem_slab_t *)(uintptr_t)frame;
+    s->next = s->prev = NULL;
+    s->magic = SLAB_MAGIC;
+    s->cache = cache;
+    s->inuse = 0;
+
+    // Encadeia do último para o primeiro: free_list começa no objeto 0
+    uint8_t *base = (uint8_t *)s + SLAB_OBJ_OFFSET;
+    void *next = NULL;
+    for (uint32_t i = cache->objs_per_slab; i > 0; i--) {
+        void *obj = base + (i - 1) * cache->obj_size;
+        *(void **)obj = next;
+        next = obj;
+    }
+    s->free_list = next;
+
+    cache->slabs++;
+    return s;
+}
+
+// ============================================================
+// kmem_cache_create — Registra um cache
+// ============================================================
+kmem_cache_t *kmem_cache_create(const char *name, uint32_t size) {
+    if (!name || size == 0 || size > SLAB_MAX_OBJ_SIZE) return NULL;
+
+    // Objeto livre guarda o ponteiro da lista: precisa caber um void*
+    if (size < sizeof(void *)) size = sizeof(void *);
+    size = (size + SLAB_ALIGNMENT - 1) & ~(uint32_t)(SLAB_ALIGNMENT - 1);
+
+    // Mesmo nome com outro tamanho é erro do chamador, não um cache compartilhado
+    for (int i = 0; i < cache_count; i++) {
+        if (kstrcmp(caches[i].name, name) == 0)
+            return caches[i].obj_size == size ? &caches[i] : NULL;
+    }
+    if (cache_count >= SLAB_MAX_CACHES) return NULL;
+
+    kmem_cache_t *cache = &caches[cache_count++];
+    kmemset(cache, 0, sizeof(kmem_cache_t));
+    kstrcpy(cache->name, name, SLAB_NAME_LEN);
+    cache->obj_size = size;
+    cache->objs_per_slab = (PMM_FRAME_SIZE - SLAB_OBJ_OFFSET) / size;
+    return cache;
+}
+
+// ============================================================
+// kmem_cache_alloc — O(1): primeiro slab parcial, senão vazio/novo
+// ============================================================
+void *kmem_cache_alloc(kmem_cache_t *cache) {
+    if (!cache) return NULL;
+
+    kmem_slab_t *s = cache->partial;
+    if (!s) {
+        if (cache->empty) {
+            s = cache->empty;
+            slab_list_remove(&cache->empty, s);
+            cache->empty_count--;
+        } else {
+            s = slab_new(cache);
+            if (!s) {
+                cache->failures++;
+                return NULL;
+            }
+        }
+        slab_list_push(&cache->partial, s);
+    }
+
+    void *obj = s->free_list;
+    s->free_list = *(void **)obj;
+    s->inuse++;
+
+    if (s->inuse == cache->objs_per_slab) {
+        slab_list_remove(&cache->partial, s);
+        slab_list_push(&cache->full, s);
+    }
+
+    cache->active++;
+    cache->allocs++;
+    return obj;
+}
+
+// ============================================================
+// kmem_cache_free — O(1): slab = endereço alinhado ao frame
+// ============================================================
+void kmem_cache_free(kmem_cache_t *cache, void *obj) {
+    if (!cache || !obj) return;
+
+    // Só lê o header de frames do identity map que o PMM marca como usados
+    uintptr_t frame = (uintptr_t)obj & ~(uintptr_t)(PMM_FRAME_SIZE - 1);
+    if (frame >= PMM_DMA_MAX_PHYS || !pmm_is_frame_used((uint32_t)frame)) return;
+
+    kmem_slab_t *s = (kmem_slab_t *)frame;
+    if (s->magic != SLAB_MAGIC || s->cache != cache || s->inuse == 0) return;
+
+    uint32_t off = (uint32_t)((uint8_t *)obj - (uint8_t *)s);
+    if (off < SLAB_OBJ_OFFSET || (off - SLAB_OBJ_OFFSET) % cache->obj_size != 0) return;
+    if ((off - SLAB_OBJ_OFFSET) / cache->obj_size >= cache->objs_per_slab) return;
+
+    bool was_full = (s->inuse == cache->objs_per_slab);
+    *(void **)obj = s->free_list;
+    s->free_list = obj;
+    s->inuse--;
+    cache->active--;
+    cache->frees++;
+
+    if (was_full) {
+        slab_list_remove(&cache->full, s);
+        slab_list_push(&cache->partial, s);
+    }
+
+    if (s->inuse == 0) {
+        slab_list_remove(&cache->partial, s);
+        if (cache->empty_count < SLAB_KEEP_EMPTY) {
+            slab_list_push(&cache->empty, s);
+            cache->empty_count++;
+        } else {
+            s->magic = 0;
+            s->cache = NULL;
+            pmm_free_contiguous((uint32_t)(uintptr_t)s, 1);
+            cache->slabs--;
+        }
+    }
+}
+
+// ============================================================
+// Estatísticas
+// ============================================================
+int kmem_cache_count(void) {
+    return cache_count;
+}
+
+bool kmem_cache_get_stats(int index, kmem_cache_stats_t *out) {
+    if (index < 0 || index >= cache_count || !out) return false;
+
+    kmem_cache_t *c = &caches[index];
+    out->name = c->name;
+    out->obj_size = c->obj_size;
+    out->objs_per_slab = c->objs_per_slab;
+    out->slabs = c->slabs;
+    out->active_objs = c->active;
+    out->total_objs = c->slabs * c->objs_per_slab;
+    out->allocs = c->allocs;
+    out->frees = c->frees;
+    out->failures = c->failures;
+    return true;
+}
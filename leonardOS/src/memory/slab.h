@@ -0,0 +1,92 @@
+// LeonardOS - Slab Allocator (caches de objetos de tamanho fixo)
+// Objetos do mesmo tamanho saem de frames do PMM dedicados ao cache
+//
+// Cada slab é um frame de 4KB: header (kmem_slab_t) no início e objetos
+// em seguida, com lista livre embutida nos próprios objetos livres.
+// Alocar e liberar são O(1), sem header por objeto (ao contrário do kmalloc).
+// Slabs vêm de frames abaixo de 16MB (identity map), então o slab de um objeto é
+// simplesmente o endereço alinhado a 4KB.
+// API: kmem_cache_create, kmem_cache_alloc, kmem_cache_free,
+//      kmem_cache_count, kmem_cache_get_stats
+
+#ifndef __SLAB_H__
+#define __SLAB_H__
+
+#include "../common/types.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+#define SLAB_MAX_CACHES      16      // Caches registrados no máximo
+#define SLAB_NAME_LEN        16
+#define SLAB_ALIGNMENT       8       // Alinhamento dos objetos
+#define SLAB_MAX_OBJ_SIZE    2048    // Objetos maiores: use kmalloc
+#define SLAB_KEEP_EMPTY      1       // Slabs vazios mantidos por cache (resto volta ao PMM)
+#define SLAB_MAGIC           0x51AB51AB  // Marca um frame que é slab vivo
+
+// ============================================================
+// Estruturas
+// ============================================================
+
+typedef struct kmem_cache kmem_cache_t;
+
+// Header no início de cada frame de slab
+typedef struct kmem_slab {
+    struct kmem_slab *next;     // Lista do cache (parcial / cheio / vazio)
+    struct kmem_slab *prev;
+    uint32_t          magic;    // SLAB_MAGIC enquanto o frame é slab
+    kmem_cache_t     *cache;    // Dono (validação no free)
+    void             *free_list;// Primeiro objeto livre (próximo no 1º word)
+    uint32_t          inuse;    // Objetos alocados neste slab
+} kmem_slab_t;
+
+struct kmem_cache {
+    char         name[SLAB_NAME_LEN];
+    uint32_t     obj_size;      // Tamanho alinhado a SLAB_ALIGNMENT
+    uint32_t     objs_per_slab;
+    kmem_slab_t *partial;       // Slabs com objetos livres e em uso
+    kmem_slab_t *full;          // Slabs sem objetos livres
+    kmem_slab_t *empty;         // Slabs totalmente livres (até SLAB_KEEP_EMPTY)
+    uint32_t     empty_count;
+    uint32_t     slabs;         // Frames em uso pelo cache
+    uint32_t     active;        // Objetos alocados
+    uint32_t     allocs;        // Total de kmem_cache_alloc
+    uint32_t     frees;         // Total de kmem_cache_free
+    uint32_t     failures;      // Allocs sem frame disponível
+};
+
+typedef struct {
+    const char *name;
+    uint32_t obj_size;
+    uint32_t objs_per_slab;
+    uint32_t slabs;             // Frames de 4KB
+    uint32_t active_objs;       // Em uso
+    uint32_t total_objs;        // Capacidade dos slabs atuais
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t failures;
+} kmem_cache_stats_t;
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Cria (ou retorna, se o nome já existe com o mesmo size) um cache para
+// objetos de size bytes. Nenhum frame é alocado até o primeiro kmem_cache_alloc
+// Retorna NULL se size é inválido, difere do cache existente com esse nome,
+// ou a tabela de caches está cheia
+kmem_cache_t *kmem_cache_create(const char *name, uint32_t size);
+
+// Aloca um objeto (conteúdo indefinido). NULL se sem memória
+void *kmem_cache_alloc(kmem_cache_t *cache);
+
+// Devolve um objeto ao seu cache. Ponteiros que não são objeto vivo de um
+// slab deste cache (outro cache, heap, pilha) são ignorados
+void kmem_cache_free(kmem_cache_t *cache, void *obj);
+
+// Caches registrados (para o comando mem)
+int kmem_cache_count(void);
+bool kmem_cache_get_stats(int index, kmem_cache_stats_t *out);
+
+#endif
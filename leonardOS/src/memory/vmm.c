@@ -3,17 +3,27 @@
 //
 // Inicialização:
 //   1. Aloca Page Directory (1 frame) via PMM
-//   2. Aloca Page Tables necessárias via PMM
-//   3. Preenche identity map (virtual == physical) para 16MB
-//   4. Carrega CR3 com endereço do Page Directory
-//   5. Seta bit 31 (PG) de CR0 para habilitar paging
-//   6. Registra page fault handler (INT 14)
+//   2. Com PSE: uma PDE de 4MB por 4MB do identity map
+//      Sem PSE: aloca Page Tables via PMM e preenche as 1024 PTEs
+//   3. Identity map (virtual == physical) para 16MB
+//   4. Carrega CR3, seta CR4.PSE (se usado) e bit 31 (PG) de CR0
+//   5. Registra page fault handler (INT 14)
+//
+// Page fault "não presente" dentro de uma região sob demanda (ex: janela
+// do heap) é resolvido aqui: aloca um frame, mapeia e retorna — a
+// instrução que falhou é reexecutada. Qualquer outro fault é fatal.
+//
+// PDE de 4MB vs 4KB: o walk de uma página grande para no Page Directory
+// e ocupa uma entrada de TLB para 4MB (kernel, VGA, buffers de DMA).
+// map_page/unmap_page dentro de uma PDE grande a dividem primeiro
+// (split_large_page), então mapeamentos de 4KB continuam funcionando.
 
 #include "vmm.h"
 #include "pmm.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
 #include "../cpu/isr.h"
+#include "../common/string.h"
 
 // ============================================================
 // Estado interno do VMM
@@ -27,8 +37,25 @@ static uint32_t *page_directory = NULL;
 static uint32_t vmm_pages_mapped = 0;
 static uint32_t vmm_page_tables_used = 0;
 static uint32_t vmm_page_faults = 0;
+static uint32_t vmm_large_pages = 0;
+static uint32_t vmm_large_splits = 0;
+
+static uint32_t vmm_demand_faults = 0;
+static uint32_t vmm_demand_released = 0;
 
 static bool vmm_initialized = false;
+static bool vmm_pse = false;
+
+// Regiões sob demanda
+typedef struct {
+    uint32_t start;
+    uint32_t end;           // Exclusivo
+    uint32_t flags;         // Flags das páginas mapeadas no fault
+    uint32_t resident;      // Páginas com frame
+} demand_region_t;
+
+static demand_region_t demand_regions[VMM_MAX_DEMAND_REGIONS];
+static int demand_region_count = 0;
 
 // ============================================================
 // Helpers inline ASM
@@ -54,6 +81,21 @@ static inline void enable_paging(void) {
     asm volatile("mov %0, %%cr0" :: "r"(cr0) : "memory");
 }
 
+// CPUID.1:EDX bit 3 — CPU suporta páginas de 4MB (PSE)
+static inline bool cpu_has_pse(void) {
+    uint32_t eax = 1, ebx, ecx = 0, edx;
+    asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return (edx & (1 << 3)) != 0;
+}
+
+// Seta CR4.PSE (precisa estar ativo antes de usar PDEs com PAGE_SIZE_4MB)
+static inline void enable_pse(void) {
+    uint32_t cr4;
+    asm volatile("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= CR4_PSE;
+    asm volatile("mov %0, %%cr4" :: "r"(cr4) : "memory");
+}
+
 // Lê CR2 (endereço virtual que causou page fault)
 static inline uint32_t read_cr2(void) {
     uint32_t val;
@@ -66,13 +108,14 @@ static inline void invlpg(uint32_t addr) {
     asm volatile("invlpg (%0)" :: "r"(addr) : "memory");
 }
 
-// ============================================================
-// Zera um frame (4096 bytes = 1024 uint32_t)
-// ============================================================
-static void zero_frame(uint32_t *frame) {
-    for (int i = 0; i < 1024; i++) {
-        frame[i] = 0;
+// Região sob demanda que contém addr (NULL se nenhuma)
+static demand_region_t *demand_region_of(uint32_t addr) {
+    for (int i = 0; i < demand_region_count; i++) {
+        if (addr >= demand_regions[i].start && addr < demand_regions[i].end) {
+            return &demand_regions[i];
+        }
     }
+    return NULL;
 }
 
 // ============================================================
@@ -80,7 +123,6 @@ static void zero_frame(uint32_t *frame) {
 // ============================================================
 static void page_fault_handler(struct isr_frame *frame) {
     uint32_t fault_addr = read_cr2();
-    vmm_page_faults++;
 
     // Error code bits:
     // bit 0: 0 = page not present, 1 = protection violation
@@ -88,6 +130,29 @@ static void page_fault_handler(struct isr_frame *frame) {
     // bit 2: 0 = kernel mode, 1 = user mode
     uint32_t err = frame->err_code;
 
+    // Página ainda sem frame numa região sob demanda: aloca e retorna
+    demand_region_t *r = (err & 0x1) ? NULL : demand_region_of(fault_addr);
+    if (r) {
+        // Memória sob demanda começa zerada (do pool, se estiver quente).
+        // Sem frame baixo, usa qualquer frame e zera pelo novo mapeamento
+        uint32_t phys = pmm_alloc_zeroed_frame();
+        bool zeroed = phys != 0;
+        if (!zeroed) phys = pmm_alloc_frame();
+        if (phys != 0) {
+            map_page(fault_addr & PAGE_ADDR_MASK, phys, r->flags);
+            if (is_page_mapped(fault_addr)) {
+                if (!zeroed) kmemset((void *)(fault_addr & PAGE_ADDR_MASK), 0, PAGE_SIZE);
+                r->resident++;
+                vmm_demand_faults++;
+                return;
+            }
+            pmm_free_frame(phys);   // Sem frame para a Page Table
+        }
+        vga_puts_color("\n[PAGE FAULT] Sem memoria para pagina sob demanda", THEME_BOOT_FAIL);
+    }
+
+    vmm_page_faults++;
+
     vga_puts_color("\n[PAGE FAULT] ", THEME_BOOT_FAIL);
     vga_puts_color("Endereco: 0x", THEME_ERROR);
     vga_puthex(fault_addr);
@@ -115,8 +180,8 @@ static void page_fault_handler(struct isr_frame *frame) {
 // paging_init — Identity mapping dos primeiros 16MB
 // ============================================================
 void paging_init(void) {
-    // 1. Aloca frame para o Page Directory
-    uint32_t pd_phys = pmm_alloc_frame();
+    // 1. Aloca frame (zerado) para o Page Directory
+    uint32_t pd_phys = pmm_alloc_zeroed_frame();
     if (pd_phys == 0) {
         vga_puts_color("[FAIL] ", THEME_BOOT_FAIL);
         vga_puts_color("VMM: sem memoria para Page Directory!\n", THEME_ERROR);
@@ -124,12 +189,19 @@ void paging_init(void) {
     }
 
     page_directory = (uint32_t *)pd_phys;
-    zero_frame(page_directory);
 
-    // 2. Identity map: 16MB = 4 Page Tables (cada PT cobre 4MB)
+    // 2. Identity map: 16MB = 4 PDEs (cada uma cobre 4MB)
     uint32_t num_tables = PAGING_IDENTITY_MAP_MB / 4;
+    vmm_pse = cpu_has_pse();
 
-    for (uint32_t t = 0; t < num_tables; t++) {
+    for (uint32_t t = 0; vmm_pse && t < num_tables; t++) {
+        // Página de 4MB: a PDE aponta direto para a base física
+        page_directory[t] = (t * PAGE_TABLE_COVERAGE) | PAGE_KERNEL | PAGE_SIZE_4MB;
+        vmm_pages_mapped += PAGE_ENTRIES;
+        vmm_large_pages++;
+    }
+
+    for (uint32_t t = 0; !vmm_pse && t < num_tables; t++) {
         // Aloca frame para esta Page Table
         uint32_t pt_phys = pmm_alloc_frame();
         if (pt_phys == 0) {
@@ -139,9 +211,8 @@ void paging_init(void) {
         }
 
         uint32_t *page_table = (uint32_t *)pt_phys;
-        zero_frame(page_table);
 
-        // Preenche as 1024 entradas desta Page Table
+        // Preenche as 1024 entradas desta Page Table (não precisa zerar)
         // Cada entrada mapeia um frame de 4KB
         for (uint32_t p = 0; p < PAGE_ENTRIES; p++) {
             uint32_t phys_addr = (t * PAGE_TABLE_COVERAGE) + (p * PAGE_SIZE);
@@ -157,13 +228,54 @@ void paging_init(void) {
     // 3. Registra o page fault handler ANTES de habilitar paging
     isr_register_handler(ISR_PAGE_FAULT, page_fault_handler);
 
-    // 4. Carrega CR3 e habilita paging
+    // 4. Carrega CR3, habilita PSE (antes do PG) e paging
     load_cr3(pd_phys);
+    if (vmm_pse) enable_pse();
     enable_paging();
 
     vmm_initialized = true;
 }
 
+// ============================================================
+// split_large_page — Converte uma PDE de 4MB numa Page Table
+// ============================================================
+// As 1024 PTEs reproduzem o mapeamento da página grande (mesma base e
+// flags), então só a entrada que o chamador vai mudar deixa de ser
+// identity. Retorna false se não há frame para a Page Table.
+static bool split_large_page(uint32_t pd_idx) {
+    uint32_t pde = page_directory[pd_idx];
+    // Page Table é escrita pelo endereço físico: precisa do identity map
+    uint32_t pt_phys = pmm_alloc_contiguous(1, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (pt_phys == 0) return false;
+
+    uint32_t *pt = (uint32_t *)pt_phys;
+    uint32_t base = pde & PAGE_LARGE_ADDR_MASK;
+    // Bit 7 numa PTE é PAT, não tamanho: não herda PAGE_SIZE_4MB
+    uint32_t flags = pde & 0xFFF & ~(uint32_t)(PAGE_SIZE_4MB | PAGE_ACCESSED | PAGE_DIRTY);
+    for (uint32_t p = 0; p < PAGE_ENTRIES; p++) {
+        pt[p] = (base + p * PAGE_SIZE) | flags;
+    }
+
+    page_directory[pd_idx] = pt_phys | PAGE_KERNEL;
+    vmm_large_pages--;
+    vmm_large_splits++;
+    vmm_page_tables_used++;
+
+    // A entrada de 4MB pode estar no TLB: invlpg em qualquer endereço
+    // dela descarta a página inteira
+    invlpg(pd_idx * PAGE_TABLE_COVERAGE);
+    return true;
+}
+
+// Page Table de pd_idx, ou NULL se a PDE não está presente
+// PDE de 4MB é dividida antes (falha de split também retorna NULL)
+static uint32_t *page_table_of(uint32_t pd_idx) {
+    uint32_t pde = page_directory[pd_idx];
+    if (!(pde & PAGE_PRESENT)) return NULL;
+    if ((pde & PAGE_SIZE_4MB) && !split_large_page(pd_idx)) return NULL;
+    return (uint32_t *)(page_directory[pd_idx] & PAGE_ADDR_MASK);
+}
+
 // ============================================================
 // map_page — Mapeia uma página virtual para um frame físico
 // ============================================================
@@ -176,15 +288,15 @@ void map_page(uint32_t virtual_addr, uint32_t physical_addr, uint32_t flags) {
     uint32_t *pt;
 
     if (page_directory[pd_idx] & PAGE_PRESENT) {
-        // Page Table já existe
-        pt = (uint32_t *)(page_directory[pd_idx] & PAGE_ADDR_MASK);
+        // Page Table já existe (ou página de 4MB a dividir)
+        pt = page_table_of(pd_idx);
+        if (!pt) return;
     } else {
-        // Precisa alocar nova Page Table
-        uint32_t pt_phys = pmm_alloc_frame();
+        // Precisa alocar nova Page Table (zerada: nenhuma PTE presente)
+        uint32_t pt_phys = pmm_alloc_zeroed_frame();
         if (pt_phys == 0) return;
 
         pt = (uint32_t *)pt_phys;
-        zero_frame(pt);
 
         page_directory[pd_idx] = pt_phys | PAGE_KERNEL;
         vmm_page_tables_used++;
@@ -207,10 +319,9 @@ void unmap_page(uint32_t virtual_addr) {
     uint32_t pd_idx = PAGE_DIR_INDEX(virtual_addr);
     uint32_t pt_idx = PAGE_TABLE_INDEX(virtual_addr);
 
-    // Verifica se a Page Table existe
-    if (!(page_directory[pd_idx] & PAGE_PRESENT)) return;
-
-    uint32_t *pt = (uint32_t *)(page_directory[pd_idx] & PAGE_ADDR_MASK);
+    // Verifica se a Page Table existe (página de 4MB é dividida)
+    uint32_t *pt = page_table_of(pd_idx);
+    if (!pt) return;
 
     // Verifica se a página estava mapeada
     if (pt[pt_idx] & PAGE_PRESENT) {
@@ -222,6 +333,65 @@ void unmap_page(uint32_t virtual_addr) {
     }
 }
 
+// ============================================================
+// vmm_free_page_table — Devolve a Page Table de uma região vazia
+// ============================================================
+bool vmm_free_page_table(uint32_t virtual_addr) {
+    if (!vmm_initialized) return false;
+    if (virtual_addr < PAGING_IDENTITY_MAP_MB * 1024 * 1024) return false;
+
+    uint32_t pd_idx = PAGE_DIR_INDEX(virtual_addr);
+    uint32_t pde = page_directory[pd_idx];
+    if (!(pde & PAGE_PRESENT) || (pde & PAGE_SIZE_4MB)) return false;
+
+    uint32_t *pt = (uint32_t *)(pde & PAGE_ADDR_MASK);
+    for (uint32_t i = 0; i < PAGE_ENTRIES; i++) {
+        if (pt[i] & PAGE_PRESENT) return false;
+    }
+
+    page_directory[pd_idx] = 0;
+    if (vmm_page_tables_used > 0) vmm_page_tables_used--;
+
+    // Descarta a PDE dos caches de paginação antes de reutilizar o frame
+    invlpg(virtual_addr);
+    pmm_free_frame((uint32_t)(uintptr_t)pt);
+    return true;
+}
+
+// ============================================================
+// vmm_merge_large_page — Desfaz o split de uma página de 4MB
+// ============================================================
+// Só junta se as 1024 PTEs ainda reproduzem uma página grande: todas
+// presentes, físicas contíguas a partir de uma base alinhada a 4MB e com
+// as mesmas flags (A/D ignorados).
+bool vmm_merge_large_page(uint32_t virtual_addr) {
+    if (!vmm_initialized || !vmm_pse) return false;
+
+    uint32_t pd_idx = PAGE_DIR_INDEX(virtual_addr);
+    uint32_t pde = page_directory[pd_idx];
+    if (!(pde & PAGE_PRESENT) || (pde & PAGE_SIZE_4MB)) return false;
+
+    uint32_t *pt = (uint32_t *)(pde & PAGE_ADDR_MASK);
+    uint32_t ignore = PAGE_ACCESSED | PAGE_DIRTY;
+    uint32_t base = pt[0] & PAGE_ADDR_MASK;
+    uint32_t flags = pt[0] & 0xFFF & ~ignore;
+    if (!(flags & PAGE_PRESENT) || (base & ~PAGE_LARGE_ADDR_MASK)) return false;
+    for (uint32_t p = 1; p < PAGE_ENTRIES; p++) {
+        if ((pt[p] & ~ignore) != ((base + p * PAGE_SIZE) | flags)) return false;
+    }
+
+    page_directory[pd_idx] = base | flags | PAGE_SIZE_4MB;
+    vmm_large_pages++;
+    if (vmm_page_tables_used > 0) vmm_page_tables_used--;
+
+    // Descarta as 1024 entradas de 4KB do TLB antes de reutilizar o frame
+    for (uint32_t p = 0; p < PAGE_ENTRIES; p++) {
+        invlpg(pd_idx * PAGE_TABLE_COVERAGE + p * PAGE_SIZE);
+    }
+    pmm_free_contiguous((uint32_t)(uintptr_t)pt, 1);
+    return true;
+}
+
 // ============================================================
 // get_physical_addr — Traduz virtual → físico via page walk
 // ============================================================
@@ -232,7 +402,13 @@ uint32_t get_physical_addr(uint32_t virtual_addr) {
     uint32_t pt_idx = PAGE_TABLE_INDEX(virtual_addr);
 
     // Page Table não existe
-    if (!(page_directory[pd_idx] & PAGE_PRESENT)) return 0;
+    uint32_t pde = page_directory[pd_idx];
+    if (!(pde & PAGE_PRESENT)) return 0;
+
+    // Página de 4MB: o walk termina no Page Directory
+    if (pde & PAGE_SIZE_4MB) {
+        return (pde & PAGE_LARGE_ADDR_MASK) | (virtual_addr & ~PAGE_LARGE_ADDR_MASK);
+    }
 
     uint32_t *pt = (uint32_t *)(page_directory[pd_idx] & PAGE_ADDR_MASK);
 
@@ -252,7 +428,9 @@ bool is_page_mapped(uint32_t virtual_addr) {
     uint32_t pd_idx = PAGE_DIR_INDEX(virtual_addr);
     uint32_t pt_idx = PAGE_TABLE_INDEX(virtual_addr);
 
-    if (!(page_directory[pd_idx] & PAGE_PRESENT)) return false;
+    uint32_t pde = page_directory[pd_idx];
+    if (!(pde & PAGE_PRESENT)) return false;
+    if (pde & PAGE_SIZE_4MB) return true;
 
     uint32_t *pt = (uint32_t *)(page_directory[pd_idx] & PAGE_ADDR_MASK);
     return (pt[pt_idx] & PAGE_PRESENT) != 0;
@@ -266,6 +444,56 @@ struct vmm_stats paging_get_stats(void) {
     stats.pages_mapped = vmm_pages_mapped;
     stats.page_tables_used = vmm_page_tables_used;
     stats.page_faults = vmm_page_faults;
+    stats.large_pages = vmm_large_pages;
+    stats.large_splits = vmm_large_splits;
+    stats.demand_faults = vmm_demand_faults;
+    stats.demand_released = vmm_demand_released;
+    stats.pse_enabled = vmm_pse;
     stats.identity_map_mb = PAGING_IDENTITY_MAP_MB;
     return stats;
 }
+
+// ============================================================
+// Regiões sob demanda
+// ============================================================
+
+bool vmm_demand_register(uint32_t start, uint32_t end, uint32_t flags) {
+    if (demand_region_count >= VMM_MAX_DEMAND_REGIONS) return false;
+    if (start >= end || PAGE_OFFSET(start) || PAGE_OFFSET(end)) return false;
+    if (start < PAGING_IDENTITY_MAP_MB * 1024 * 1024) return false;
+
+    for (int i = 0; i < demand_region_count; i++) {
+        if (start < demand_regions[i].end && end > demand_regions[i].start) return false;
+    }
+
+    demand_region_t *r = &demand_regions[demand_region_count++];
+    r->start = start;
+    r->end = end;
+    r->flags = flags | PAGE_PRESENT;
+    r->resident = 0;
+    return true;
+}
+
+uint32_t vmm_demand_release(uint32_t start, uint32_t end) {
+    demand_region_t *r = demand_region_of(start);
+    if (!r || start >= end) return 0;
+    if (end > r->end) end = r->end;
+
+    uint32_t released = 0;
+    for (uint32_t va = start & PAGE_ADDR_MASK; va < end; va += PAGE_SIZE) {
+        uint32_t phys = get_physical_addr(va);
+        if (!is_page_mapped(va)) continue;
+        unmap_page(va);
+        pmm_free_frame(phys & PAGE_ADDR_MASK);
+        released++;
+    }
+
+    r->resident -= released;
+    vmm_demand_released += released;
+    return released;
+}
+
+uint32_t vmm_demand_resident(uint32_t addr) {
+    demand_region_t *r = demand_region_of(addr);
+    return r ? r->resident : 0;
+}
@@ -1,9 +1,17 @@
 // LeonardOS - VMM (Virtual Memory Manager) / Paging
-// Identity mapping com Page Directory + Page Tables (4KB pages)
+// Identity mapping com páginas de 4MB (PSE) + Page Tables (4KB pages)
 //
-// Mapeia virtual == physical nos primeiros 16MB.
+// Mapeia virtual == physical nos primeiros 16MB. Com CR4.PSE cada 4MB do
+// identity map é uma única PDE (uma entrada de TLB em vez de 1024);
+// sem PSE, cai para Page Tables de 4KB.
+// map_page dentro de uma página de 4MB divide a PDE numa Page Table que
+// preserva o identity map do resto da região.
+// Regiões sob demanda (vmm_demand_register): páginas não presentes ganham
+// um frame do PMM no primeiro acesso, dentro do page fault handler.
 // Usa PMM para alocar frames das estruturas de paging.
-// API: paging_init, map_page, unmap_page, get_physical_addr
+// API: paging_init, map_page, unmap_page, vmm_free_page_table,
+//      vmm_merge_large_page, get_physical_addr,
+//      vmm_demand_register, vmm_demand_release, vmm_demand_resident
 
 #ifndef __VMM_H__
 #define __VMM_H__
@@ -34,7 +42,7 @@
 #define PAGE_NOCACHE   0x010   // Cache desabilitado
 #define PAGE_ACCESSED  0x020   // CPU acessou esta página
 #define PAGE_DIRTY     0x040   // CPU escreveu nesta página (PTE only)
-#define PAGE_SIZE_4MB  0x080   // Página de 4MB (PDE only, não usamos)
+#define PAGE_SIZE_4MB  0x080   // Página de 4MB (PDE only, requer CR4.PSE)
 
 // Flags padrão para kernel: presente + leitura/escrita
 #define PAGE_KERNEL    (PAGE_PRESENT | PAGE_RW)
@@ -42,6 +50,15 @@
 // Máscara para extrair endereço base (bits 12-31)
 #define PAGE_ADDR_MASK 0xFFFFF000
 
+// Máscara da base de uma página de 4MB (bits 22-31)
+#define PAGE_LARGE_ADDR_MASK 0xFFC00000
+
+// CR4.PSE: habilita PDEs de 4MB
+#define CR4_PSE        0x010
+
+// Regiões virtuais com alocação de frames sob demanda
+#define VMM_MAX_DEMAND_REGIONS 4
+
 // ============================================================
 // Extração de índices de um endereço virtual
 // ============================================================
@@ -59,9 +76,14 @@
 // Estatísticas do VMM
 // ============================================================
 struct vmm_stats {
-    uint32_t pages_mapped;      // Total de páginas mapeadas
+    uint32_t pages_mapped;      // Total de páginas mapeadas (em unidades de 4KB)
     uint32_t page_tables_used;  // Page Tables alocadas
-    uint32_t page_faults;       // Page faults ocorridos
+    uint32_t large_pages;       // PDEs de 4MB em uso
+    uint32_t large_splits;      // Páginas de 4MB divididas por map_page
+    bool     pse_enabled;       // CR4.PSE ativo
+    uint32_t page_faults;       // Page faults fatais (fora de região sob demanda)
+    uint32_t demand_faults;     // Faults resolvidos com um frame novo
+    uint32_t demand_released;   // Frames devolvidos por vmm_demand_release
     uint32_t identity_map_mb;   // MB do identity mapping
 };
 
@@ -69,18 +91,29 @@ struct vmm_stats {
 // API pública
 // ============================================================
 
-// Inicializa paging com identity mapping
+// Inicializa paging com identity mapping (páginas de 4MB se a CPU tem PSE)
 // Deve ser chamada DEPOIS de pmm_init() e ANTES de sti
 void paging_init(void);
 
 // Mapeia uma página virtual para um frame físico
 // virtual_addr e physical_addr devem ser alinhados a 4KB
+// Se virtual_addr cai numa página de 4MB, ela é dividida em 4KB antes
 // flags: PAGE_PRESENT | PAGE_RW | PAGE_USER etc.
 void map_page(uint32_t virtual_addr, uint32_t physical_addr, uint32_t flags);
 
 // Remove o mapeamento de uma página virtual
 void unmap_page(uint32_t virtual_addr);
 
+// Libera a Page Table dos 4MB que contêm virtual_addr e limpa a PDE,
+// se nenhuma PTE dela está presente (o identity map nunca é liberado)
+// Retorna true se a Page Table foi devolvida ao PMM
+bool vmm_free_page_table(uint32_t virtual_addr);
+
+// Volta a Page Table dos 4MB que contêm virtual_addr a uma única PDE de 4MB
+// (desfaz o split de map_page), se as PTEs ainda mapeiam 4MB contíguos
+// alinhados com as mesmas flags. Requer PSE. Retorna true se juntou
+bool vmm_merge_large_page(uint32_t virtual_addr);
+
 // Retorna o endereço físico mapeado para um endereço virtual
 // Retorna 0 se a página não está mapeada
 uint32_t get_physical_addr(uint32_t virtual_addr);
@@ -88,6 +121,20 @@ uint32_t get_physical_addr(uint32_t virtual_addr);
 // Verifica se uma página virtual está mapeada
 bool is_page_mapped(uint32_t virtual_addr);
 
+// Reserva [start, end) (alinhados a 4KB, fora do identity map) como região
+// sob demanda: nada é mapeado agora; cada página recebe um frame do PMM
+// (mapeado com flags) no primeiro acesso. Retorna false se a tabela de
+// regiões está cheia ou o intervalo é inválido/sobreposto
+bool vmm_demand_register(uint32_t start, uint32_t end, uint32_t flags);
+
+// Desmapeia as páginas residentes de [start, end) dentro de uma região sob
+// demanda e devolve seus frames ao PMM (o próximo acesso causa novo fault)
+// Retorna quantas páginas foram liberadas
+uint32_t vmm_demand_release(uint32_t start, uint32_t end);
+
+// Páginas residentes (com frame) da região que contém addr (0 se nenhuma)
+uint32_t vmm_demand_resident(uint32_t addr);
+
 // Retorna estatísticas atuais
 struct vmm_stats paging_get_stats(void);
 
@@ -4,7 +4,6 @@
 #include "arp.h"
 #include "ethernet.h"
 #include "net_config.h"
-#include "../drivers/net/rtl8139.h"
 #include "../common/string.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
@@ -76,23 +75,26 @@ void arp_send_request(ip_addr_t target_ip) {
     net_config_t *cfg = net_get_config();
     if (!cfg->nic_present) return;
 
-    arp_packet_t pkt;
-    pkt.hw_type    = htons(ARP_HW_ETHER);
-    pkt.proto_type = htons(ETHERTYPE_IPV4);
-    pkt.hw_len     = 6;
-    pkt.proto_len  = 4;
-    pkt.opcode     = htons(ARP_OP_REQUEST);
+    pbuf_t *p = pbuf_alloc(PBUF_LINK, sizeof(arp_packet_t));
+    if (!p) return;
+
+    arp_packet_t *pkt = (arp_packet_t *)p->payload;
+    pkt->hw_type    = htons(ARP_HW_ETHER);
+    pkt->proto_type = htons(ETHERTYPE_IPV4);
+    pkt->hw_len     = 6;
+    pkt->proto_len  = 4;
+    pkt->opcode     = htons(ARP_OP_REQUEST);
 
     // Sender = nosso MAC + IP
-    rtl8139_get_mac(pkt.sender_mac);
-    kmemcpy(pkt.sender_ip, cfg->ip.octets, 4);
+    kmemcpy(pkt->sender_mac, cfg->mac, 6);
+    kmemcpy(pkt->sender_ip, cfg->ip.octets, 4);
 
     // Target = MAC zerado (não sabemos), IP do alvo
-    kmemset(pkt.target_mac, 0, 6);
-    kmemcpy(pkt.target_ip, target_ip.octets, 4);
+    kmemset(pkt->target_mac, 0, 6);
+    kmemcpy(pkt->target_ip, target_ip.octets, 4);
 
     // Envia via Ethernet broadcast
-    eth_send(ETH_BROADCAST, ETHERTYPE_ARP, &pkt, sizeof(pkt));
+    eth_send(ETH_BROADCAST, ETHERTYPE_ARP, p);
     stats.requests_sent++;
 }
 
@@ -102,22 +104,25 @@ void arp_send_request(ip_addr_t target_ip) {
 static void arp_send_reply(const uint8_t *dst_mac, ip_addr_t dst_ip) {
     net_config_t *cfg = net_get_config();
 
-    arp_packet_t pkt;
-    pkt.hw_type    = htons(ARP_HW_ETHER);
-    pkt.proto_type = htons(ETHERTYPE_IPV4);
-    pkt.hw_len     = 6;
-    pkt.proto_len  = 4;
-    pkt.opcode     = htons(ARP_OP_REPLY);
+    pbuf_t *p = pbuf_alloc(PBUF_LINK, sizeof(arp_packet_t));
+    if (!p) return;
+
+    arp_packet_t *pkt = (arp_packet_t *)p->payload;
+    pkt->hw_type    = htons(ARP_HW_ETHER);
+    pkt->proto_type = htons(ETHERTYPE_IPV4);
+    pkt->hw_len     = 6;
+    pkt->proto_len  = 4;
+    pkt->opcode     = htons(ARP_OP_REPLY);
 
     // Sender = nosso MAC + IP
-    rtl8139_get_mac(pkt.sender_mac);
-    kmemcpy(pkt.sender_ip, cfg->ip.octets, 4);
+    kmemcpy(pkt->sender_mac, cfg->mac, 6);
+    kmemcpy(pkt->sender_ip, cfg->ip.octets, 4);
 
     // Target = quem perguntou
-    kmemcpy(pkt.target_mac, dst_mac, 6);
-    kmemcpy(pkt.target_ip, dst_ip.octets, 4);
+    kmemcpy(pkt->target_mac, dst_mac, 6);
+    kmemcpy(pkt->target_ip, dst_ip.octets, 4);
 
-    eth_send(dst_mac, ETHERTYPE_ARP, &pkt, sizeof(pkt));
+    eth_send(dst_mac, ETHERTYPE_ARP, p);
     stats.replies_sent++;
 }
 
@@ -2,7 +2,8 @@
 // Monta frames, despacha pacotes recebidos por EtherType
 
 #include "ethernet.h"
-#include "../drivers/net/rtl8139.h"
+#include "../drivers/net/netdev.h"
+#include "../cpu/softirq.h"
 #include "../net/net_config.h"
 #include "../common/string.h"
 #include "../drivers/vga/vga.h"
@@ -47,7 +48,7 @@ void eth_register_handler(uint16_t ethertype, eth_protocol_handler_t handler) {
 }
 
 // ============================================================
-// eth_rx_handler — chamado pelo RTL8139 quando um frame chega
+// eth_rx_handler — chamado pelo poll da NIC (netdev_rx) quando um frame chega
 // Faz parse do header Ethernet e despacha para o handler correto
 // ============================================================
 static void eth_rx_handler(const void *data, uint16_t len) {
@@ -79,41 +80,51 @@ static void eth_rx_handler(const void *data, uint16_t len) {
 }
 
 // ============================================================
-// eth_send — monta e envia um frame Ethernet
+// eth_rx_action — softirq NET_RX: drena a NIC em lotes de ETH_RX_BUDGET
+// Budget esgotado = ring com mais pacotes: re-agenda em vez de
+// segurar a CPU (a próxima rodada vem depois das outras ações/IRQs)
 // ============================================================
-bool eth_send(const uint8_t *dst_mac, uint16_t ethertype,
-              const void *payload, uint16_t payload_len) {
-    if (!rtl8139_is_present()) return false;
-    if (payload_len > ETH_MTU) return false;
+static void eth_rx_action(void) {
+    netdev_t *dev = netdev_get();
+    if (dev && dev->ops->poll(dev, ETH_RX_BUDGET) >= ETH_RX_BUDGET) {
+        softirq_raise(SOFTIRQ_NET_RX);
+    }
+}
 
-    // Buffer estático para montar o frame
-    // (não temos malloc em contexto de IRQ, e o frame é efêmero)
-    static uint8_t frame_buf[ETH_FRAME_MAX];
+// ============================================================
+// eth_send — prepende o header Ethernet no pbuf e envia
+// ============================================================
+bool eth_send(const uint8_t *dst_mac, uint16_t ethertype, pbuf_t *p) {
+    if (!p) return false;
+    netdev_t *dev = netdev_get();
+    if (!dev || p->len > ETH_MTU) {
+        pbuf_free(p);
+        return false;
+    }
 
-    eth_header_t *hdr = (eth_header_t *)frame_buf;
+    eth_header_t *hdr = (eth_header_t *)pbuf_push(p, ETH_HLEN);
+    if (!hdr) {
+        pbuf_free(p);
+        return false;
+    }
 
     // MAC destino
     kmemcpy(hdr->dst, dst_mac, ETH_ALEN);
 
     // MAC origem (nosso)
-    rtl8139_get_mac(hdr->src);
+    kmemcpy(hdr->src, dev->mac, ETH_ALEN);
 
     // EtherType em big-endian
     hdr->ethertype = htons(ethertype);
 
-    // Copia payload
-    kmemcpy(frame_buf + ETH_HLEN, payload, payload_len);
-
-    // Tamanho total do frame (mínimo 60 bytes para Ethernet)
-    uint16_t frame_len = ETH_HLEN + payload_len;
-    if (frame_len < ETH_FRAME_MIN) {
-        // Padding com zeros
-        kmemset(frame_buf + ETH_HLEN + payload_len, 0, ETH_FRAME_MIN - frame_len);
-        frame_len = ETH_FRAME_MIN;
+    // Tamanho mínimo (60 bytes): padding com zeros logo após o payload
+    if (p->len < ETH_FRAME_MIN) {
+        kmemset(p->payload + p->len, 0, ETH_FRAME_MIN - p->len);
+        p->len = ETH_FRAME_MIN;
     }
 
-    // Envia pelo RTL8139
-    bool ok = rtl8139_send(frame_buf, frame_len);
+    // Envia pela NIC (DMA direto do pbuf; o driver solta a referência)
+    bool ok = dev->ops->send(dev, p);
     if (ok) {
         stats.frames_tx++;
     }
@@ -128,11 +139,21 @@ void eth_init(void) {
     kmemset(handler_table, 0, sizeof(handler_table));
     handler_count = 0;
 
-    // Registra nosso handler como callback de recepção no RTL8139
-    if (rtl8139_is_present()) {
-        rtl8139_set_rx_callback(eth_rx_handler);
+    // Registra nosso handler como callback de recepção da NIC
+    if (netdev_get()) {
+        netdev_set_rx_callback(eth_rx_handler);
+        softirq_register(SOFTIRQ_NET_RX, eth_rx_action);
+
+        // Pool de pbufs para TX (sem ele todo envio falha em pbuf_alloc)
+        if (!pbuf_init()) {
+            vga_puts_color("[!!] ", THEME_BOOT_FAIL);
+            vga_puts_color("Ethernet: sem memoria para o pool de pbufs\n", THEME_ERROR);
+            return;
+        }
 
         vga_puts_color("[OK] ", THEME_BOOT_OK);
-        vga_puts_color("Ethernet: camada L2 ativa\n", THEME_BOOT);
+        vga_puts_color("Ethernet: camada L2 ativa (", THEME_BOOT);
+        vga_putint(PBUF_POOL_SIZE);
+        vga_puts_color(" pbufs)\n", THEME_BOOT);
     }
 }
@@ -5,6 +5,7 @@
 #define __ETHERNET_H__
 
 #include "../common/types.h"
+#include "pbuf.h"
 
 // ============================================================
 // Constantes Ethernet
@@ -16,6 +17,7 @@
 #define ETH_MTU         1500    // Payload máximo (sem header)
 #define ETH_FRAME_MIN   60      // Frame mínimo (sem CRC)
 #define ETH_FRAME_MAX   1514    // Frame máximo (header + MTU, sem CRC)
+#define ETH_RX_BUDGET   16      // Frames por poll no softirq NET_RX
 
 // EtherTypes conhecidos
 #define ETHERTYPE_ARP   0x0806
@@ -44,17 +46,16 @@ typedef void (*eth_protocol_handler_t)(const void *payload, uint16_t len,
 // API pública
 // ============================================================
 
-// Inicializa a camada Ethernet (registra rx_callback no RTL8139)
+// Inicializa a camada Ethernet (registra rx_callback na NIC)
 void eth_init(void);
 
 // Envia um frame Ethernet
 // dst_mac: endereço destino (6 bytes)
 // ethertype: protocolo (host byte order — será convertido para big-endian)
-// payload: dados a enviar
-// payload_len: tamanho dos dados (máx ETH_MTU)
+// p: payload em p->payload (máx ETH_MTU), com pelo menos PBUF_LINK de headroom
+// Consome a referência de p, com sucesso ou não
 // Retorna true se enviado com sucesso
-bool eth_send(const uint8_t *dst_mac, uint16_t ethertype,
-              const void *payload, uint16_t payload_len);
+bool eth_send(const uint8_t *dst_mac, uint16_t ethertype, pbuf_t *p);
 
 // Registra handler para um EtherType específico
 // Quando um frame com esse ethertype chegar, o handler será chamado
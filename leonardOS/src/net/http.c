@@ -11,6 +11,14 @@
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
 #include "../drivers/timer/pit.h"
+#include "../memory/arena.h"
+
+// Buffer da resposta crua (headers + body), alocado na arena do pedido
+#define HTTP_RAW_BUF_SIZE   (HTTP_MAX_HEADERS + HTTP_BODY_BUF_SIZE)
+
+// Bytes fixos do request além de path e host (linha GET, Host, User-Agent,
+// Accept-Encoding, Connection, CRLFs e '\0' — 106 hoje)
+#define HTTP_REQ_FIXED      128
 
 // ============================================================
 // Estatísticas
@@ -298,9 +306,11 @@ bool http_parse_url(const char *url, http_url_t *out) {
 // ============================================================
 // http_do_request — faz um HTTP/1.1 GET para uma URL já parseada
 // Função interna usada por http_get (com suporte a redirect)
+// scratch: arena do pedido (request); raw_buf: HTTP_RAW_BUF_SIZE bytes
 // ============================================================
 static bool http_do_request(const http_url_t *parsed, http_response_t *response,
-                            http_progress_fn progress) {
+                            http_progress_fn progress, arena_t *scratch,
+                            uint8_t *raw_buf) {
     // Resolve hostname para IP
     ip_addr_t server_ip;
     if (!dns_resolve(parsed->host, &server_ip)) {
@@ -330,12 +340,18 @@ static bool http_do_request(const http_url_t *parsed, http_response_t *response,
         }
     }
 
-    stats.requests_sent++;
-
-    // Monta request HTTP/1.1
-    static char request[512];
+    // Monta request HTTP/1.1 (tamanho exato: sem limite fixo de buffer)
+    char *request = (char *)arena_alloc(scratch, HTTP_REQ_FIXED +
+                                        kstrlen(parsed->path) + kstrlen(parsed->host));
+    if (!request) {
+        if (!reused) tcp_close(conn);
+        stats.responses_error++;
+        return false;
+    }
     int pos = 0;
 
+    stats.requests_sent++;
+
     // GET /path HTTP/1.1\r\n
     const char *get = "GET ";
     for (int j = 0; get[j]; j++) request[pos++] = get[j];
@@ -391,9 +407,8 @@ static bool http_do_request(const http_url_t *parsed, http_response_t *response,
     }
 
     // Recebe response (headers + body)
-    static uint8_t raw_buf[HTTP_MAX_HEADERS + HTTP_BODY_BUF_SIZE];
     int total_received = 0;
-    int max_raw = (int)sizeof(raw_buf) - 1;
+    int max_raw = HTTP_RAW_BUF_SIZE - 1;
 
     // Fase 1: Receber headers (até \r\n\r\n)
     int header_end = -1;
@@ -629,6 +644,11 @@ bool http_get(const char *url, http_response_t *response) {
 // ============================================================
 // http_get_with_progress — GET com callback de progresso
 // ============================================================
+// Estado temporário (URLs, request, resposta crua) vem de uma arena
+// criada aqui e destruída no fim: reentrante e sem buffers estáticos
+static bool http_get_in_arena(const char *url, http_response_t *response,
+                              http_progress_fn progress, arena_t *scratch);
+
 bool http_get_with_progress(const char *url, http_response_t *response,
                             http_progress_fn progress) {
     if (!url || !response) return false;
@@ -637,8 +657,22 @@ bool http_get_with_progress(const char *url, http_response_t *response,
     response->content_length = -1;
     response->redirect_count = 0;
 
+    arena_t *scratch = arena_create(0);
+    if (!scratch) return false;
+
+    bool ok = http_get_in_arena(url, response, progress, scratch);
+    arena_destroy(scratch);
+    return ok;
+}
+
+static bool http_get_in_arena(const char *url, http_response_t *response,
+                              http_progress_fn progress, arena_t *scratch) {
+    uint8_t *raw_buf = (uint8_t *)arena_alloc(scratch, HTTP_RAW_BUF_SIZE);
+    char *current_url = (char *)arena_alloc(scratch, HTTP_MAX_URL);
+    char *redir_url = (char *)arena_alloc(scratch, HTTP_MAX_URL);
+    if (!raw_buf || !current_url || !redir_url) return false;
+
     // Copia URL atual para buffer de trabalho
-    static char current_url[HTTP_MAX_URL];
     kstrcpy(current_url, url, HTTP_MAX_URL);
 
     for (int redirect = 0; redirect <= HTTP_MAX_REDIRECTS; redirect++) {
@@ -655,7 +689,7 @@ bool http_get_with_progress(const char *url, http_response_t *response,
         response->redirect_count = saved_redirects;
 
         // Faz request
-        if (!http_do_request(&parsed, response, progress)) {
+        if (!http_do_request(&parsed, response, progress, scratch, raw_buf)) {
             return false;
         }
 
@@ -669,7 +703,6 @@ bool http_get_with_progress(const char *url, http_response_t *response,
             }
 
             // Extrai Location header
-            static char redir_url[HTTP_MAX_URL];
             if (!http_extract_location(response->headers, parsed.host,
                                        parsed.port, redir_url, HTTP_MAX_URL)) {
                 return true;
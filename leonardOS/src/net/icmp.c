@@ -33,9 +33,13 @@ icmp_stats_t icmp_get_stats(void) {
 bool icmp_send_echo_request(ip_addr_t dst_ip, uint16_t identifier,
                             uint16_t sequence) {
     // Monta pacote ICMP Echo Request com 32 bytes de payload
-    static uint8_t icmp_buf[64];
+    uint16_t payload_len = 32;
+    uint16_t total_len = sizeof(icmp_header_t) + payload_len;
+
+    pbuf_t *p = pbuf_alloc(PBUF_IP, total_len);
+    if (!p) return false;
 
-    icmp_header_t *hdr = (icmp_header_t *)icmp_buf;
+    icmp_header_t *hdr = (icmp_header_t *)p->payload;
     hdr->type       = ICMP_TYPE_ECHO_REQUEST;
     hdr->code       = 0;
     hdr->checksum   = 0;
@@ -43,18 +47,15 @@ bool icmp_send_echo_request(ip_addr_t dst_ip, uint16_t identifier,
     hdr->sequence   = htons(sequence);
 
     // Payload de dados (padrão: bytes incrementais, como ping real)
-    uint8_t *payload = icmp_buf + sizeof(icmp_header_t);
-    uint16_t payload_len = 32;
+    uint8_t *payload = p->payload + sizeof(icmp_header_t);
     for (uint16_t i = 0; i < payload_len; i++) {
         payload[i] = (uint8_t)(i & 0xFF);
     }
 
-    uint16_t total_len = sizeof(icmp_header_t) + payload_len;
-
     // Calcula checksum do pacote ICMP inteiro
-    hdr->checksum = ip_checksum(icmp_buf, total_len);
+    hdr->checksum = ip_checksum(hdr, total_len);
 
-    bool ok = ipv4_send(dst_ip, IP_PROTO_ICMP, icmp_buf, total_len);
+    bool ok = ipv4_send(dst_ip, IP_PROTO_ICMP, p);
     if (ok) {
         stats.echo_requests_sent++;
     }
@@ -67,12 +68,14 @@ bool icmp_send_echo_request(ip_addr_t dst_ip, uint16_t identifier,
 static bool icmp_send_echo_reply(ip_addr_t dst_ip, uint16_t identifier,
                                  uint16_t sequence,
                                  const void *data, uint16_t data_len) {
-    static uint8_t reply_buf[128];
-
     // Limite de segurança
     if (data_len > 100) data_len = 100;
 
-    icmp_header_t *hdr = (icmp_header_t *)reply_buf;
+    uint16_t total_len = sizeof(icmp_header_t) + data_len;
+    pbuf_t *p = pbuf_alloc(PBUF_IP, total_len);
+    if (!p) return false;
+
+    icmp_header_t *hdr = (icmp_header_t *)p->payload;
     hdr->type       = ICMP_TYPE_ECHO_REPLY;
     hdr->code       = 0;
     hdr->checksum   = 0;
@@ -80,12 +83,11 @@ static bool icmp_send_echo_reply(ip_addr_t dst_ip, uint16_t identifier,
     hdr->sequence   = sequence;    // Já em network byte order
 
     // Copia payload original
-    kmemcpy(reply_buf + sizeof(icmp_header_t), data, data_len);
+    kmemcpy(p->payload + sizeof(icmp_header_t), data, data_len);
 
-    uint16_t total_len = sizeof(icmp_header_t) + data_len;
-    hdr->checksum = ip_checksum(reply_buf, total_len);
+    hdr->checksum = ip_checksum(hdr, total_len);
 
-    bool ok = ipv4_send(dst_ip, IP_PROTO_ICMP, reply_buf, total_len);
+    bool ok = ipv4_send(dst_ip, IP_PROTO_ICMP, p);
     if (ok) {
         stats.echo_replies_sent++;
     }
@@ -5,6 +5,7 @@
 #include "ethernet.h"
 #include "arp.h"
 #include "net_config.h"
+#include "../drivers/net/netdev.h"
 #include "../common/string.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
@@ -33,11 +34,10 @@ ipv4_stats_t ipv4_get_stats(void) {
 }
 
 // ============================================================
-// ip_checksum — RFC 1071, one's complement sum
+// checksum_add — soma words de 16 bits (one's complement, sem fold)
 // ============================================================
-uint16_t ip_checksum(const void *data, uint16_t len) {
+static uint32_t checksum_add(uint32_t sum, const void *data, uint16_t len) {
     const uint16_t *words = (const uint16_t *)data;
-    uint32_t sum = 0;
 
     while (len > 1) {
         sum += *words++;
@@ -50,7 +50,10 @@ uint16_t ip_checksum(const void *data, uint16_t len) {
         *((uint8_t *)&last) = *((const uint8_t *)words);
         sum += last;
     }
+    return sum;
+}
 
+static uint16_t checksum_fold(uint32_t sum) {
     // Fold carries
     while (sum >> 16) {
         sum = (sum & 0xFFFF) + (sum >> 16);
@@ -59,6 +62,46 @@ uint16_t ip_checksum(const void *data, uint16_t len) {
     return (uint16_t)(~sum);
 }
 
+// ============================================================
+// ip_checksum — RFC 1071, one's complement sum
+// ============================================================
+uint16_t ip_checksum(const void *data, uint16_t len) {
+    return checksum_fold(checksum_add(0, data, len));
+}
+
+// ============================================================
+// pseudo_add — soma o pseudo-header TCP/UDP (12 bytes, par)
+// ============================================================
+static uint32_t pseudo_add(ip_addr_t src_ip, ip_addr_t dst_ip, uint8_t protocol,
+                           uint16_t len) {
+    uint8_t pseudo[12];
+    kmemcpy(pseudo, src_ip.octets, 4);
+    kmemcpy(pseudo + 4, dst_ip.octets, 4);
+    pseudo[8]  = 0;
+    pseudo[9]  = protocol;
+    pseudo[10] = (uint8_t)(len >> 8);
+    pseudo[11] = (uint8_t)len;
+    return checksum_add(0, pseudo, sizeof(pseudo));
+}
+
+// ============================================================
+// ip_checksum_pseudo — checksum TCP/UDP com pseudo-header
+// Soma o pseudo-header e o segmento em sequência, sem montar
+// os dois num buffer contíguo
+// ============================================================
+uint16_t ip_checksum_pseudo(ip_addr_t src_ip, ip_addr_t dst_ip, uint8_t protocol,
+                            const void *segment, uint16_t len) {
+    uint32_t sum = pseudo_add(src_ip, dst_ip, protocol, len);
+    return checksum_fold(checksum_add(sum, segment, len));
+}
+
+// ============================================================
+// ip_pseudo_sum — semente do checksum para a NIC (sem complemento)
+// ============================================================
+uint16_t ip_pseudo_sum(ip_addr_t src_ip, ip_addr_t dst_ip, uint8_t protocol, uint16_t len) {
+    return (uint16_t)~checksum_fold(pseudo_add(src_ip, dst_ip, protocol, len));
+}
+
 // ============================================================
 // ipv4_register_handler — registra callback por protocolo
 // ============================================================
@@ -92,16 +135,19 @@ static void ipv4_rx_handler(const void *payload, uint16_t len,
     uint8_t ihl = (hdr->version_ihl & 0x0F) * 4;
     if (ihl < IPV4_HLEN || ihl > len) return;
 
-    // Verifica checksum
-    uint16_t saved_cksum = hdr->checksum;
-    // Copia header para verificar (precisa zerar checksum)
-    uint8_t hdr_copy[60]; // Max IHL = 15*4 = 60
-    kmemcpy(hdr_copy, hdr, ihl);
-    ((ipv4_header_t *)hdr_copy)->checksum = 0;
-    uint16_t calc_cksum = ip_checksum(hdr_copy, ihl);
-    if (calc_cksum != saved_cksum) {
-        stats.rx_bad_checksum++;
-        return;
+    // Verifica checksum (a menos que a NIC já tenha conferido)
+    uint32_t hw_csum = netdev_rx_csum();
+    if (!(hw_csum & NETDEV_RX_CSUM_IP)) {
+        uint16_t saved_cksum = hdr->checksum;
+        // Copia header para verificar (precisa zerar checksum)
+        uint8_t hdr_copy[60]; // Max IHL = 15*4 = 60
+        kmemcpy(hdr_copy, hdr, ihl);
+        ((ipv4_header_t *)hdr_copy)->checksum = 0;
+        uint16_t calc_cksum = ip_checksum(hdr_copy, ihl);
+        if (calc_cksum != saved_cksum) {
+            stats.rx_bad_checksum++;
+            return;
+        }
     }
 
     // Verifica se o pacote é para nós
@@ -136,6 +182,24 @@ static void ipv4_rx_handler(const void *payload, uint16_t len,
         ip_payload_len = len - ihl; // Segurança
     }
 
+    // TCP/UDP: sem RX offload o checksum L4 não é conferido (como sempre
+    // foi: uma passada extra por payload em RTL8139/virtio-net). Com offload,
+    // frame que a NIC não confirmou (erro TCPE, protocolo que ela não trata)
+    // é conferido aqui, onde src e dst são conhecidos
+    // (UDP com checksum 0 = não calculado pelo remetente)
+    netdev_t *nd = netdev_get();
+    bool rx_offload = nd && (nd->features & NETDEV_F_RX_CSUM);
+    if (rx_offload && !(hw_csum & NETDEV_RX_CSUM_L4) &&
+        (hdr->protocol == IP_PROTO_TCP ||
+         (hdr->protocol == IP_PROTO_UDP && ip_payload_len >= 8 &&
+          (ip_payload[6] | ip_payload[7]) != 0))) {
+        if (ip_checksum_pseudo(src_ip, dst_ip, hdr->protocol,
+                               ip_payload, ip_payload_len) != 0) {
+            stats.rx_bad_l4_checksum++;
+            return;
+        }
+    }
+
     // Despacha para handler do protocolo
     for (int i = 0; i < ip_handler_count; i++) {
         if (ip_handlers[i].protocol == hdr->protocol) {
@@ -172,19 +236,37 @@ static bool ip_determine_next_hop(ip_addr_t dst_ip, ip_addr_t *next_hop) {
 }
 
 // ============================================================
-// ipv4_send — monta e envia um pacote IP
+// ipv4_send — prepende o header IP no pbuf e envia
 // ============================================================
-bool ipv4_send(ip_addr_t dst_ip, uint8_t protocol,
-               const void *payload, uint16_t payload_len) {
-    net_config_t *cfg = net_get_config();
-    if (!cfg->nic_present || !cfg->configured) return false;
+bool ipv4_send(ip_addr_t dst_ip, uint8_t protocol, pbuf_t *p) {
+    if (!p) return false;
 
+    net_config_t *cfg = net_get_config();
     // Limite: payload + header deve caber no MTU Ethernet
-    if (payload_len > ETH_MTU - IPV4_HLEN) return false;
+    if (!cfg->nic_present || !cfg->configured || p->len > ETH_MTU - IPV4_HLEN) {
+        pbuf_free(p);
+        return false;
+    }
+
+    // Determina next-hop e resolve MAC antes de mexer no pbuf
+    ip_addr_t next_hop;
+    ip_determine_next_hop(dst_ip, &next_hop);
 
-    // Monta header IP
-    static uint8_t pkt_buf[ETH_MTU];
-    ipv4_header_t *hdr = (ipv4_header_t *)pkt_buf;
+    uint8_t dst_mac[6];
+    if (!arp_resolve(next_hop, dst_mac)) {
+        // ARP request enviado, pacote perdido (simplificação: sem fila)
+        stats.tx_no_route++;
+        pbuf_free(p);
+        return false;
+    }
+
+    // Monta header IP no headroom
+    uint16_t payload_len = p->len;
+    ipv4_header_t *hdr = (ipv4_header_t *)pbuf_push(p, IPV4_HLEN);
+    if (!hdr) {
+        pbuf_free(p);
+        return false;
+    }
 
     hdr->version_ihl   = (IPV4_VERSION << 4) | (IPV4_HLEN / 4);
     hdr->tos            = 0;
@@ -197,25 +279,15 @@ bool ipv4_send(ip_addr_t dst_ip, uint8_t protocol,
     kmemcpy(hdr->src_ip, cfg->ip.octets, 4);
     kmemcpy(hdr->dst_ip, dst_ip.octets, 4);
 
-    // Calcula checksum do header
-    hdr->checksum = ip_checksum(hdr, IPV4_HLEN);
-
-    // Copia payload
-    kmemcpy(pkt_buf + IPV4_HLEN, payload, payload_len);
-
-    // Determina next-hop e resolve MAC
-    ip_addr_t next_hop;
-    ip_determine_next_hop(dst_ip, &next_hop);
-
-    uint8_t dst_mac[6];
-    if (!arp_resolve(next_hop, dst_mac)) {
-        // ARP request enviado, pacote perdido (simplificação: sem fila)
-        stats.tx_no_route++;
-        return false;
+    // Calcula checksum do header (ou deixa zerado para a NIC)
+    if (netdev_tx_csum()) {
+        p->flags |= PBUF_F_CSUM_IP;
+    } else {
+        hdr->checksum = ip_checksum(hdr, IPV4_HLEN);
     }
 
     // Envia via Ethernet
-    bool ok = eth_send(dst_mac, ETHERTYPE_IPV4, pkt_buf, IPV4_HLEN + payload_len);
+    bool ok = eth_send(dst_mac, ETHERTYPE_IPV4, p);
     if (ok) {
         stats.packets_tx++;
     }
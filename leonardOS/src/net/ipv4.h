@@ -53,11 +53,10 @@ void ipv4_init(void);
 // Envia um pacote IP
 // dst_ip: endereço destino
 // protocol: protocolo (IP_PROTO_ICMP, IP_PROTO_TCP, IP_PROTO_UDP)
-// payload: dados a enviar
-// payload_len: tamanho dos dados
+// p: payload IP em p->payload, alocado com pelo menos PBUF_IP de headroom
+// Consome a referência de p, com sucesso ou não
 // Retorna true se enviado com sucesso
-bool ipv4_send(ip_addr_t dst_ip, uint8_t protocol,
-               const void *payload, uint16_t payload_len);
+bool ipv4_send(ip_addr_t dst_ip, uint8_t protocol, pbuf_t *p);
 
 // Registra handler para um protocolo IP específico
 void ipv4_register_handler(uint8_t protocol, ip_protocol_handler_t handler);
@@ -65,11 +64,20 @@ void ipv4_register_handler(uint8_t protocol, ip_protocol_handler_t handler);
 // Calcula checksum IP (RFC 1071)
 uint16_t ip_checksum(const void *data, uint16_t len);
 
+// Checksum TCP/UDP: pseudo-header (src, dst, protocolo, len) + segmento
+uint16_t ip_checksum_pseudo(ip_addr_t src_ip, ip_addr_t dst_ip, uint8_t protocol,
+                            const void *segment, uint16_t len);
+
+// Soma do pseudo-header dobrada e sem complemento: vai no campo de checksum
+// TCP/UDP quando a NIC calcula o resto (PBUF_F_CSUM_L4)
+uint16_t ip_pseudo_sum(ip_addr_t src_ip, ip_addr_t dst_ip, uint8_t protocol, uint16_t len);
+
 // Estatísticas IPv4
 typedef struct {
     uint32_t packets_rx;
     uint32_t packets_tx;
     uint32_t rx_bad_checksum;
+    uint32_t rx_bad_l4_checksum;    // TCP/UDP inválido (software, NIC com RX offload)
     uint32_t rx_bad_version;
     uint32_t rx_not_for_us;
     uint32_t tx_no_route;
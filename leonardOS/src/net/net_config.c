@@ -2,6 +2,8 @@
 // Gerencia configuração de rede (IP, gateway, MAC) e inicialização da NIC
 
 #include "net_config.h"
+#include "../drivers/net/virtio_net.h"
+#include "../drivers/net/e1000.h"
 #include "../drivers/net/rtl8139.h"
 #include "../common/string.h"
 #include "../drivers/vga/vga.h"
@@ -66,9 +68,11 @@ void net_set_dns(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
 void net_init(void) {
     kmemset(&config, 0, sizeof(config));
 
-    if (rtl8139_init()) {
+    // Prefere a placa paravirtualizada, depois a e1000; RTL8139 por último
+    if (virtio_net_init() || e1000_init() || rtl8139_init()) {
+        netdev_t *dev = netdev_get();
         config.nic_present = true;
-        rtl8139_get_mac(config.mac);
+        kmemcpy(config.mac, dev->mac, 6);
 
         // Default: 10.0.2.15 (QEMU user-mode networking default)
         net_set_ip(10, 0, 2, 15);
@@ -77,7 +81,9 @@ void net_init(void) {
         net_set_dns(10, 0, 2, 3);
 
         vga_puts_color("[OK] ", THEME_BOOT_OK);
-        vga_puts_color("NIC: RTL8139 MAC=", THEME_BOOT);
+        vga_puts_color("NIC: ", THEME_BOOT);
+        vga_puts_color(dev->driver, THEME_BOOT);
+        vga_puts_color(" MAC=", THEME_BOOT);
 
         char mac_str[18];
         mac_to_str(config.mac, mac_str, sizeof(mac_str));
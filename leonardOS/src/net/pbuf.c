@@ -0,0 +1,119 @@
+// LeonardOS - Packet buffers (pbuf)
+// Pool fixo de pbufs em frames contíguos do PMM, lista livre LIFO
+
+#include "pbuf.h"
+#include "../memory/pmm.h"
+#include "../common/io.h"
+#include "../common/string.h"
+
+#define PBUF_POOL_FRAMES  ((PBUF_POOL_SIZE * PBUF_SIZE + PMM_FRAME_SIZE - 1) / PMM_FRAME_SIZE)
+
+static pbuf_t      *free_list = NULL;
+static pbuf_stats_t stats;
+static void       (*reclaim_hook)(void) = NULL;
+
+// ============================================================
+// pbuf_init — reserva o pool e monta a lista livre
+// ============================================================
+bool pbuf_init(void) {
+    if (sizeof(pbuf_t) != PBUF_SIZE) return false;
+
+    // Abaixo de 16MB: identity map, endereço do payload serve para DMA
+    uint32_t base = pmm_alloc_contiguous(PBUF_POOL_FRAMES, PMM_FRAME_SIZE, PMM_DMA_MAX_PHYS);
+    if (!base) return false;
+
+    kmemset(&stats, 0, sizeof(stats));
+    free_list = NULL;
+    for (int i = PBUF_POOL_SIZE - 1; i >= 0; i--) {
+        pbuf_t *p = (pbuf_t *)(base + (uint32_t)i * PBUF_SIZE);
+        p->ref  = 0;
+        p->next = free_list;
+        free_list = p;
+    }
+    stats.total    = PBUF_POOL_SIZE;
+    stats.free     = PBUF_POOL_SIZE;
+    stats.min_free = PBUF_POOL_SIZE;
+    return true;
+}
+
+// ============================================================
+// pbuf_alloc — tira um pbuf do pool
+// ============================================================
+pbuf_t *pbuf_alloc(uint16_t headroom, uint16_t len) {
+    if ((uint32_t)headroom + len > PBUF_BUF_SIZE) {
+        stats.failures++;
+        return NULL;
+    }
+
+    // Pool vazio: o driver pode estar segurando pbufs já transmitidos
+    // (TX sem interrupção); pede a devolução uma vez e tenta de novo
+    if (!free_list && reclaim_hook) reclaim_hook();
+
+    uint32_t flags = irq_save();
+    pbuf_t *p = free_list;
+    if (p) {
+        free_list = p->next;
+        stats.free--;
+        if (stats.free < stats.min_free) stats.min_free = stats.free;
+        stats.allocs++;
+    } else {
+        stats.failures++;
+    }
+    irq_restore(flags);
+    if (!p) return NULL;
+
+    p->next    = NULL;
+    p->payload = p->buf + headroom;
+    p->len     = len;
+    p->ref     = 1;
+    p->flags   = 0;
+    return p;
+}
+
+// ============================================================
+// pbuf_push — prepende hlen bytes no headroom
+// ============================================================
+void *pbuf_push(pbuf_t *p, uint16_t hlen) {
+    if ((uint32_t)(p->payload - p->buf) < hlen) return NULL;
+    p->payload -= hlen;
+    p->len += hlen;
+    return p->payload;
+}
+
+// ============================================================
+// pbuf_ref — mais uma referência
+// ============================================================
+void pbuf_ref(pbuf_t *p) {
+    uint32_t flags = irq_save();
+    p->ref++;
+    irq_restore(flags);
+}
+
+// ============================================================
+// pbuf_free — solta uma referência; a última devolve ao pool
+// ============================================================
+void pbuf_free(pbuf_t *p) {
+    if (!p) return;
+
+    uint32_t flags = irq_save();
+    if (p->ref > 0 && --p->ref == 0) {
+        p->next = free_list;
+        free_list = p;
+        stats.free++;
+    }
+    irq_restore(flags);
+}
+
+// ============================================================
+// pbuf_set_reclaim — registra o gancho chamado com o pool vazio
+// ============================================================
+void pbuf_set_reclaim(void (*fn)(void)) {
+    reclaim_hook = fn;
+}
+
+// ============================================================
+// pbuf_get_stats — retorna contadores
+// ============================================================
+pbuf_stats_t pbuf_get_stats(void) {
+    return stats;
+}
@@ -0,0 +1,89 @@
+// LeonardOS - Packet buffers (pbuf)
+// Buffers de pacote com headroom, contados por referência, de um pool dedicado
+//
+// O transporte aloca o pbuf com espaço livre na frente (headroom) e escreve
+// só o payload; cada camada abaixo prepende seu header no lugar (pbuf_push)
+// e a NIC faz DMA direto de p->payload. Um único copy por pacote (dados do
+// chamador -> pbuf), em vez de um buffer estático por camada.
+//
+// O pool é um intervalo contíguo do PMM abaixo de 16MB (phys == virt);
+// cada pbuf ocupa PBUF_SIZE bytes e nunca cruza um frame.
+// API: pbuf_init, pbuf_alloc, pbuf_push, pbuf_ref, pbuf_free,
+//      pbuf_set_reclaim, pbuf_get_stats
+
+#ifndef __PBUF_H__
+#define __PBUF_H__
+
+#include "../common/types.h"
+
+// ============================================================
+// Constantes
+// ============================================================
+
+#define PBUF_SIZE           2048    // Header do pbuf + dados (2 por frame)
+#define PBUF_POOL_SIZE      32      // pbufs no pool (16 frames, 64KB)
+#define PBUF_HDR_SIZE       16      // next + payload + len + ref + flags
+#define PBUF_BUF_SIZE       (PBUF_SIZE - PBUF_HDR_SIZE)
+
+// Offloads pedidos pela pilha (pbuf->flags), só com NETDEV_F_TX_CSUM
+#define PBUF_F_CSUM_IP      0x0001  // Checksum do header IPv4 fica para a NIC
+#define PBUF_F_CSUM_L4      0x0002  // TCP/UDP: campo tem só a soma do pseudo-header
+
+// Headroom por camada de quem aloca (headers que ainda serão prependidos)
+#define PBUF_LINK           14                  // Ethernet
+#define PBUF_IP             (PBUF_LINK + 20)    // + IPv4 sem opções
+#define PBUF_TRANSPORT      (PBUF_IP + 20)      // + TCP sem opções
+
+// ============================================================
+// Estruturas
+// ============================================================
+
+typedef struct pbuf {
+    struct pbuf *next;          // Lista livre do pool
+    uint8_t     *payload;       // Início dos dados válidos (dentro de buf)
+    uint16_t     len;           // Bytes válidos a partir de payload
+    uint16_t     ref;           // Referências (0 = no pool)
+    uint16_t     flags;         // PBUF_F_*
+    uint16_t     reserved;
+    uint8_t      buf[PBUF_BUF_SIZE];
+} pbuf_t;
+
+typedef struct {
+    uint32_t total;             // pbufs no pool
+    uint32_t free;              // Livres agora
+    uint32_t min_free;          // Menor valor de free desde o boot
+    uint32_t allocs;            // pbuf_alloc bem-sucedidos
+    uint32_t failures;          // pbuf_alloc sem pbuf livre (ou grande demais)
+} pbuf_stats_t;
+
+// ============================================================
+// API pública
+// ============================================================
+
+// Reserva o pool (frames contíguos do PMM). Chamar depois de pmm_init()
+// Retorna false se não há memória para o pool
+bool pbuf_init(void);
+
+// Aloca um pbuf com ref = 1, payload = buf + headroom e len bytes válidos
+// (conteúdo indefinido). NULL se o pool está vazio ou não cabe
+// Seguro em softirq: o pool é protegido com cli
+pbuf_t *pbuf_alloc(uint16_t headroom, uint16_t len);
+
+// Prepende hlen bytes (recua payload). Retorna o novo payload,
+// ou NULL se o headroom restante não basta
+void *pbuf_push(pbuf_t *p, uint16_t hlen);
+
+// Mais uma referência (ex.: driver segurando o buffer até o fim do DMA)
+void pbuf_ref(pbuf_t *p);
+
+// Solta uma referência; na última o pbuf volta ao pool. NULL é ignorado
+void pbuf_free(pbuf_t *p);
+
+// Registra fn para ser chamada quando pbuf_alloc encontra o pool vazio
+// (driver que só devolve pbufs de TX sob demanda). NULL desliga
+void pbuf_set_reclaim(void (*fn)(void));
+
+// Retorna contadores do pool
+pbuf_stats_t pbuf_get_stats(void);
+
+#endif
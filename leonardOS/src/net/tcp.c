@@ -6,6 +6,7 @@
 #include "ipv4.h"
 #include "ethernet.h"
 #include "net_config.h"
+#include "../drivers/net/netdev.h"
 #include "../common/string.h"
 #include "../drivers/vga/vga.h"
 #include "../common/colors.h"
@@ -51,51 +52,43 @@ static uint16_t tcp_alloc_port(void) {
 }
 
 // ============================================================
-// tcp_send_segment_raw — envia segmento SEM atualizar seq_next
-// Usado para retransmissão (seq já foi avançado no envio original)
+// tcp_output — monta o segmento num pbuf e entrega ao IPv4
+// Dados copiados uma vez para o pbuf; header TCP, IP e Ethernet
+// são prependidos no headroom e a NIC lê direto do pbuf
 // ============================================================
-static bool tcp_send_segment_raw(tcp_conn_t *conn, uint8_t flags,
-                                 uint32_t seq, const void *data,
-                                 uint16_t data_len) {
-    static uint8_t tcp_buf_raw[ETH_MTU];
+static bool tcp_output(tcp_conn_t *conn, uint8_t flags, uint32_t seq,
+                       const void *data, uint16_t data_len) {
+    pbuf_t *p = pbuf_alloc(PBUF_TRANSPORT, data_len);
+    if (!p) return false;
 
-    tcp_header_t *hdr = (tcp_header_t *)tcp_buf_raw;
+    if (data && data_len > 0) {
+        kmemcpy(p->payload, data, data_len);
+    }
+
+    tcp_header_t *hdr = (tcp_header_t *)pbuf_push(p, TCP_HLEN_MIN);
+    uint16_t tcp_total = TCP_HLEN_MIN + data_len;
 
     hdr->src_port    = htons(conn->local_port);
     hdr->dst_port    = htons(conn->remote_port);
     hdr->seq_num     = htonl(seq);
     hdr->ack_num     = htonl(conn->ack_next);
-    hdr->data_offset = (TCP_HLEN_MIN / 4) << 4;
+    hdr->data_offset = (TCP_HLEN_MIN / 4) << 4; // 5 words, no options
     hdr->flags       = flags;
     hdr->window      = htons(TCP_WINDOW);
     hdr->checksum    = 0;
     hdr->urgent_ptr  = 0;
 
-    if (data && data_len > 0) {
-        kmemcpy(tcp_buf_raw + TCP_HLEN_MIN, data, data_len);
-    }
-
-    uint16_t tcp_total = TCP_HLEN_MIN + data_len;
-
-    {
-        net_config_t *cfg = net_get_config();
-        static uint8_t cksum_buf_raw[ETH_MTU + 12];
-        tcp_pseudo_header_t *pseudo = (tcp_pseudo_header_t *)cksum_buf_raw;
-
-        kmemcpy(pseudo->src_ip, cfg->ip.octets, 4);
-        kmemcpy(pseudo->dst_ip, conn->remote_ip.octets, 4);
-        pseudo->zero       = 0;
-        pseudo->protocol   = IP_PROTO_TCP;
-        pseudo->tcp_length = htons(tcp_total);
-
-        kmemcpy(cksum_buf_raw + sizeof(tcp_pseudo_header_t), tcp_buf_raw, tcp_total);
-
-        uint16_t cksum = ip_checksum(cksum_buf_raw,
-                                     sizeof(tcp_pseudo_header_t) + tcp_total);
-        hdr->checksum = cksum;
+    // Checksum com pseudo-header (com offload, a NIC soma o segmento)
+    if (netdev_tx_csum()) {
+        hdr->checksum = ip_pseudo_sum(net_get_config()->ip, conn->remote_ip,
+                                      IP_PROTO_TCP, tcp_total);
+        p->flags |= PBUF_F_CSUM_L4;
+    } else {
+        hdr->checksum = ip_checksum_pseudo(net_get_config()->ip, conn->remote_ip,
+                                           IP_PROTO_TCP, hdr, tcp_total);
     }
 
-    bool ok = ipv4_send(conn->remote_ip, IP_PROTO_TCP, tcp_buf_raw, tcp_total);
+    bool ok = ipv4_send(conn->remote_ip, IP_PROTO_TCP, p);
     if (ok) stats.segments_tx++;
     return ok;
 }
@@ -191,8 +184,8 @@ void tcp_check_retransmit(void) {
             seg->retries++;
             seg->send_time_ms = now;
 
-            tcp_send_segment_raw(conn, seg->flags, seg->seq,
-                                 seg->data, seg->data_len);
+            // Reenvia SEM atualizar seq_next (já avançado no envio original)
+            tcp_output(conn, seg->flags, seg->seq, seg->data, seg->data_len);
             stats.retransmits++;
         }
     }
@@ -203,50 +196,8 @@ void tcp_check_retransmit(void) {
 // ============================================================
 static bool tcp_send_segment(tcp_conn_t *conn, uint8_t flags,
                              const void *data, uint16_t data_len) {
-    static uint8_t tcp_buf[ETH_MTU];
-
-    tcp_header_t *hdr = (tcp_header_t *)tcp_buf;
-
-    hdr->src_port    = htons(conn->local_port);
-    hdr->dst_port    = htons(conn->remote_port);
-    hdr->seq_num     = htonl(conn->seq_next);
-    hdr->ack_num     = htonl(conn->ack_next);
-    hdr->data_offset = (TCP_HLEN_MIN / 4) << 4; // 5 words, no options
-    hdr->flags       = flags;
-    hdr->window      = htons(TCP_WINDOW);
-    hdr->checksum    = 0;
-    hdr->urgent_ptr  = 0;
-
-    // Copia dados
-    if (data && data_len > 0) {
-        kmemcpy(tcp_buf + TCP_HLEN_MIN, data, data_len);
-    }
-
-    uint16_t tcp_total = TCP_HLEN_MIN + data_len;
-
-    // Calcula checksum com pseudo-header
-    {
-        net_config_t *cfg = net_get_config();
-        static uint8_t cksum_buf[ETH_MTU + 12];
-        tcp_pseudo_header_t *pseudo = (tcp_pseudo_header_t *)cksum_buf;
-
-        kmemcpy(pseudo->src_ip, cfg->ip.octets, 4);
-        kmemcpy(pseudo->dst_ip, conn->remote_ip.octets, 4);
-        pseudo->zero       = 0;
-        pseudo->protocol   = IP_PROTO_TCP;
-        pseudo->tcp_length = htons(tcp_total);
-
-        kmemcpy(cksum_buf + sizeof(tcp_pseudo_header_t), tcp_buf, tcp_total);
-
-        uint16_t cksum = ip_checksum(cksum_buf,
-                                     sizeof(tcp_pseudo_header_t) + tcp_total);
-        hdr->checksum = cksum;
-    }
-
-    bool ok = ipv4_send(conn->remote_ip, IP_PROTO_TCP, tcp_buf, tcp_total);
+    bool ok = tcp_output(conn, flags, conn->seq_next, data, data_len);
     if (ok) {
-        stats.segments_tx++;
-
         // Atualiza seq para dados enviados
         if (data_len > 0) conn->seq_next += data_len;
         if (flags & TCP_SYN) conn->seq_next++;  // SYN consome 1 seq
@@ -39,17 +39,6 @@ typedef struct {
     uint16_t urgent_ptr;        // Urgent pointer
 } __attribute__((packed)) tcp_header_t;
 
-// ============================================================
-// Pseudo-header TCP (para checksum)
-// ============================================================
-typedef struct {
-    uint8_t  src_ip[4];
-    uint8_t  dst_ip[4];
-    uint8_t  zero;
-    uint8_t  protocol;          // 6 = TCP
-    uint16_t tcp_length;
-} __attribute__((packed)) tcp_pseudo_header_t;
-
 // ============================================================
 // Estados TCP (simplificado)
 // ============================================================
@@ -133,10 +133,15 @@ bool udp_send(ip_addr_t dst_ip, uint16_t dst_port, uint16_t src_port,
         return false;
     }
 
-    // Monta pacote UDP
-    static uint8_t udp_buf[ETH_MTU];
-    udp_header_t *hdr = (udp_header_t *)udp_buf;
+    // Monta pacote UDP: dados no pbuf, header prependido no headroom
+    pbuf_t *p = pbuf_alloc(PBUF_IP + sizeof(udp_header_t), data_len);
+    if (!p) {
+        stats.tx_errors++;
+        return false;
+    }
+    kmemcpy(p->payload, data, data_len);
 
+    udp_header_t *hdr = (udp_header_t *)pbuf_push(p, sizeof(udp_header_t));
     uint16_t udp_total = sizeof(udp_header_t) + data_len;
 
     hdr->src_port = htons(src_port);
@@ -144,35 +149,17 @@ bool udp_send(ip_addr_t dst_ip, uint16_t dst_port, uint16_t src_port,
     hdr->length   = htons(udp_total);
     hdr->checksum = 0; // Checksum opcional em UDP sobre IPv4
 
-    // Copia dados
-    kmemcpy(udp_buf + sizeof(udp_header_t), data, data_len);
-
     // Calcula checksum UDP com pseudo-header
     // (essencial para confiabilidade, embora tecnicamente opcional em IPv4)
-    {
-        net_config_t *cfg = net_get_config();
-
-        // Buffer para pseudo-header + pacote UDP
-        static uint8_t cksum_buf[ETH_MTU + 12];
-        udp_pseudo_header_t *pseudo = (udp_pseudo_header_t *)cksum_buf;
-
-        kmemcpy(pseudo->src_ip, cfg->ip.octets, 4);
-        kmemcpy(pseudo->dst_ip, dst_ip.octets, 4);
-        pseudo->zero       = 0;
-        pseudo->protocol   = IP_PROTO_UDP;
-        pseudo->udp_length = htons(udp_total);
-
-        // Copia pacote UDP após pseudo-header
-        kmemcpy(cksum_buf + sizeof(udp_pseudo_header_t), udp_buf, udp_total);
-
-        uint16_t cksum_len = sizeof(udp_pseudo_header_t) + udp_total;
-        uint16_t cksum = ip_checksum(cksum_buf, cksum_len);
-        if (cksum == 0) cksum = 0xFFFF; // RFC 768: 0 = no checksum
-        hdr->checksum = cksum;
-    }
+    // Sempre em software, mesmo com offload: a NIC escreveria 0x0000 quando
+    // a soma dá zero, e em UDP isso significa "sem checksum"
+    uint16_t cksum = ip_checksum_pseudo(net_get_config()->ip, dst_ip, IP_PROTO_UDP,
+                                        hdr, udp_total);
+    if (cksum == 0) cksum = 0xFFFF; // RFC 768: 0 = no checksum
+    hdr->checksum = cksum;
 
     // Envia via IPv4
-    bool ok = ipv4_send(dst_ip, IP_PROTO_UDP, udp_buf, udp_total);
+    bool ok = ipv4_send(dst_ip, IP_PROTO_UDP, p);
     if (ok) {
         stats.datagrams_tx++;
     } else {
@@ -17,17 +17,6 @@ typedef struct {
     uint16_t checksum;      // Checksum (pode ser 0 = desabilitado)
 } __attribute__((packed)) udp_header_t;
 
-// ============================================================
-// Pseudo-header para cálculo de checksum UDP
-// ============================================================
-typedef struct {
-    uint8_t  src_ip[4];
-    uint8_t  dst_ip[4];
-    uint8_t  zero;
-    uint8_t  protocol;      // 17 = UDP
-    uint16_t udp_length;
-} __attribute__((packed)) udp_pseudo_header_t;
-
 // ============================================================
 // Callback para recepção UDP
 // Chamado quando chega um datagrama na porta bound
@@ -16,6 +16,7 @@
 #include "../common/types.h"
 #include "../commands/commands.h"
 #include "../fs/vfs.h"
+#include "../memory/arena.h"
 
 // ============================================================
 // Forward: execute_line do shell.c
@@ -212,6 +213,8 @@ int script_eval_condition(const char *cond) {
 // Executor de linhas (scripts)
 // ============================================================
 int script_execute_lines(const char **lines, int num_lines) {
+    // Arena de rascunho criada no primeiro uso, liberada ao fim das linhas
+    arena_t *scratch = NULL;
     int i = 0;
     while (i < num_lines) {
         const char *line = lines[i];
@@ -381,10 +384,17 @@ int script_execute_lines(const char **lines, int num_lines) {
             p += 3;
             while (*p == ' ') p++;
 
-            // Coleta itens até ";" ou "do"
-            char items_str[256];
-            int ii = 0;
-            while (*p && *p != ';' && ii < 255) {
+            // Coleta itens até ";" ou "do" (buffers na arena: sem limite fixo)
+            if (!scratch) scratch = arena_create(0);
+            uint32_t items_cap = (uint32_t)kstrlen(p) + 1;
+            char *items_str = scratch ? (char *)arena_alloc(scratch, items_cap) : NULL;
+            char *item = scratch ? (char *)arena_alloc(scratch, items_cap) : NULL;
+            if (!items_str || !item) {
+                vga_puts_color("script: sem memoria para 'for'\n", THEME_ERROR);
+                break;
+            }
+            uint32_t ii = 0;
+            while (*p && *p != ';') {
                 if (kstrncmp(p, " do", 3) == 0) break;
                 items_str[ii++] = *p++;
             }
@@ -413,9 +423,8 @@ int script_execute_lines(const char **lines, int num_lines) {
                 while (*ip == ' ') ip++;
                 if (*ip == '\0') break;
 
-                char item[64];
                 int iti = 0;
-                while (*ip && *ip != ' ' && iti < 63) {
+                while (*ip && *ip != ' ') {
                     item[iti++] = *ip++;
                 }
                 item[iti] = '\0';
@@ -466,6 +475,7 @@ int script_execute_lines(const char **lines, int num_lines) {
         i++;
     }
 
+    arena_destroy(scratch);
     return 0;
 }
 
@@ -490,18 +500,33 @@ int script_execute_file(const char *path) {
 
     if (file->size == 0) return 0;
 
-    // Lê o arquivo
-    static uint8_t script_buf[4096];
-    uint32_t size = file->size < 4095 ? file->size : 4095;
-    uint32_t bytes = vfs_read(file, 0, size, script_buf);
+    // Lê o arquivo inteiro numa arena (reentrante: source dentro de script)
+    arena_t *scratch = arena_create(0);
+    char *script_buf = scratch ? (char *)arena_alloc(scratch, file->size + 1) : NULL;
+    if (!script_buf) {
+        vga_puts_color("script: sem memoria para o arquivo\n", THEME_ERROR);
+        arena_destroy(scratch);
+        return -1;
+    }
+    uint32_t bytes = vfs_read(file, 0, file->size, (uint8_t *)script_buf);
     script_buf[bytes] = '\0';
 
+    // Uma entrada por '\n' (+ última linha sem '\n')
+    int max_lines = 1;
+    for (uint32_t k = 0; k < bytes; k++) {
+        if (script_buf[k] == '\n') max_lines++;
+    }
+    const char **lines = (const char **)arena_alloc(scratch, (uint32_t)max_lines * sizeof(char *));
+    if (!lines) {
+        arena_destroy(scratch);
+        return -1;
+    }
+
     // Separa em linhas
-    const char *lines[128];
     int num_lines = 0;
-    char *s = (char *)script_buf;
+    char *s = script_buf;
 
-    while (*s && num_lines < 128) {
+    while (*s && num_lines < max_lines) {
         // Pula linhas em branco
         while (*s == '\r') s++;
         if (*s == '\0') break;
@@ -522,7 +547,9 @@ int script_execute_file(const char *path) {
         start = 1;
     }
 
-    return script_execute_lines(lines + start, num_lines - start);
+    int result = script_execute_lines(lines + start, num_lines - start);
+    arena_destroy(scratch);
+    return result;
 }
 
 // ============================================================
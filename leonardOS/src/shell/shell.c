@@ -9,6 +9,7 @@
 #include "../common/colors.h"
 #include "../common/string.h"
 #include "../commands/commands.h"
+#include "../memory/arena.h"
 
 // ============================================================
 // Estado global do shell
@@ -197,22 +198,50 @@ static void expand_globs(const char *input, char *output, int max) {
 // ============================================================
 // Pipeline: executa um segmento de pipe
 // Captura saída do lado esquerdo, passa como stdin (args) ao direito
+// Buffers (linha, capturas, comando + entrada) vêm de uma arena por
+// pipeline: reentrante (source dentro de pipe) e liberado de uma vez
 // ============================================================
 #define PIPE_BUF_SIZE 4096
-
-static char pipe_buf[PIPE_BUF_SIZE];
+#define PIPE_MAX_SEGMENTS 8
 
 static int execute_single(const char *input) {
     return commands_execute(input);
 }
 
-static int execute_pipeline(const char *input) {
+// Há '|' fora de aspas?
+static bool has_pipe(const char *s) {
+    int in_quotes = 0;
+    for (; *s; s++) {
+        if (*s == '"') in_quotes = !in_quotes;
+        else if (*s == '|' && !in_quotes) return true;
+    }
+    return false;
+}
+
+// "cmd entrada" alocado na arena no tamanho exato
+static char *pipe_combine(arena_t *scratch, const char *cmd, const char *input) {
+    int clen = kstrlen(cmd);
+    int ilen = kstrlen(input);
+    char *combined = (char *)arena_alloc(scratch, (uint32_t)(clen + 1 + ilen + 1));
+    if (!combined) return NULL;
+    kmemcpy(combined, cmd, (uint32_t)clen);
+    combined[clen] = ' ';
+    kmemcpy(combined + clen + 1, input, (uint32_t)ilen + 1);
+    return combined;
+}
+
+static int execute_pipeline_in(arena_t *scratch, const char *input) {
     // Copia input para poder modificar
-    char line[512];
-    kstrcpy(line, input, 512);
+    int in_len = kstrlen(input);
+    char *line = (char *)arena_alloc(scratch, (uint32_t)in_len + 1);
+    char *capture[2];
+    capture[0] = (char *)arena_alloc(scratch, PIPE_BUF_SIZE);
+    capture[1] = (char *)arena_alloc(scratch, PIPE_BUF_SIZE);
+    if (!line || !capture[0] || !capture[1]) return -1;
+    kmemcpy(line, input, (uint32_t)in_len + 1);
 
     // Procura '|' fora de aspas
-    char *segments[8];  // Máximo 8 pipes
+    char *segments[PIPE_MAX_SEGMENTS];
     int seg_count = 0;
     segments[seg_count++] = line;
 
@@ -222,20 +251,16 @@ static int execute_pipeline(const char *input) {
         if (*p == '"') in_quotes = !in_quotes;
         else if (*p == '|' && !in_quotes) {
             *p = '\0';
-            if (seg_count < 8) {
+            if (seg_count < PIPE_MAX_SEGMENTS) {
                 segments[seg_count++] = p + 1;
             }
         }
         p++;
     }
 
-    if (seg_count == 1) {
-        // Sem pipe, executa direto
-        return execute_single(line);
-    }
-
     // Executa pipeline: captura saída de cada comando e passa ao próximo
-    pipe_buf[0] = '\0';
+    // (alterna entre os dois buffers de captura)
+    const char *pipe_in = "";
     int result = 0;
 
     for (int i = 0; i < seg_count; i++) {
@@ -250,43 +275,44 @@ static int execute_pipeline(const char *input) {
 
         if (cmd[0] == '\0') continue;
 
+        // Primeiro segmento (ou entrada vazia): executa normalmente;
+        // senão passa a saída anterior como args: "comando saida"
+        const char *full = cmd;
+        if (pipe_in[0] != '\0') {
+            full = pipe_combine(scratch, cmd, pipe_in);
+            if (!full) return -1;
+        }
+
         if (i < seg_count - 1) {
             // Não é o último: captura saída
-            char capture[PIPE_BUF_SIZE];
-            vga_capture_start(capture, PIPE_BUF_SIZE);
-
-            if (i == 0) {
-                // Primeiro segmento: executa normalmente
-                result = execute_single(cmd);
-            } else {
-                // Segmentos intermediários: passa pipe_buf como args
-                char combined[512];
-                // Constrói "comando pipe_buf_content"
-                kstrcpy(combined, cmd, 512);
-                kstrcat(combined, " ", 512);
-                kstrcat(combined, pipe_buf, 512);
-                result = execute_single(combined);
-            }
-
+            char *out = capture[i & 1];
+            vga_capture_start(out, PIPE_BUF_SIZE);
+            result = execute_single(full);
             vga_capture_stop();
-            kstrcpy(pipe_buf, capture, PIPE_BUF_SIZE);
+            pipe_in = out;
         } else {
             // Último segmento: saída normal (para tela)
-            if (pipe_buf[0] != '\0') {
-                char combined[512];
-                kstrcpy(combined, cmd, 512);
-                kstrcat(combined, " ", 512);
-                kstrcat(combined, pipe_buf, 512);
-                result = execute_single(combined);
-            } else {
-                result = execute_single(cmd);
-            }
+            result = execute_single(full);
         }
     }
 
     return result;
 }
 
+static int execute_pipeline(const char *input) {
+    // Sem pipe, executa direto (nada a alocar)
+    if (!has_pipe(input)) return execute_single(input);
+
+    arena_t *scratch = arena_create(0);
+    if (!scratch) {
+        vga_puts_color("shell: sem memoria para o pipeline\n", THEME_ERROR);
+        return -1;
+    }
+    int result = execute_pipeline_in(scratch, input);
+    arena_destroy(scratch);
+    return result;
+}
+
 // ============================================================
 // Separa por ponto-e-vírgula (;) e executa cada parte
 // ============================================================